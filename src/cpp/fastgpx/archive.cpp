@@ -0,0 +1,433 @@
+#include "fastgpx/archive.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "fastgpx/errors.hpp"
+#include "fastgpx/filesystem.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+constexpr std::string_view kGzipMagic = "\x1F\x8B";
+constexpr std::string_view kZipMagic = "PK\x03\x04";
+constexpr std::string_view kEmptyZipMagic = "PK\x05\x06";
+
+// gzip header flags.
+constexpr uint8_t kGzipHeaderCrc = 0x02;
+constexpr uint8_t kGzipExtra = 0x04;
+constexpr uint8_t kGzipName = 0x08;
+constexpr uint8_t kGzipComment = 0x10;
+
+constexpr uint32_t kZipLocalHeaderSignature = 0x04034B50;
+constexpr uint32_t kZipCentralHeaderSignature = 0x02014B50;
+constexpr uint32_t kZipEndSignature = 0x06054B50;
+constexpr uint32_t kZip64EndSignature = 0x06064B50;
+constexpr uint32_t kZip64LocatorSignature = 0x07064B50;
+constexpr uint16_t kZip64ExtraId = 0x0001;
+
+constexpr size_t kZipLocalHeaderSize = 30;
+constexpr size_t kZipCentralHeaderSize = 46;
+constexpr size_t kZipEndSize = 22;
+constexpr size_t kZip64EndSize = 56;
+constexpr size_t kZip64LocatorSize = 20;
+constexpr size_t kZipMaxCommentSize = 0xFFFF;
+
+constexpr uint16_t kZipStored = 0;
+constexpr uint16_t kZipDeflated = 8;
+constexpr uint16_t kZipEncrypted = 0x0001;
+
+// Size of the chunks appended by `ReadAll`.
+constexpr size_t kReadAllChunkSize = 256 * 1024;
+
+// Reads a little-endian integer, checking that it is within the data.
+template <typename T>
+T ReadLittleEndian(std::string_view data, const size_t offset, std::string_view format)
+{
+  if (offset > data.size() || data.size() - offset < sizeof(T))
+  {
+    throw parse_error(std::format("Invalid {} data: unexpected end of data", format));
+  }
+  T value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i)
+  {
+    value |= static_cast<T>(static_cast<T>(static_cast<unsigned char>(data[offset + i])) << (8 * i));
+  }
+  return value;
+}
+
+uint16_t ReadU16(std::string_view data, const size_t offset, std::string_view format = "ZIP")
+{
+  return ReadLittleEndian<uint16_t>(data, offset, format);
+}
+
+uint32_t ReadU32(std::string_view data, const size_t offset, std::string_view format = "ZIP")
+{
+  return ReadLittleEndian<uint32_t>(data, offset, format);
+}
+
+uint64_t ReadU64(std::string_view data, const size_t offset)
+{
+  return ReadLittleEndian<uint64_t>(data, offset, "ZIP");
+}
+
+size_t ToSize(const uint64_t value)
+{
+  if (value > SIZE_MAX)
+  {
+    throw parse_error("Invalid ZIP data: archive too large");
+  }
+  return static_cast<size_t>(value);
+}
+
+char ToLower(const char c)
+{
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c;
+}
+
+} // namespace
+
+Compression DetectCompression(std::string_view header) noexcept
+{
+  if (header.starts_with(kGzipMagic))
+  {
+    return Compression::Gzip;
+  }
+  if (header.starts_with(kZipMagic) || header.starts_with(kEmptyZipMagic))
+  {
+    return Compression::Zip;
+  }
+  return Compression::None;
+}
+
+Compression DetectFileCompression(const std::filesystem::path& path)
+{
+  const std::unique_ptr<FILE, decltype(&std::fclose)> file(open_file(path), &std::fclose);
+  if (!file)
+  {
+    return Compression::None;
+  }
+  std::array<char, 4> header{};
+  const size_t read = std::fread(header.data(), 1, header.size(), file.get());
+  return DetectCompression(std::string_view(header.data(), read));
+}
+
+// DecompressReader
+
+void DecompressReader::ReadAll(std::string& output)
+{
+  size_t size = output.size();
+  bool eof = false;
+  while (!eof)
+  {
+    output.resize_and_overwrite(size + kReadAllChunkSize, [&](char* data, const size_t count) {
+      const size_t read = Read(data + size, count - size);
+      eof = read < count - size;
+      size += read;
+      return size;
+    });
+  }
+}
+
+// GzipReader
+
+GzipReader::GzipReader(std::string_view data) : data_(data)
+{
+  StartMember(0);
+}
+
+size_t GzipReader::Read(char* buffer, const size_t size)
+{
+  size_t total = 0;
+  while (total < size && inflater_.has_value())
+  {
+    const size_t read = inflater_->Read(buffer + total, size - total);
+    crc_ = Crc32(std::string_view(buffer + total, read), crc_);
+    size_ += static_cast<uint32_t>(read); // ISIZE is the size modulo 2^32.
+    total += read;
+    if (inflater_->finished())
+    {
+      FinishMember();
+    }
+  }
+  return total;
+}
+
+void GzipReader::StartMember(size_t offset)
+{
+  const auto data = data_;
+  if (!data.substr(offset).starts_with(kGzipMagic))
+  {
+    throw parse_error("Invalid gzip data: missing gzip header");
+  }
+  if (ReadLittleEndian<uint8_t>(data, offset + 2, "gzip") != 8)
+  {
+    throw parse_error("Invalid gzip data: unsupported compression method");
+  }
+  const uint8_t flags = ReadLittleEndian<uint8_t>(data, offset + 3, "gzip");
+  // ID1 ID2 CM FLG MTIME(4) XFL OS
+  offset += 10;
+  if (flags & kGzipExtra)
+  {
+    offset += size_t{2} + ReadU16(data, offset, "gzip");
+  }
+  for (const auto flag : {kGzipName, kGzipComment})
+  {
+    if (flags & flag)
+    {
+      const size_t end = data.find('\0', offset);
+      if (end == std::string_view::npos)
+      {
+        throw parse_error("Invalid gzip data: unexpected end of data");
+      }
+      offset = end + 1;
+    }
+  }
+  if (flags & kGzipHeaderCrc)
+  {
+    offset += 2;
+  }
+  if (offset > data.size())
+  {
+    throw parse_error("Invalid gzip data: unexpected end of data");
+  }
+
+  member_offset_ = offset;
+  inflater_.emplace(data.substr(offset));
+  crc_ = 0;
+  size_ = 0;
+}
+
+void GzipReader::FinishMember()
+{
+  // CRC32 ISIZE
+  const size_t trailer = member_offset_ + inflater_->consumed();
+  if (ReadU32(data_, trailer, "gzip") != crc_ || ReadU32(data_, trailer + 4, "gzip") != size_)
+  {
+    throw parse_error("Invalid gzip data: CRC or size mismatch");
+  }
+  inflater_.reset();
+
+  // Like gzip, anything after the last member other than another member is ignored.
+  const size_t next = trailer + 8;
+  if (data_.substr(next).starts_with(kGzipMagic))
+  {
+    StartMember(next);
+  }
+}
+
+// ZipEntry
+
+bool ZipEntry::IsDirectory() const noexcept
+{
+  return name.ends_with('/');
+}
+
+bool ZipEntry::IsGpx() const noexcept
+{
+  constexpr std::string_view extension = ".gpx";
+  return !IsDirectory() && name.size() > extension.size() &&
+         std::ranges::equal(std::string_view(name).substr(name.size() - extension.size()),
+                            extension, [](char a, char b) { return ToLower(a) == b; });
+}
+
+// ZipArchive
+
+ZipArchive::ZipArchive(const std::filesystem::path& path)
+{
+  if (!std::filesystem::is_regular_file(path))
+  {
+    throw parse_error(
+        std::format("Failed to load GPX archive: File was not found - {}", path.string()));
+  }
+  try
+  {
+    file_.emplace(path);
+  }
+  catch (const std::runtime_error& error)
+  {
+    throw parse_error(
+        std::format("Failed to load GPX archive: {} - {}", error.what(), path.string()));
+  }
+  data_ = file_->data();
+  ReadCentralDirectory();
+}
+
+ZipArchive::ZipArchive(std::string_view data) : data_(data)
+{
+  ReadCentralDirectory();
+}
+
+void ZipArchive::ReadCentralDirectory()
+{
+  // The end of central directory record is followed by a variable length comment.
+  if (data_.size() < kZipEndSize)
+  {
+    throw parse_error("Invalid ZIP data: missing end of central directory");
+  }
+  const size_t search_begin =
+      data_.size() > kZipEndSize + kZipMaxCommentSize ? data_.size() - kZipEndSize - kZipMaxCommentSize
+                                                      : 0;
+  size_t end = data_.size() - kZipEndSize;
+  while (ReadU32(data_, end) != kZipEndSignature)
+  {
+    if (end == search_begin)
+    {
+      throw parse_error("Invalid ZIP data: missing end of central directory");
+    }
+    end--;
+  }
+
+  uint64_t entry_count = ReadU16(data_, end + 10);
+  uint64_t directory_offset = ReadU32(data_, end + 16);
+  if (end >= kZip64LocatorSize && ReadU32(data_, end - kZip64LocatorSize) == kZip64LocatorSignature)
+  {
+    const size_t zip64_end = ToSize(ReadU64(data_, end - kZip64LocatorSize + 8));
+    if (ReadU32(data_, zip64_end) != kZip64EndSignature ||
+        data_.size() - zip64_end < kZip64EndSize)
+    {
+      throw parse_error("Invalid ZIP data: malformed ZIP64 end of central directory");
+    }
+    entry_count = ReadU64(data_, zip64_end + 32);
+    directory_offset = ReadU64(data_, zip64_end + 48);
+  }
+
+  // Each record takes at least the fixed header size, which bounds the count.
+  size_t offset = ToSize(directory_offset);
+  if (offset > data_.size() || entry_count > (data_.size() - offset) / kZipCentralHeaderSize)
+  {
+    throw parse_error("Invalid ZIP data: malformed central directory");
+  }
+  entries_.reserve(static_cast<size_t>(entry_count));
+  for (uint64_t i = 0; i < entry_count; ++i)
+  {
+    if (ReadU32(data_, offset) != kZipCentralHeaderSignature)
+    {
+      throw parse_error("Invalid ZIP data: malformed central directory");
+    }
+    ZipEntry entry;
+    entry.flags = ReadU16(data_, offset + 8);
+    entry.method = ReadU16(data_, offset + 10);
+    entry.crc32 = ReadU32(data_, offset + 16);
+    entry.compressed_size = ReadU32(data_, offset + 20);
+    entry.size = ReadU32(data_, offset + 24);
+    const size_t name_size = ReadU16(data_, offset + 28);
+    const size_t extra_size = ReadU16(data_, offset + 30);
+    const size_t comment_size = ReadU16(data_, offset + 32);
+    entry.header_offset = ReadU32(data_, offset + 42);
+
+    const size_t name_offset = offset + kZipCentralHeaderSize;
+    if (data_.size() - name_offset < name_size + extra_size + comment_size)
+    {
+      throw parse_error("Invalid ZIP data: malformed central directory");
+    }
+    entry.name = data_.substr(name_offset, name_size);
+
+    // ZIP64 sizes and offsets follow in the extra field, in this order, for
+    // the fields saturated in the record.
+    const auto extra = data_.substr(name_offset + name_size, extra_size);
+    for (size_t field = 0; field + 4 <= extra.size();)
+    {
+      const uint16_t id = ReadU16(extra, field);
+      const size_t field_size = ReadU16(extra, field + 2);
+      if (id == kZip64ExtraId)
+      {
+        size_t value = field + 4;
+        for (uint64_t* target : {&entry.size, &entry.compressed_size, &entry.header_offset})
+        {
+          if (*target == UINT32_MAX && value + 8 <= field + 4 + field_size)
+          {
+            *target = ReadU64(extra, value);
+            value += 8;
+          }
+        }
+      }
+      field += 4 + field_size;
+    }
+
+    entries_.push_back(std::move(entry));
+    offset = name_offset + name_size + extra_size + comment_size;
+  }
+}
+
+// ZipEntryReader
+
+ZipEntryReader::ZipEntryReader(std::string_view archive_data, const ZipEntry& entry)
+    : name_(entry.name), expected_crc_(entry.crc32), expected_size_(entry.size)
+{
+  if (entry.flags & kZipEncrypted)
+  {
+    throw parse_error(std::format("Unsupported ZIP member: encrypted - {}", name_));
+  }
+  if (entry.method != kZipStored && entry.method != kZipDeflated)
+  {
+    throw parse_error(
+        std::format("Unsupported ZIP member: compression method {} - {}", entry.method, name_));
+  }
+
+  // The local header repeats the name, but its extra field may differ from the
+  // central directory.
+  const size_t header = ToSize(entry.header_offset);
+  if (ReadU32(archive_data, header) != kZipLocalHeaderSignature)
+  {
+    throw parse_error(std::format("Invalid ZIP data: malformed local header - {}", name_));
+  }
+  const size_t name_size = ReadU16(archive_data, header + 26);
+  const size_t extra_size = ReadU16(archive_data, header + 28);
+  const size_t data_offset = header + kZipLocalHeaderSize + name_size + extra_size;
+  const size_t compressed_size = ToSize(entry.compressed_size);
+  if (data_offset > archive_data.size() || archive_data.size() - data_offset < compressed_size)
+  {
+    throw parse_error(std::format("Invalid ZIP data: unexpected end of data - {}", name_));
+  }
+
+  const auto data = archive_data.substr(data_offset, compressed_size);
+  if (entry.method == kZipDeflated)
+  {
+    inflater_.emplace(data);
+  }
+  else
+  {
+    stored_ = data;
+  }
+}
+
+size_t ZipEntryReader::Read(char* buffer, const size_t size)
+{
+  size_t read = 0;
+  if (inflater_.has_value())
+  {
+    read = inflater_->Read(buffer, size);
+  }
+  else
+  {
+    read = std::min(size, stored_.size());
+    std::memcpy(buffer, stored_.data(), read);
+    stored_.remove_prefix(read);
+  }
+  crc_ = Crc32(std::string_view(buffer, read), crc_);
+  size_ += read;
+
+  if (read < size && !verified_)
+  {
+    if (crc_ != expected_crc_ || size_ != expected_size_)
+    {
+      throw parse_error(std::format("Invalid ZIP data: CRC or size mismatch - {}", name_));
+    }
+    verified_ = true;
+  }
+  return read;
+}
+
+} // namespace fastgpx
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fastgpx/filesystem.hpp"
+#include "fastgpx/inflate.hpp"
+
+namespace fastgpx {
+
+enum class Compression
+{
+  None,
+  Gzip, // .gz
+  Zip,  // .zip
+};
+
+/**
+ * @brief Detects a compressed container from the first bytes of the data.
+ *
+ * @param header At least the first four bytes of the data, when available.
+ */
+Compression DetectCompression(std::string_view header) noexcept;
+
+/**
+ * @brief Detects a compressed container from the first bytes of a file.
+ *
+ * @param path UTF-8 file path.
+ * @return Compression::None if the file cannot be read.
+ */
+Compression DetectFileCompression(const std::filesystem::path& path);
+
+/**
+ * @brief Source of decompressed data, read sequentially in chunks.
+ */
+class DecompressReader
+{
+public:
+  virtual ~DecompressReader() = default;
+
+  /**
+   * @brief Reads the next decompressed bytes.
+   *
+   * @throws parse_error if the compressed data is malformed or fails its
+   *   integrity check.
+   * @param buffer
+   * @param size
+   * @return size_t Number of bytes read. Less than `size` only at the end of
+   *   the data.
+   */
+  virtual size_t Read(char* buffer, size_t size) = 0;
+
+  /**
+   * @brief Appends the remaining decompressed data to `output`.
+   *
+   * @param output
+   */
+  void ReadAll(std::string& output);
+};
+
+/**
+ * @brief Decompresses gzip data (RFC 1952), verifying the CRC-32 and size of
+ *   each member. Concatenated members are read as one stream.
+ */
+class GzipReader final : public DecompressReader
+{
+public:
+  /**
+   * @throws parse_error if the gzip header is malformed.
+   * @param data Must outlive the reader.
+   */
+  explicit GzipReader(std::string_view data);
+
+  size_t Read(char* buffer, size_t size) override;
+
+private:
+  void StartMember(size_t offset);
+  void FinishMember();
+
+  std::string_view data_;
+  std::optional<Inflater> inflater_;
+  // Offset in `data_` of the DEFLATE data of the current member.
+  size_t member_offset_ = 0;
+  uint32_t crc_ = 0;
+  uint32_t size_ = 0;
+};
+
+// Central directory record of a member of a ZIP archive.
+struct ZipEntry
+{
+  // UTF-8 or CP437 path within the archive, with `/` separators.
+  std::string name;
+  // 0: Stored, 8: Deflated.
+  uint16_t method = 0;
+  uint16_t flags = 0;
+  uint32_t crc32 = 0;
+  uint64_t compressed_size = 0;
+  uint64_t size = 0;
+  // Offset of the local file header in the archive.
+  uint64_t header_offset = 0;
+
+  bool IsDirectory() const noexcept;
+
+  // A file with the `.gpx` extension, in any case.
+  bool IsGpx() const noexcept;
+};
+
+/**
+ * @brief Reads the central directory of a ZIP archive, including ZIP64
+ *   archives.
+ *
+ * The members are decompressed on demand with `ZipEntryReader`, such that they
+ * can be decompressed in parallel.
+ */
+class ZipArchive
+{
+public:
+  /**
+   * @brief Memory-maps the archive.
+   *
+   * @throws parse_error if the file cannot be read or is not a ZIP archive.
+   * @param path UTF-8 file path.
+   */
+  explicit ZipArchive(const std::filesystem::path& path);
+
+  /**
+   * @throws parse_error if the data is not a ZIP archive.
+   * @param data Must outlive the archive and its readers.
+   */
+  explicit ZipArchive(std::string_view data);
+
+  std::string_view data() const noexcept { return data_; }
+  const std::vector<ZipEntry>& entries() const noexcept { return entries_; }
+
+private:
+  void ReadCentralDirectory();
+
+  std::optional<MappedFile> file_;
+  std::string_view data_;
+  std::vector<ZipEntry> entries_;
+};
+
+/**
+ * @brief Decompresses a member of a ZIP archive, verifying its CRC-32 and size.
+ */
+class ZipEntryReader final : public DecompressReader
+{
+public:
+  /**
+   * @throws parse_error if the member is encrypted, uses an unsupported
+   *   compression method, or its local header is malformed.
+   * @param archive_data The data of the whole archive. Must outlive the reader.
+   * @param entry
+   */
+  ZipEntryReader(std::string_view archive_data, const ZipEntry& entry);
+
+  size_t Read(char* buffer, size_t size) override;
+
+private:
+  std::string name_;
+  uint32_t expected_crc_ = 0;
+  uint64_t expected_size_ = 0;
+
+  // Stored members are copied from `stored_`, deflated members are
+  // decompressed by `inflater_`.
+  std::string_view stored_;
+  std::optional<Inflater> inflater_;
+
+  uint32_t crc_ = 0;
+  uint64_t size_ = 0;
+  bool verified_ = false;
+};
+
+} // namespace fastgpx
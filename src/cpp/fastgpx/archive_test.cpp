@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "fastgpx/archive.hpp"
+#include "fastgpx/errors.hpp"
+
+using namespace fastgpx;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+namespace {
+
+std::string ReadFile(const std::filesystem::path& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+} // namespace
+
+TEST_CASE("Detect compressed data", "[archive]")
+{
+  CHECK(DetectCompression("<?xml") == Compression::None);
+  CHECK(DetectCompression("") == Compression::None);
+  CHECK(DetectCompression("\x1F\x8B\x08") == Compression::Gzip);
+  CHECK(DetectCompression("PK\x03\x04") == Compression::Zip);
+
+  CHECK(DetectFileCompression(project_path / "gpx/test/segment.gpx") == Compression::None);
+  CHECK(DetectFileCompression(project_path / "gpx/test/segment.gpx.gz") == Compression::Gzip);
+  CHECK(DetectFileCompression(project_path / "gpx/test/segment.zip") == Compression::Zip);
+  CHECK(DetectFileCompression(project_path / "gpx/not-a-real-path/fake.gz") ==
+        Compression::None);
+}
+
+TEST_CASE("Decompress gzip file", "[archive]")
+{
+  const auto expected = ReadFile(project_path / "gpx/test/segment.gpx");
+  const auto data = ReadFile(project_path / "gpx/test/segment.gpx.gz");
+
+  GzipReader reader(data);
+  std::string output;
+  reader.ReadAll(output);
+  CHECK(output == expected);
+
+  // Concatenated members are read as one stream.
+  const auto concatenated = data + data;
+  GzipReader concatenated_reader(concatenated);
+  output.clear();
+  concatenated_reader.ReadAll(output);
+  CHECK(output == expected + expected);
+}
+
+TEST_CASE("Decompress corrupt gzip data", "[archive]")
+{
+  CHECK_THROWS_AS(GzipReader("<?xml"), parse_error);
+
+  const auto data = ReadFile(project_path / "gpx/test/segment.gpx.gz");
+  std::string output;
+
+  // Flip a bit in the CRC-32 of the trailer.
+  auto bad_crc = data;
+  bad_crc[bad_crc.size() - 8] ^= 1;
+  GzipReader crc_reader(bad_crc);
+  CHECK_THROWS_AS(crc_reader.ReadAll(output), parse_error);
+
+  // Flip a bit in the ISIZE of the trailer.
+  auto bad_size = data;
+  bad_size[bad_size.size() - 1] ^= 1;
+  GzipReader size_reader(bad_size);
+  output.clear();
+  CHECK_THROWS_AS(size_reader.ReadAll(output), parse_error);
+
+  // The trailer is missing.
+  GzipReader truncated_reader(std::string_view(data).substr(0, data.size() - 8));
+  output.clear();
+  CHECK_THROWS_AS(truncated_reader.ReadAll(output), parse_error);
+}
+
+TEST_CASE("Read ZIP archive", "[archive]")
+{
+  const auto expected = ReadFile(project_path / "gpx/test/segment.gpx");
+  const ZipArchive archive(project_path / "gpx/test/segment.zip");
+
+  REQUIRE(archive.entries().size() == 1);
+  const auto& entry = archive.entries()[0];
+  CHECK(entry.name == "segment.gpx");
+  CHECK(entry.IsGpx());
+  CHECK_FALSE(entry.IsDirectory());
+  CHECK(entry.size == expected.size());
+
+  ZipEntryReader reader(archive.data(), entry);
+  std::string output;
+  reader.ReadAll(output);
+  CHECK(output == expected);
+
+  // The CRC-32 is verified at the end of the member.
+  auto corrupt_entry = entry;
+  corrupt_entry.crc32 ^= 1;
+  ZipEntryReader corrupt_reader(archive.data(), corrupt_entry);
+  output.clear();
+  CHECK_THROWS_AS(corrupt_reader.ReadAll(output), parse_error);
+
+  // So is the uncompressed size.
+  auto short_entry = entry;
+  short_entry.size -= 1;
+  ZipEntryReader short_reader(archive.data(), short_entry);
+  output.clear();
+  CHECK_THROWS_AS(short_reader.ReadAll(output), parse_error);
+}
+
+TEST_CASE("Read ZIP archive with directories", "[archive]")
+{
+  const auto path =
+      project_path / "gpx/third-party/github.com_gps-touring_sample-gpx/sample-gpx-master.zip";
+  const ZipArchive archive(path);
+
+  REQUIRE(archive.entries().size() == 89);
+  CHECK(archive.entries()[0].name == "sample-gpx-master/");
+  CHECK(archive.entries()[0].IsDirectory());
+  CHECK_FALSE(archive.entries()[0].IsGpx());
+  CHECK(std::ranges::count_if(archive.entries(), &ZipEntry::IsGpx) == 78);
+}
+
+TEST_CASE("Read malformed ZIP archive", "[archive]")
+{
+  CHECK_THROWS_AS(ZipArchive(std::string_view("PK\x03\x04 not an archive")), parse_error);
+  CHECK_THROWS_AS(ZipArchive(project_path / "gpx/not-a-real-path/fake.zip"), parse_error);
+}
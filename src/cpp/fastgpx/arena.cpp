@@ -0,0 +1,48 @@
+#include "fastgpx/arena.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace fastgpx {
+
+GpxArena::GpxArena(const size_t initial_size)
+    : buffer_(std::make_unique_for_overwrite<std::byte[]>(initial_size)),
+      buffer_size_(initial_size)
+{
+  resource_.emplace(buffer_.get(), buffer_size_, &upstream_);
+}
+
+void GpxArena::Reset()
+{
+  const size_t used = buffer_size_ + upstream_.allocated();
+  // Returns the additional slabs to the upstream resource.
+  resource_.reset();
+  if (used > buffer_size_)
+  {
+    buffer_.reset();
+    buffer_ = std::make_unique_for_overwrite<std::byte[]>(used);
+    buffer_size_ = used;
+  }
+  upstream_.reset();
+  resource_.emplace(buffer_.get(), buffer_size_, &upstream_);
+}
+
+void* GpxArena::Upstream::do_allocate(const size_t bytes, const size_t alignment)
+{
+  void* p = heap_->allocate(bytes, alignment);
+  allocated_ += bytes;
+  return p;
+}
+
+void GpxArena::Upstream::do_deallocate(void* p, const size_t bytes, const size_t alignment)
+{
+  heap_->deallocate(p, bytes, alignment);
+}
+
+bool GpxArena::Upstream::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+  return this == &other;
+}
+
+} // namespace fastgpx
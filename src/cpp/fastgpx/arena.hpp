@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace fastgpx {
+
+/**
+ * @brief Monotonic memory arena for the point data of parsed GPX documents.
+ *
+ * Pass the arena to `LoadGpx` or `ParseGpx` to allocate the containers of the
+ * document from it. Freeing is a no-op until `Reset`, which releases everything
+ * allocated at once.
+ *
+ * On `Reset` the initial buffer grows to the total size used since the previous
+ * reset. A batch job reusing the arena for similar files therefore settles into
+ * a single slab without any further heap allocations.
+ *
+ * @note Not thread-safe. Use one arena per thread.
+ * @note Documents loaded into the arena must not be used after it is reset or
+ *   destroyed. Copies of them use the default memory resource.
+ */
+class GpxArena
+{
+public:
+  static constexpr size_t kDefaultInitialSize = 64 * 1024;
+
+  /**
+   * @param initial_size Size of the first slab in bytes.
+   */
+  explicit GpxArena(size_t initial_size = kDefaultInitialSize);
+
+  GpxArena(const GpxArena&) = delete;
+  GpxArena& operator=(const GpxArena&) = delete;
+
+  std::pmr::memory_resource* resource() noexcept { return &*resource_; }
+
+  /**
+   * @brief Releases all memory allocated from the arena.
+   */
+  void Reset();
+
+  /**
+   * @brief Size of the initial slab in bytes.
+   */
+  size_t capacity() const noexcept { return buffer_size_; }
+
+  /**
+   * @brief Bytes requested from the heap beyond the initial slab since the last reset.
+   */
+  size_t overflow() const noexcept { return upstream_.allocated(); }
+
+private:
+  // Forwards to the default resource at the time of construction, counting the
+  // bytes of the additional slabs.
+  class Upstream : public std::pmr::memory_resource
+  {
+  public:
+    size_t allocated() const noexcept { return allocated_; }
+    void reset() noexcept { allocated_ = 0; }
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* heap_ = std::pmr::get_default_resource();
+    size_t allocated_ = 0;
+  };
+
+  std::unique_ptr<std::byte[]> buffer_;
+  size_t buffer_size_ = 0;
+  Upstream upstream_;
+  std::optional<std::pmr::monotonic_buffer_resource> resource_;
+};
+
+} // namespace fastgpx
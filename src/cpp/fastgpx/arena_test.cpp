@@ -0,0 +1,104 @@
+#include <filesystem>
+#include <memory_resource>
+#include <string_view>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "fastgpx/arena.hpp"
+#include "fastgpx/fastgpx.hpp"
+
+using namespace fastgpx;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+TEST_CASE("Load GPX file into arena", "[arena]")
+{
+  // ~380km route
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  const auto reference = LoadGpx(path);
+
+  GpxArena arena(1024);
+  const auto gpx = LoadGpx(path, arena);
+
+  REQUIRE(gpx.tracks.size() == reference.tracks.size());
+  CHECK(gpx.tracks.get_allocator().resource() == arena.resource());
+  const auto& segment = gpx.tracks.front().segments.front();
+  CHECK(segment.columns.latitude.get_allocator().resource() == arena.resource());
+  CHECK(segment.columns == reference.tracks.front().segments.front().columns);
+  CHECK(gpx.GetLength2D() == reference.GetLength2D());
+  CHECK(gpx.GetTimeBounds() == reference.GetTimeBounds());
+  CHECK(arena.overflow() > 0);
+
+  SECTION("Copies use the default resource")
+  {
+    const Segment copy = segment;
+    CHECK(copy.columns.latitude.get_allocator().resource() == std::pmr::get_default_resource());
+    CHECK(copy.columns == segment.columns);
+  }
+}
+
+TEST_CASE("Reuse arena for successive documents", "[arena]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  const auto reference = LoadGpx(path);
+
+  GpxArena arena(1024);
+  {
+    const auto gpx = LoadGpx(path, arena);
+    REQUIRE(arena.overflow() > 0);
+  }
+  const size_t used = arena.capacity() + arena.overflow();
+  arena.Reset();
+  CHECK(arena.capacity() == used);
+  CHECK(arena.overflow() == 0);
+
+  // The same document now fits in the initial slab.
+  const auto gpx = LoadGpx(path, arena, {.memory_map = true});
+  CHECK(arena.overflow() == 0);
+  CHECK(gpx.GetLength3D() == reference.GetLength3D());
+}
+
+TEST_CASE("Parse GPX data into arena", "[arena]")
+{
+  constexpr std::string_view xml = R"(<?xml version="1.0" encoding="UTF-8"?>
+<gpx version="1.1" creator="fastgpx">
+  <trk>
+    <name>Arena</name>
+    <trkseg>
+      <trkpt lat="59.0" lon="10.0"><ele>1.0</ele><time>2024-05-18T09:49:59Z</time></trkpt>
+      <trkpt lat="59.1" lon="10.1"><ele>2.0</ele></trkpt>
+    </trkseg>
+  </trk>
+</gpx>)";
+
+  GpxArena arena;
+  const auto gpx = ParseGpx(xml, arena);
+
+  REQUIRE(gpx.tracks.size() == 1);
+  CHECK(gpx.tracks[0].name == "Arena");
+  REQUIRE(gpx.tracks[0].segments.size() == 1);
+  const auto& columns = gpx.tracks[0].segments[0].columns;
+  CHECK(columns.time.size() == 2);
+  CHECK(columns.time[0].has_value());
+  CHECK_FALSE(columns.time[1].has_value());
+  CHECK(gpx.tracks[0].segments.get_allocator().resource() == arena.resource());
+  CHECK(arena.overflow() == 0);
+}
+
+TEST_CASE("Benchmark arena allocation", "[!benchmark][arena]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+
+  BENCHMARK("Default resource")
+  {
+    return LoadGpx(path).tracks.size();
+  };
+
+  GpxArena arena;
+  BENCHMARK("Reused arena")
+  {
+    arena.Reset();
+    return LoadGpx(path, arena).tracks.size();
+  };
+}
@@ -0,0 +1,133 @@
+#include "fastgpx/batch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "fastgpx/archive.hpp"
+#include "fastgpx/filesystem.hpp"
+#include "fastgpx/parallel.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+// Calls `load` for each index in `[0, sizes.size())`, largest size first.
+std::vector<Gpx> LoadLargestFirst(std::span<const uintmax_t> sizes, const size_t threads,
+                                  const std::function<Gpx(size_t)>& load)
+{
+  std::vector<Gpx> gpx_files(sizes.size());
+  std::vector<std::exception_ptr> errors(sizes.size());
+
+  // Schedule the largest files first. Combined with the workers pulling the
+  // next file as they become idle, the small files fill in around the large
+  // ones instead of queuing up behind them.
+  std::vector<size_t> order(sizes.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::ranges::stable_sort(order, [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+  // Errors are collected per file rather than aborting the batch, such that the
+  // error reported is deterministic regardless of scheduling.
+  ParallelFor(sizes.size(), threads, [&](const size_t order_index) {
+    const size_t index = order[order_index];
+    try
+    {
+      gpx_files[index] = load(index);
+    }
+    catch (...)
+    {
+      errors[index] = std::current_exception();
+    }
+  });
+
+  for (const auto& error : errors)
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+  return gpx_files;
+}
+
+} // namespace
+
+std::vector<Gpx> LoadGpxFiles(std::span<const std::filesystem::path> paths,
+                              const LoadOptions& options, const size_t threads)
+{
+  std::vector<uintmax_t> sizes(paths.size());
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    std::error_code error;
+    const auto size = std::filesystem::file_size(paths[i], error);
+    sizes[i] = error ? 0 : size;
+  }
+
+  return LoadLargestFirst(sizes, threads, [&](const size_t index) {
+    // The parser only takes the parse options.
+    if (options.memory_map || options.threads != 1 || options.cache_dir.has_value())
+    {
+      return LoadGpx(paths[index], options);
+    }
+    // Each worker keeps its parser warm for the files it picks up.
+    thread_local GpxParser parser;
+    return parser.Load(paths[index], options.parse);
+  });
+}
+
+std::vector<std::pair<std::filesystem::path, Gpx>>
+LoadGpxDirectory(const std::filesystem::path& root, std::string_view pattern, bool recursive,
+                 const LoadOptions& options, size_t threads)
+{
+  const auto paths = find_files(root, pattern, recursive);
+  auto gpx_files = LoadGpxFiles(paths, options, threads);
+
+  std::vector<std::pair<std::filesystem::path, Gpx>> result;
+  result.reserve(paths.size());
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    result.emplace_back(paths[i], std::move(gpx_files[i]));
+  }
+  return result;
+}
+
+std::vector<std::pair<std::filesystem::path, Gpx>>
+LoadGpxArchive(const std::filesystem::path& path, const ParseOptions& options, size_t threads)
+{
+  const ZipArchive archive(path);
+  std::vector<const ZipEntry*> entries;
+  std::vector<uintmax_t> sizes;
+  for (const auto& entry : archive.entries())
+  {
+    if (entry.IsGpx())
+    {
+      entries.push_back(&entry);
+      sizes.push_back(entry.size);
+    }
+  }
+
+  auto gpx_files = LoadLargestFirst(sizes, threads, [&](const size_t index) {
+    return ParseGpxArchiveEntry(archive, *entries[index], options);
+  });
+
+  std::vector<std::pair<std::filesystem::path, Gpx>> result;
+  result.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    const auto& name = entries[i]->name;
+    const std::u8string_view utf8_name(reinterpret_cast<const char8_t*>(name.data()),
+                                       name.size());
+    result.emplace_back(std::filesystem::path(utf8_name), std::move(gpx_files[i]));
+  }
+  return result;
+}
+
+} // namespace fastgpx
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+/**
+ * @brief Loads multiple GPX files concurrently.
+ *
+ * The largest files are started first, such that a single large file doesn't
+ * end up as the tail of the batch while the other workers are idle.
+ *
+ * @throws parse_error for the first file, in input order, that failed to load.
+ * @param paths
+ * @param options Options applied to every file.
+ * @param threads Number of worker threads, or 0 for one per hardware thread.
+ * @return std::vector<Gpx> The loaded files, in the same order as `paths`.
+ */
+std::vector<Gpx> LoadGpxFiles(std::span<const std::filesystem::path> paths,
+                              const LoadOptions& options = {}, size_t threads = 0);
+
+/**
+ * @brief Loads the GPX files in a directory concurrently.
+ *
+ * @throws parse_error for the first file, in path order, that failed to load.
+ * @throws std::filesystem::filesystem_error if the directory cannot be read.
+ * @param root
+ * @param pattern Glob pattern matched against file names.
+ * @param recursive Include files in subdirectories.
+ * @param options Options applied to every file.
+ * @param threads Number of worker threads, or 0 for one per hardware thread.
+ * @return The path and loaded data of each file, sorted by path.
+ */
+std::vector<std::pair<std::filesystem::path, Gpx>>
+LoadGpxDirectory(const std::filesystem::path& root, std::string_view pattern = "*.gpx",
+                 bool recursive = true, const LoadOptions& options = {}, size_t threads = 0);
+
+/**
+ * @brief Loads the GPX files in a ZIP archive concurrently.
+ *
+ * The archive is memory-mapped, and each member is decompressed straight into
+ * the parser by the worker loading it. The largest members are started first.
+ *
+ * @throws parse_error if the archive cannot be read, or for the first member,
+ *   in archive order, that failed to load.
+ * @param path
+ * @param options Options applied to every file.
+ * @param threads Number of worker threads, or 0 for one per hardware thread.
+ * @return The path within the archive and loaded data of each `.gpx` member,
+ *   in archive order.
+ */
+std::vector<std::pair<std::filesystem::path, Gpx>>
+LoadGpxArchive(const std::filesystem::path& path, const ParseOptions& options = {},
+               size_t threads = 0);
+
+} // namespace fastgpx
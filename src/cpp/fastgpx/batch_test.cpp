@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "fastgpx/archive.hpp"
+#include "fastgpx/batch.hpp"
+#include "fastgpx/cache.hpp"
+#include "fastgpx/errors.hpp"
+#include "fastgpx/fastgpx.hpp"
+#include "fastgpx/test_data.hpp"
+
+using Catch::Generators::as;
+using Catch::Matchers::WithinAbs;
+
+using namespace fastgpx;
+
+// Sufficient tolerance for comparing meters.
+constexpr double kMETERS_TOL = 1e-4;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+namespace {
+
+std::vector<std::filesystem::path> ExpectedGpxPaths(const std::vector<ExpectedGpx>& expected_data)
+{
+  std::vector<std::filesystem::path> paths;
+  for (const auto& expected_gpx : expected_data)
+  {
+    paths.push_back(project_path / expected_gpx.path);
+  }
+  return paths;
+}
+
+} // namespace
+
+TEST_CASE("Load multiple GPX files in parallel", "[batch][real_world]")
+{
+  const auto json_path = project_path / "src/cpp/expected_gpx_data.json";
+  const auto expected_data = LoadExpectedGpxData(json_path);
+  const auto paths = ExpectedGpxPaths(expected_data);
+
+  const size_t threads = GENERATE(as<size_t>{}, 0, 1, 4);
+  CAPTURE(threads);
+
+  const auto gpx_files = LoadGpxFiles(paths, {}, threads);
+
+  REQUIRE(gpx_files.size() == expected_data.size());
+  for (size_t i = 0; i < gpx_files.size(); i++)
+  {
+    CAPTURE(expected_data[i].path);
+    CHECK(gpx_files[i].tracks.size() == expected_data[i].tracks.size());
+    CHECK_THAT(gpx_files[i].GetLength2D(), WithinAbs(expected_data[i].length2d, kMETERS_TOL));
+  }
+}
+
+TEST_CASE("Load multiple GPX files with a missing file", "[batch]")
+{
+  const std::vector<std::filesystem::path> paths{
+      project_path / "gpx/test/debug-segment.gpx",
+      project_path / "gpx/not-a-real-path/fake.gpx",
+      project_path / "gpx/test/debug-segment.gpx",
+  };
+  REQUIRE_THROWS_AS(LoadGpxFiles(paths, {}, 2), parse_error);
+}
+
+TEST_CASE("Load multiple GPX files through cache directory", "[batch][cache]")
+{
+  const std::vector<std::filesystem::path> paths{
+      project_path / "gpx/test/debug-segment.gpx",
+      project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx",
+  };
+  const auto cache_dir = std::filesystem::temp_directory_path() / "fastgpx_batch_test_cache";
+  std::filesystem::remove_all(cache_dir);
+  const LoadOptions options{.cache_dir = cache_dir};
+
+  const auto gpx_files = LoadGpxFiles(paths, options, 2);
+  REQUIRE(gpx_files.size() == paths.size());
+  for (size_t i = 0; i < paths.size(); i++)
+  {
+    CAPTURE(paths[i]);
+    const auto key = MakeGpxCacheKey(paths[i], options.parse);
+    REQUIRE(key.has_value());
+    CHECK(std::filesystem::exists(cache_dir / key->FileName()));
+    CHECK_THAT(gpx_files[i].GetLength2D(), WithinAbs(LoadGpx(paths[i]).GetLength2D(), kMETERS_TOL));
+  }
+
+  std::filesystem::remove_all(cache_dir);
+}
+
+TEST_CASE("Load GPX files in directory", "[batch]")
+{
+  const auto root = project_path / "gpx/test";
+  const auto gpx_files = LoadGpxDirectory(root, "*.gpx", false, {}, 2);
+
+  REQUIRE(gpx_files.size() == 4);
+  CHECK(gpx_files[0].first == root / "debug-segment.gpx");
+  CHECK_THAT(gpx_files[0].second.GetLength2D(), WithinAbs(1.3839, kMETERS_TOL));
+  for (const auto& [path, gpx] : gpx_files)
+  {
+    CAPTURE(path);
+    CHECK(gpx.GetLength2D() == LoadGpx(path).GetLength2D());
+  }
+}
+
+TEST_CASE("Load GPX files in directory matching pattern", "[batch]")
+{
+  const auto root = project_path / "gpx/2024 TopCamp";
+  const auto gpx_files = LoadGpxDirectory(root, "Connected_*.gpx");
+
+  REQUIRE_FALSE(gpx_files.empty());
+  for (const auto& [path, gpx] : gpx_files)
+  {
+    CAPTURE(path);
+    CHECK(path.filename().u8string().starts_with(u8"Connected_"));
+    CHECK_FALSE(gpx.tracks.empty());
+  }
+}
+
+TEST_CASE("Load no GPX files", "[batch]")
+{
+  CHECK(LoadGpxFiles({}).empty());
+}
+
+TEST_CASE("Load GPX files in ZIP archive", "[batch][compressed]")
+{
+  const auto path =
+      project_path / "gpx/third-party/github.com_gps-touring_sample-gpx/sample-gpx-master.zip";
+
+  const size_t threads = GENERATE(as<size_t>{}, 1, 4);
+  CAPTURE(threads);
+
+  const auto gpx_files = LoadGpxArchive(path, {}, threads);
+
+  REQUIRE(gpx_files.size() == 78);
+  const std::string first_name = "sample-gpx-master/BrittanyJura/Alt_Portsmouth.gpx";
+  CHECK(gpx_files[0].first == std::filesystem::path(first_name));
+
+  const ZipArchive archive(path);
+  const auto entry = std::ranges::find(archive.entries(), first_name, &ZipEntry::name);
+  REQUIRE(entry != archive.entries().end());
+  const auto reference = ParseGpxArchiveEntry(archive, *entry);
+  CHECK_FALSE(reference.tracks.empty());
+  CHECK(gpx_files[0].second.GetLength2D() == reference.GetLength2D());
+}
+
+TEST_CASE("Load GPX files in missing ZIP archive", "[batch][compressed]")
+{
+  REQUIRE_THROWS_AS(LoadGpxArchive(project_path / "gpx/not-a-real-path/fake.zip"), parse_error);
+  REQUIRE_THROWS_AS(LoadGpxArchive(project_path / "gpx/test/segment.gpx"), parse_error);
+}
+
+TEST_CASE("Benchmark GPX Batch Loading", "[!benchmark][batch]")
+{
+  const auto json_path = project_path / "src/cpp/expected_gpx_data.json";
+  const auto paths = ExpectedGpxPaths(LoadExpectedGpxData(json_path));
+
+  BENCHMARK("Sequential")
+  {
+    return LoadGpxFiles(paths, {}, 1);
+  };
+
+  BENCHMARK("Parallel")
+  {
+    return LoadGpxFiles(paths);
+  };
+}
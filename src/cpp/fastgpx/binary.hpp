@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "fastgpx/errors.hpp"
+#include "fastgpx/fastgpx.hpp"
+
+/**
+ * @brief Helpers for the binary files written next to the GPX data, such as
+ *   the document cache and the catalog.
+ *
+ * Values are stored in native byte order and layout. Files carry a byte order
+ * mark and a version so that readers can reject what they can't read, and are
+ * then rebuilt from the GPX files.
+ */
+namespace fastgpx::binary {
+
+// Alignment of every field, such that columns are aligned in a memory mapping.
+constexpr size_t kAlignment = 8;
+// Reads back differently on platforms of another byte order.
+constexpr uint32_t kByteOrderMark = 0x01020304;
+// Length of a missing optional string.
+constexpr uint64_t kNoString = std::numeric_limits<uint64_t>::max();
+
+static_assert(sizeof(TimeColumn::rep) == 8);
+
+// FNV-1a, which is stable across platforms and runs unlike `std::hash`.
+class Fnv1a
+{
+public:
+  void Add(std::string_view bytes) noexcept
+  {
+    for (const char c : bytes)
+    {
+      hash_ ^= static_cast<unsigned char>(c);
+      hash_ *= 0x100000001B3;
+    }
+  }
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  void Add(const T& value) noexcept
+  {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    Add(std::string_view(bytes, sizeof(T)));
+  }
+
+  uint64_t value() const noexcept { return hash_; }
+
+private:
+  uint64_t hash_ = 0xCBF29CE484222325;
+};
+
+// Appends fields, each padded to `kAlignment`.
+class Writer
+{
+public:
+  const std::string& data() const noexcept { return data_; }
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  void Write(const T& value)
+  {
+    WriteBytes(&value, sizeof(T));
+  }
+
+  void Write(const std::optional<std::string>& text)
+  {
+    Write<uint64_t>(text.has_value() ? text->size() : kNoString);
+    if (text.has_value())
+    {
+      WriteBytes(text->data(), text->size());
+    }
+  }
+
+  template <typename T>
+  void WriteColumn(std::span<const T> values)
+  {
+    WriteBytes(values.data(), values.size_bytes());
+  }
+
+  void Write(const Bounds& bounds)
+  {
+    for (const auto& corner : {bounds.min, bounds.max})
+    {
+      const LatLong point = corner.value_or(LatLong{});
+      Write<uint64_t>(corner.has_value());
+      Write(point.latitude);
+      Write(point.longitude);
+      Write(point.elevation);
+    }
+  }
+
+  void Write(const TimeBounds& time_bounds)
+  {
+    for (const auto& time : {time_bounds.start_time, time_bounds.end_time})
+    {
+      Write<uint64_t>(time.has_value());
+      Write<TimeColumn::rep>(time.has_value() ? time->time_since_epoch().count() : 0);
+    }
+  }
+
+  void Write(const Metrics& metrics)
+  {
+    Write(metrics.bounds);
+    Write(metrics.time_bounds);
+    Write(metrics.length2d);
+    Write(metrics.length3d);
+  }
+
+private:
+  void WriteBytes(const void* bytes, const size_t size)
+  {
+    data_.append(static_cast<const char*>(bytes), size);
+    data_.resize((data_.size() + kAlignment - 1) / kAlignment * kAlignment);
+  }
+
+  std::string data_;
+};
+
+// Reads the fields written by `Writer`, throwing `parse_error` for data out of
+// bounds.
+class Reader
+{
+public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  T Read()
+  {
+    T value;
+    std::memcpy(&value, ReadBytes(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::optional<std::string> ReadString()
+  {
+    const auto size = Read<uint64_t>();
+    if (size == kNoString)
+    {
+      return std::nullopt;
+    }
+    const size_t length = ReadCount(size, 1);
+    return std::string(ReadBytes(length), length);
+  }
+
+  // Reads a column of `count` values in place in the data.
+  template <typename T>
+  std::span<const T> ReadColumn(const size_t count)
+  {
+    const auto* values = reinterpret_cast<const T*>(ReadBytes(count * sizeof(T)));
+    return {values, count};
+  }
+
+  Bounds ReadBounds()
+  {
+    Bounds bounds;
+    for (auto* corner : {&bounds.min, &bounds.max})
+    {
+      const bool has_value = Read<uint64_t>() != 0;
+      const LatLong point{Read<double>(), Read<double>(), Read<double>()};
+      if (has_value)
+      {
+        *corner = point;
+      }
+    }
+    return bounds;
+  }
+
+  TimeBounds ReadTimeBounds()
+  {
+    TimeBounds time_bounds;
+    for (auto* time : {&time_bounds.start_time, &time_bounds.end_time})
+    {
+      const bool has_value = Read<uint64_t>() != 0;
+      const auto ticks = Read<TimeColumn::rep>();
+      if (has_value)
+      {
+        *time = TimeColumn::time_point(TimeColumn::time_point::duration(ticks));
+      }
+    }
+    return time_bounds;
+  }
+
+  Metrics ReadMetrics()
+  {
+    Metrics metrics;
+    metrics.bounds = ReadBounds();
+    metrics.time_bounds = ReadTimeBounds();
+    metrics.length2d = Read<double>();
+    metrics.length3d = Read<double>();
+    return metrics;
+  }
+
+  // Reads a count of elements taking at least `element_size` bytes each, which
+  // must fit in the rest of the data.
+  size_t ReadCount(const uint64_t count, const size_t element_size)
+  {
+    if (count > (data_.size() - pos_) / element_size)
+    {
+      throw parse_error("Invalid binary data: count exceeds the data");
+    }
+    return static_cast<size_t>(count);
+  }
+
+  size_t ReadCount(const size_t element_size) { return ReadCount(Read<uint64_t>(), element_size); }
+
+  size_t pos() const noexcept { return pos_; }
+  bool AtEnd() const noexcept { return pos_ == data_.size(); }
+
+private:
+  const char* ReadBytes(const size_t size)
+  {
+    const size_t padded = (size + kAlignment - 1) / kAlignment * kAlignment;
+    if (size > data_.size() - pos_ || padded > data_.size() - pos_)
+    {
+      throw parse_error("Invalid binary data: unexpected end of data");
+    }
+    const char* bytes = data_.data() + pos_;
+    pos_ += padded;
+    return bytes;
+  }
+
+  std::string_view data_;
+  size_t pos_ = 0;
+};
+
+} // namespace fastgpx::binary
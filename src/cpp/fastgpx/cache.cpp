@@ -0,0 +1,298 @@
+#include "fastgpx/cache.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "fastgpx/binary.hpp"
+#include "fastgpx/errors.hpp"
+#include "fastgpx/filesystem.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+constexpr std::string_view kCacheMagic = "FGPXCACH";
+constexpr std::string_view kCacheEndMagic = "FGPX_END";
+// Bump when the layout of the cache files changes.
+constexpr uint32_t kCacheVersion = 1;
+
+using binary::Fnv1a;
+
+uint64_t HashParseOptions(const ParseOptions& options)
+{
+  Fnv1a hash;
+  hash.Add(options.elevation);
+  hash.Add(options.time);
+  hash.Add(options.metadata);
+  hash.Add(options.track_index.has_value());
+  hash.Add(static_cast<uint64_t>(options.track_index.value_or(0)));
+  hash.Add(options.track_name.has_value());
+  hash.Add(options.track_name.value_or(""));
+  return hash.value();
+}
+
+Metrics GetMetrics(const auto& object)
+{
+  return Metrics{
+      .bounds = object.GetBounds(),
+      .length2d = object.GetLength2D(),
+      .length3d = object.GetLength3D(),
+      .time_bounds = object.GetTimeBounds(),
+  };
+}
+
+void WriteSegment(binary::Writer& writer, const Segment& segment)
+{
+  const auto& columns = segment.columns;
+  writer.Write<uint64_t>(columns.size());
+  writer.Write(GetMetrics(segment));
+  writer.WriteColumn<double>(columns.latitude);
+  writer.WriteColumn<double>(columns.longitude);
+  writer.WriteColumn<double>(columns.elevation);
+  for (size_t i = 0; i < columns.time.size(); ++i)
+  {
+    const auto time = columns.time[i];
+    writer.Write(time.has_value() ? time->time_since_epoch().count() : TimeColumn::kNoTime);
+  }
+}
+
+void ReadSegment(binary::Reader& reader, Segment& segment)
+{
+  // Each point takes 32 bytes of columns.
+  const size_t count = reader.ReadCount(4 * sizeof(double));
+  const Metrics metrics = reader.ReadMetrics();
+
+  auto& columns = segment.columns;
+  const auto copy_column = [&](auto& column) {
+    const auto values = reader.ReadColumn<double>(count);
+    column.assign(values.begin(), values.end());
+  };
+  copy_column(columns.latitude);
+  copy_column(columns.longitude);
+  copy_column(columns.elevation);
+  columns.time.reserve(count);
+  columns.time.append(reader.ReadColumn<TimeColumn::rep>(count));
+
+  segment.SetMetrics(metrics);
+}
+
+void WriteDocument(binary::Writer& writer, const Gpx& gpx)
+{
+  writer.Write(gpx.name);
+  writer.Write(GetMetrics(gpx));
+  writer.Write<uint64_t>(gpx.tracks.size());
+  for (const auto& track : gpx.tracks)
+  {
+    writer.Write(track.name);
+    writer.Write(track.comment);
+    writer.Write(track.description);
+    writer.Write<uint64_t>(track.number.has_value());
+    writer.Write<uint64_t>(track.number.value_or(0));
+    writer.Write(track.type);
+    writer.Write(GetMetrics(track));
+    writer.Write<uint64_t>(track.segments.size());
+    for (const auto& segment : track.segments)
+    {
+      WriteSegment(writer, segment);
+    }
+  }
+}
+
+Gpx ReadDocument(binary::Reader& reader, std::pmr::memory_resource* resource)
+{
+  Gpx gpx(resource);
+  gpx.name = reader.ReadString();
+  const Metrics metrics = reader.ReadMetrics();
+  const size_t track_count = reader.ReadCount(binary::kAlignment);
+  gpx.tracks.reserve(track_count);
+  for (size_t i = 0; i < track_count; ++i)
+  {
+    auto& track = gpx.tracks.emplace_back(resource);
+    track.name = reader.ReadString();
+    track.comment = reader.ReadString();
+    track.description = reader.ReadString();
+    const bool has_number = reader.Read<uint64_t>() != 0;
+    const auto number = reader.Read<uint64_t>();
+    if (has_number)
+    {
+      track.number = static_cast<size_t>(number);
+    }
+    track.type = reader.ReadString();
+    const Metrics track_metrics = reader.ReadMetrics();
+
+    const size_t segment_count = reader.ReadCount(binary::kAlignment);
+    track.segments.reserve(segment_count);
+    for (size_t j = 0; j < segment_count; ++j)
+    {
+      ReadSegment(reader, track.segments.emplace_back(resource));
+    }
+    track.SetMetrics(track_metrics);
+  }
+  gpx.SetMetrics(metrics);
+  return gpx;
+}
+
+void WriteHeader(binary::Writer& writer, const GpxCacheKey& key)
+{
+  writer.WriteColumn<char>(kCacheMagic);
+  writer.Write(kCacheVersion);
+  writer.Write(binary::kByteOrderMark);
+  writer.Write(key.source_size);
+  writer.Write(key.source_mtime);
+  writer.Write(key.options_hash);
+  writer.Write(std::optional<std::string>(key.source));
+}
+
+// Returns false if the cache file is of another version or key.
+bool ReadHeader(binary::Reader& reader, const GpxCacheKey& key)
+{
+  const auto magic = reader.ReadColumn<char>(kCacheMagic.size());
+  if (std::string_view(magic.data(), magic.size()) != kCacheMagic)
+  {
+    return false;
+  }
+  if (reader.Read<uint32_t>() != kCacheVersion || reader.Read<uint32_t>() != binary::kByteOrderMark)
+  {
+    return false;
+  }
+
+  GpxCacheKey cached;
+  cached.source_size = reader.Read<uint64_t>();
+  cached.source_mtime = reader.Read<int64_t>();
+  cached.options_hash = reader.Read<uint64_t>();
+  cached.source = reader.ReadString().value_or("");
+  return cached == key;
+}
+
+} // namespace
+
+std::string GpxCacheKey::FileName() const
+{
+  Fnv1a hash;
+  hash.Add(source);
+  hash.Add(options_hash);
+  return std::format("{:016x}.gpxcache", hash.value());
+}
+
+std::optional<GpxCacheKey> MakeGpxCacheKey(const std::filesystem::path& path,
+                                           const ParseOptions& options)
+{
+  std::error_code error;
+  const auto absolute = std::filesystem::absolute(path, error).lexically_normal();
+  if (error)
+  {
+    return std::nullopt;
+  }
+  const auto size = std::filesystem::file_size(absolute, error);
+  if (error)
+  {
+    return std::nullopt;
+  }
+  const auto mtime = std::filesystem::last_write_time(absolute, error);
+  if (error)
+  {
+    return std::nullopt;
+  }
+
+  const auto source = absolute.generic_u8string();
+  return GpxCacheKey{
+      .source = std::string(source.begin(), source.end()),
+      .source_size = static_cast<uint64_t>(size),
+      .source_mtime = static_cast<int64_t>(mtime.time_since_epoch().count()),
+      .options_hash = HashParseOptions(options),
+  };
+}
+
+bool WriteGpxCache(const Gpx& gpx, const GpxCacheKey& key, const std::filesystem::path& path)
+{
+  binary::Writer writer;
+  try
+  {
+    WriteHeader(writer, key);
+    // Computes the metrics, which parses the times of the points.
+    WriteDocument(writer, gpx);
+  }
+  catch (const parse_error&)
+  {
+    // An invalid time is only an error once the times are used, so the
+    // document is left uncached rather than failing the load.
+    return false;
+  }
+  writer.WriteColumn<char>(kCacheEndMagic);
+
+  std::error_code error;
+  if (path.has_parent_path())
+  {
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+
+  // Unique per writer, such that concurrent loads of the same file don't write
+  // to the same temporary file.
+  const auto unique = std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+                      static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  auto temp_path = path;
+  temp_path += std::format(".{:x}.tmp", unique);
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+    file.close();
+    if (!file)
+    {
+      std::filesystem::remove(temp_path, error);
+      return false;
+    }
+  }
+  std::filesystem::rename(temp_path, path, error);
+  if (error)
+  {
+    std::filesystem::remove(temp_path, error);
+    return false;
+  }
+  return true;
+}
+
+std::optional<Gpx> ReadGpxCache(const std::filesystem::path& path, const GpxCacheKey& key,
+                                std::pmr::memory_resource* resource)
+{
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(path, error))
+  {
+    return std::nullopt;
+  }
+
+  try
+  {
+    const MappedFile file(path);
+    binary::Reader reader(file.data());
+    if (!ReadHeader(reader, key))
+    {
+      return std::nullopt;
+    }
+    Gpx gpx = ReadDocument(reader, resource);
+    const auto end = reader.ReadColumn<char>(kCacheEndMagic.size());
+    if (std::string_view(end.data(), end.size()) != kCacheEndMagic || !reader.AtEnd())
+    {
+      return std::nullopt;
+    }
+    return gpx;
+  }
+  catch (const std::exception&)
+  {
+    // A corrupt cache file is replaced by the next load of the source.
+    return std::nullopt;
+  }
+}
+
+} // namespace fastgpx
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory_resource>
+#include <optional>
+#include <string>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+// Identifies the GPX file and the options a cache file was written for. A cache
+// file is only read back with an equal key.
+struct GpxCacheKey
+{
+  // Absolute UTF-8 path of the GPX file.
+  std::string source;
+  uint64_t source_size = 0;
+  // Ticks of the last write time of the GPX file.
+  int64_t source_mtime = 0;
+  // Hash of the `ParseOptions`, which change the parsed data.
+  uint64_t options_hash = 0;
+
+  bool operator==(const GpxCacheKey&) const = default;
+
+  // Name of the cache file, derived from the source path and the options. The
+  // cache file of a modified source file is replaced rather than added to.
+  std::string FileName() const;
+};
+
+/**
+ * @brief Computes the cache key of a GPX file from its path, size and
+ *   modification time.
+ *
+ * @param path
+ * @param options
+ * @return std::nullopt if the file does not exist or cannot be read.
+ */
+std::optional<GpxCacheKey> MakeGpxCacheKey(const std::filesystem::path& path,
+                                           const ParseOptions& options);
+
+/**
+ * @brief Writes a GPX document to a binary cache file.
+ *
+ * The file starts with a header holding the format version and the key. The
+ * points of each segment follow as columns of native doubles and time ticks,
+ * aligned to 8 bytes such that they can be copied out of a memory mapping in
+ * bulk. The bounds, lengths and time bounds of the document, tracks and
+ * segments are computed if needed and stored as well.
+ *
+ * The data is written to a temporary file that is renamed into place, so
+ * concurrent readers never see a partial cache file.
+ *
+ * @param gpx
+ * @param key
+ * @param path Its parent directories are created if needed.
+ * @return false if the file could not be written, or a time of a point is
+ *   invalid.
+ */
+bool WriteGpxCache(const Gpx& gpx, const GpxCacheKey& key, const std::filesystem::path& path);
+
+/**
+ * @brief Reads a GPX document from a cache file written by `WriteGpxCache`.
+ *
+ * The file is memory-mapped and the point columns copied into the document
+ * without any parsing. The stored metrics are restored, rather than computed
+ * again on first use.
+ *
+ * @param path
+ * @param key
+ * @param resource Memory resource of the tracks, segments and points.
+ * @return std::nullopt if the file is missing, was written by another version
+ *   of the format, for another key or on a platform of another byte order, or
+ *   is corrupt.
+ */
+std::optional<Gpx> ReadGpxCache(const std::filesystem::path& path, const GpxCacheKey& key,
+                                std::pmr::memory_resource* resource =
+                                    std::pmr::get_default_resource());
+
+} // namespace fastgpx
@@ -0,0 +1,207 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "fastgpx/cache.hpp"
+#include "fastgpx/errors.hpp"
+#include "fastgpx/fastgpx.hpp"
+
+using namespace fastgpx;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+namespace {
+
+const auto gpx_path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+
+// Empty directory for the cache files of a test, removed afterwards.
+class TempDirectory
+{
+public:
+  explicit TempDirectory(const std::string& name)
+      : path_(std::filesystem::temp_directory_path() / name)
+  {
+    std::filesystem::remove_all(path_);
+  }
+  ~TempDirectory() { std::filesystem::remove_all(path_); }
+
+  const std::filesystem::path& path() const noexcept { return path_; }
+
+private:
+  std::filesystem::path path_;
+};
+
+void CheckSameGpx(const Gpx& actual, const Gpx& expected)
+{
+  CHECK(actual.name == expected.name);
+  CHECK(actual.GetLength2D() == expected.GetLength2D());
+  CHECK(actual.GetLength3D() == expected.GetLength3D());
+  CHECK(actual.GetBounds() == expected.GetBounds());
+  CHECK(actual.GetTimeBounds() == expected.GetTimeBounds());
+  REQUIRE(actual.tracks.size() == expected.tracks.size());
+  for (size_t track_index = 0; track_index < actual.tracks.size(); ++track_index)
+  {
+    const auto& track = actual.tracks[track_index];
+    const auto& expected_track = expected.tracks[track_index];
+    CHECK(track.name == expected_track.name);
+    CHECK(track.number == expected_track.number);
+    CHECK(track.GetLength2D() == expected_track.GetLength2D());
+    REQUIRE(track.segments.size() == expected_track.segments.size());
+    for (size_t segment_index = 0; segment_index < track.segments.size(); ++segment_index)
+    {
+      const auto& segment = track.segments[segment_index];
+      const auto& expected_segment = expected_track.segments[segment_index];
+      CHECK(segment.columns == expected_segment.columns);
+      CHECK(segment.GetLength3D() == expected_segment.GetLength3D());
+      CHECK(segment.GetTimeBounds() == expected_segment.GetTimeBounds());
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Write and read GPX cache", "[cache]")
+{
+  const TempDirectory directory("fastgpx_cache_test_roundtrip");
+  const Gpx expected = LoadGpx(gpx_path);
+  const auto key = MakeGpxCacheKey(gpx_path, {});
+  REQUIRE(key.has_value());
+  CHECK(key->source_size == std::filesystem::file_size(gpx_path));
+
+  const auto cache_path = directory.path() / key->FileName();
+  REQUIRE(WriteGpxCache(expected, *key, cache_path));
+
+  const auto gpx = ReadGpxCache(cache_path, *key);
+  REQUIRE(gpx.has_value());
+  CheckSameGpx(*gpx, expected);
+}
+
+TEST_CASE("Write and read GPX cache of empty and partial documents", "[cache]")
+{
+  const TempDirectory directory("fastgpx_cache_test_partial");
+  const auto key = MakeGpxCacheKey(gpx_path, {});
+  REQUIRE(key.has_value());
+
+  Gpx expected;
+  expected.tracks.emplace_back().number = 3;
+  auto& track = expected.tracks.emplace_back();
+  track.name = "";
+  track.segments.emplace_back();
+  track.segments.emplace_back().columns.push_back({1.0, 2.0, 3.0}, std::nullopt);
+
+  const auto cache_path = directory.path() / key->FileName();
+  REQUIRE(WriteGpxCache(expected, *key, cache_path));
+  const auto gpx = ReadGpxCache(cache_path, *key);
+  REQUIRE(gpx.has_value());
+  CheckSameGpx(*gpx, expected);
+  CHECK_FALSE(gpx->tracks[0].name.has_value());
+  CHECK(gpx->tracks[1].name == "");
+}
+
+TEST_CASE("GPX cache is ignored for another key", "[cache]")
+{
+  const TempDirectory directory("fastgpx_cache_test_key");
+  const auto key = MakeGpxCacheKey(gpx_path, {});
+  REQUIRE(key.has_value());
+  const auto cache_path = directory.path() / key->FileName();
+  REQUIRE(WriteGpxCache(LoadGpx(gpx_path), *key, cache_path));
+
+  auto modified = *key;
+  modified.source_mtime++;
+  CHECK_FALSE(ReadGpxCache(cache_path, modified).has_value());
+
+  modified = *key;
+  modified.source_size--;
+  CHECK_FALSE(ReadGpxCache(cache_path, modified).has_value());
+
+  const auto options_key = MakeGpxCacheKey(gpx_path, {.time = false});
+  REQUIRE(options_key.has_value());
+  CHECK(options_key->FileName() != key->FileName());
+  CHECK_FALSE(ReadGpxCache(cache_path, *options_key).has_value());
+
+  CHECK_FALSE(ReadGpxCache(directory.path() / "missing.gpxcache", *key).has_value());
+  CHECK_FALSE(MakeGpxCacheKey(project_path / "gpx/not-a-real-path/fake.gpx", {}).has_value());
+}
+
+TEST_CASE("Corrupt GPX cache is ignored", "[cache]")
+{
+  const TempDirectory directory("fastgpx_cache_test_corrupt");
+  const auto key = MakeGpxCacheKey(gpx_path, {});
+  REQUIRE(key.has_value());
+  const auto cache_path = directory.path() / key->FileName();
+  REQUIRE(WriteGpxCache(LoadGpx(gpx_path), *key, cache_path));
+
+  std::filesystem::resize_file(cache_path, std::filesystem::file_size(cache_path) / 2);
+  CHECK_FALSE(ReadGpxCache(cache_path, *key).has_value());
+
+  {
+    std::ofstream file(cache_path, std::ios::binary | std::ios::trunc);
+    file << "not a cache file";
+  }
+  CHECK_FALSE(ReadGpxCache(cache_path, *key).has_value());
+}
+
+TEST_CASE("Load GPX file through cache directory", "[cache]")
+{
+  const TempDirectory directory("fastgpx_cache_test_load");
+  const Gpx expected = LoadGpx(gpx_path);
+  const LoadOptions options{.cache_dir = directory.path()};
+
+  // The first load writes the cache file, the second reads it.
+  const Gpx first = LoadGpx(gpx_path, options);
+  const auto key = MakeGpxCacheKey(gpx_path, {});
+  REQUIRE(key.has_value());
+  CHECK(std::filesystem::exists(directory.path() / key->FileName()));
+  const Gpx second = LoadGpx(gpx_path, options);
+  CheckSameGpx(first, expected);
+  CheckSameGpx(second, expected);
+
+  CHECK_THROWS_AS(LoadGpx(project_path / "gpx/not-a-real-path/fake.gpx", options), parse_error);
+}
+
+TEST_CASE("Load GPX file with invalid times through cache directory", "[cache]")
+{
+  const TempDirectory directory("fastgpx_cache_test_invalid_time");
+  const auto path = directory.path() / "invalid-time.gpx";
+  std::filesystem::create_directories(directory.path());
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << R"(<?xml version="1.0" encoding="UTF-8"?>
+<gpx version="1.1">
+  <trk><trkseg>
+    <trkpt lat="63.1" lon="10.2"><time>not a time</time></trkpt>
+    <trkpt lat="63.2" lon="10.3"><time>2024-05-18T07:50:00Z</time></trkpt>
+  </trkseg></trk>
+</gpx>)";
+  }
+
+  // Loads like without a cache, leaving the error to the use of the times.
+  const Gpx gpx = LoadGpx(path, {.cache_dir = directory.path()});
+  REQUIRE(gpx.tracks.size() == 1);
+  CHECK(gpx.tracks[0].segments[0].columns.size() == 2);
+  CHECK_THROWS_AS(gpx.GetTimeBounds(), parse_error);
+
+  const auto key = MakeGpxCacheKey(path, {});
+  REQUIRE(key.has_value());
+  CHECK_FALSE(std::filesystem::exists(directory.path() / key->FileName()));
+}
+
+TEST_CASE("Benchmark GPX cache", "[!benchmark][cache]")
+{
+  const TempDirectory directory("fastgpx_cache_test_benchmark");
+  const LoadOptions options{.cache_dir = directory.path()};
+  LoadGpx(gpx_path, options);
+
+  BENCHMARK("LoadGpx")
+  {
+    return LoadGpx(gpx_path);
+  };
+
+  BENCHMARK("LoadGpx cached")
+  {
+    return LoadGpx(gpx_path, options);
+  };
+}
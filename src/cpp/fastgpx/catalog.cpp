@@ -0,0 +1,533 @@
+#include "fastgpx/catalog.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "fastgpx/binary.hpp"
+#include "fastgpx/errors.hpp"
+#include "fastgpx/filesystem.hpp"
+#include "fastgpx/parallel.hpp"
+#include "fastgpx/summary.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+constexpr std::string_view kCatalogMagic = "FGPXCATL";
+// Bump when the layout of the index rows changes.
+constexpr uint32_t kCatalogVersion = 1;
+// Size of the magic, version and byte order mark.
+constexpr uint64_t kHeaderSize = 16;
+
+// Kinds of index rows.
+constexpr uint64_t kRemovedRow = 0;
+constexpr uint64_t kEntryRow = 1;
+
+// The names of the tracks and the document are not part of the entries.
+const ParseOptions kCatalogParseOptions{.metadata = false};
+
+std::string PathKey(const std::filesystem::path& path)
+{
+  const auto utf8 = path.generic_u8string();
+  return std::string(utf8.begin(), utf8.end());
+}
+
+std::filesystem::path PathFromKey(std::string_view key)
+{
+  return std::filesystem::path(
+      std::u8string_view(reinterpret_cast<const char8_t*>(key.data()), key.size()));
+}
+
+std::filesystem::path NormalizePath(const std::filesystem::path& path)
+{
+  return std::filesystem::absolute(path).lexically_normal();
+}
+
+// Whether the scan of `root` would list the file at `path`.
+bool InScanScope(const std::filesystem::path& path, const std::filesystem::path& root,
+                 std::string_view pattern, bool recursive)
+{
+  const auto relative = path.lexically_relative(root);
+  if (relative.empty() || *relative.begin() == "..")
+  {
+    return false;
+  }
+  if (!recursive && relative.has_parent_path())
+  {
+    return false;
+  }
+  return match_glob(pattern, PathKey(path.filename()));
+}
+
+void WriteHeader(binary::Writer& writer)
+{
+  writer.WriteColumn<char>(kCatalogMagic);
+  writer.Write(kCatalogVersion);
+  writer.Write(binary::kByteOrderMark);
+}
+
+// Writes a row as its payload size, payload hash and payload, such that a row
+// cut short or overwritten is detected on read.
+void WriteRow(binary::Writer& writer, const binary::Writer& payload)
+{
+  binary::Fnv1a hash;
+  hash.Add(std::string_view(payload.data()));
+  writer.Write<uint64_t>(payload.data().size());
+  writer.Write(hash.value());
+  writer.WriteColumn<char>(payload.data());
+}
+
+void WriteEntryRow(binary::Writer& writer, const CatalogEntry& entry)
+{
+  binary::Writer payload;
+  payload.Write(kEntryRow);
+  payload.Write(std::optional<std::string>(PathKey(entry.path)));
+  payload.Write(entry.size);
+  payload.Write(entry.mtime);
+  payload.Write(entry.content_hash);
+  payload.Write<uint64_t>(entry.track_count);
+  payload.Write<uint64_t>(entry.point_count);
+  payload.Write(entry.length2d);
+  payload.Write(entry.length3d);
+  payload.Write(entry.bounds);
+  payload.Write(entry.time_bounds);
+  payload.Write(entry.error);
+  WriteRow(writer, payload);
+}
+
+void WriteRemovedRow(binary::Writer& writer, const std::string& path_key)
+{
+  binary::Writer payload;
+  payload.Write(kRemovedRow);
+  payload.Write(std::optional<std::string>(path_key));
+  WriteRow(writer, payload);
+}
+
+// Reads the next row into `entries`, keyed by path.
+void ReadRow(binary::Reader& reader, std::unordered_map<std::string, CatalogEntry>& entries)
+{
+  const size_t size = reader.ReadCount(1);
+  const auto expected_hash = reader.Read<uint64_t>();
+  const auto bytes = reader.ReadColumn<char>(size);
+  const std::string_view data(bytes.data(), bytes.size());
+  binary::Fnv1a hash;
+  hash.Add(data);
+  if (hash.value() != expected_hash)
+  {
+    throw parse_error("Invalid catalog index: row checksum mismatch");
+  }
+
+  binary::Reader row(data);
+  const auto kind = row.Read<uint64_t>();
+  auto key = row.ReadString().value_or("");
+  if (kind == kRemovedRow)
+  {
+    entries.erase(key);
+    return;
+  }
+  if (kind != kEntryRow)
+  {
+    throw parse_error(std::format("Invalid catalog index: unknown row kind {}", kind));
+  }
+
+  CatalogEntry entry;
+  entry.path = PathFromKey(key);
+  entry.size = row.Read<uint64_t>();
+  entry.mtime = row.Read<int64_t>();
+  entry.content_hash = row.Read<uint64_t>();
+  entry.track_count = static_cast<size_t>(row.Read<uint64_t>());
+  entry.point_count = static_cast<size_t>(row.Read<uint64_t>());
+  entry.length2d = row.Read<double>();
+  entry.length3d = row.Read<double>();
+  entry.bounds = row.ReadBounds();
+  entry.time_bounds = row.ReadTimeBounds();
+  entry.error = row.ReadString();
+  entries.insert_or_assign(std::move(key), std::move(entry));
+}
+
+// Hashes and summarizes the file at `path`, keeping the metrics of `previous`
+// if the content didn't change.
+CatalogEntry ScanFile(const std::filesystem::path& path, const uint64_t size, const int64_t mtime,
+                      const CatalogEntry* previous)
+{
+  CatalogEntry entry;
+  entry.path = path;
+  entry.size = size;
+  entry.mtime = mtime;
+  try
+  {
+    const MappedFile file(path);
+    binary::Fnv1a hash;
+    hash.Add(file.data());
+    entry.content_hash = hash.value();
+    if (previous != nullptr && previous->content_hash == entry.content_hash &&
+        previous->size == file.size())
+    {
+      // Touched rather than modified.
+      entry = *previous;
+      entry.mtime = mtime;
+      return entry;
+    }
+
+    GpxSummary summary;
+    try
+    {
+      summary = SummarizeGpxData(file.data(), kCatalogParseOptions);
+    }
+    catch (const parse_error&)
+    {
+      // Falls back to loading the whole document, like `SummarizeGpx`, for
+      // what the stream reader doesn't support.
+      summary = SummarizeGpx(path, kCatalogParseOptions);
+    }
+    entry.track_count = summary.tracks.size();
+    for (const auto& track : summary.tracks)
+    {
+      for (const auto& segment : track.segments)
+      {
+        entry.point_count += segment.point_count;
+      }
+    }
+    entry.length2d = summary.length2d;
+    entry.length3d = summary.length3d;
+    entry.bounds = summary.bounds;
+    entry.time_bounds = summary.time_bounds;
+  }
+  catch (const std::exception& error)
+  {
+    const auto content_hash = entry.content_hash;
+    entry = CatalogEntry{.path = path, .size = size, .mtime = mtime};
+    entry.content_hash = content_hash;
+    entry.error = error.what();
+  }
+  return entry;
+}
+
+bool Overlaps(const Bounds& a, const Bounds& b)
+{
+  if (!a.min || !a.max || !b.min || !b.max)
+  {
+    return false;
+  }
+  return a.min->latitude <= b.max->latitude && b.min->latitude <= a.max->latitude &&
+         a.min->longitude <= b.max->longitude && b.min->longitude <= a.max->longitude;
+}
+
+} // namespace
+
+bool CatalogQuery::Matches(const CatalogEntry& entry) const
+{
+  const bool has_time = start_time.has_value() || end_time.has_value();
+  if (!bounds.has_value() && !has_time)
+  {
+    return true;
+  }
+  if (entry.error.has_value())
+  {
+    return false;
+  }
+  if (bounds.has_value() && !Overlaps(*bounds, entry.bounds))
+  {
+    return false;
+  }
+  if (has_time)
+  {
+    const auto& times = entry.time_bounds;
+    if (!times.start_time || !times.end_time)
+    {
+      return false;
+    }
+    if (end_time.has_value() && *times.start_time >= *end_time)
+    {
+      return false;
+    }
+    if (start_time.has_value() && *times.end_time < *start_time)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+Catalog::Catalog(std::filesystem::path index_path) : index_path_(std::move(index_path))
+{
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(index_path_, error))
+  {
+    return;
+  }
+
+  std::unordered_map<std::string, CatalogEntry> entries;
+  try
+  {
+    const MappedFile file(index_path_);
+    binary::Reader reader(file.data());
+    const auto magic = reader.ReadColumn<char>(kCatalogMagic.size());
+    if (std::string_view(magic.data(), magic.size()) != kCatalogMagic ||
+        reader.Read<uint32_t>() != kCatalogVersion ||
+        reader.Read<uint32_t>() != binary::kByteOrderMark)
+    {
+      // Rewritten by the next update.
+      return;
+    }
+    valid_size_ = reader.pos();
+    while (!reader.AtEnd())
+    {
+      ReadRow(reader, entries);
+      valid_size_ = reader.pos();
+      rows_++;
+    }
+  }
+  catch (const std::exception&)
+  {
+    // Keeps the rows before a row cut short, such as by a crash while
+    // appending. The next update overwrites the rest.
+  }
+
+  entries_.reserve(entries.size());
+  for (auto& [key, entry] : entries)
+  {
+    entries_.push_back(std::move(entry));
+  }
+  std::ranges::sort(entries_, {}, &CatalogEntry::path);
+}
+
+CatalogUpdate Catalog::Update(const std::filesystem::path& root, std::string_view pattern,
+                              bool recursive, size_t threads)
+{
+  const auto root_path = NormalizePath(root);
+  const auto files = find_files(root_path, pattern, recursive);
+
+  struct Candidate
+  {
+    std::filesystem::path path;
+    uint64_t size;
+    int64_t mtime;
+    const CatalogEntry* previous;
+  };
+  CatalogUpdate update;
+  std::vector<Candidate> candidates;
+  std::unordered_set<std::string> found;
+  found.reserve(files.size());
+  for (const auto& file : files)
+  {
+    auto path = NormalizePath(file);
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    const auto mtime = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+      // Removed since it was listed.
+      continue;
+    }
+    found.insert(PathKey(path));
+
+    const auto ticks = static_cast<int64_t>(mtime.time_since_epoch().count());
+    const CatalogEntry* previous = Find(path);
+    if (previous != nullptr && previous->size == size && previous->mtime == ticks)
+    {
+      update.unchanged++;
+      continue;
+    }
+    candidates.push_back({std::move(path), static_cast<uint64_t>(size), ticks, previous});
+  }
+
+  // Largest first, as in `LoadGpxFiles`, such that a large file doesn't end up
+  // as the tail of the scan.
+  std::ranges::stable_sort(candidates, [](const Candidate& a, const Candidate& b) {
+    return a.size > b.size;
+  });
+  std::vector<CatalogEntry> changed(candidates.size());
+  ParallelFor(candidates.size(), threads, [&](const size_t index) {
+    const auto& candidate = candidates[index];
+    changed[index] = ScanFile(candidate.path, candidate.size, candidate.mtime, candidate.previous);
+  });
+  for (const auto& candidate : candidates)
+  {
+    if (candidate.previous == nullptr)
+    {
+      update.added++;
+    }
+    else
+    {
+      update.updated++;
+    }
+  }
+
+  std::vector<std::string> removed;
+  for (const auto& entry : entries_)
+  {
+    auto key = PathKey(entry.path);
+    if (InScanScope(entry.path, root_path, pattern, recursive) && !found.contains(key))
+    {
+      removed.push_back(std::move(key));
+    }
+  }
+  update.removed = removed.size();
+
+  if (changed.empty() && removed.empty())
+  {
+    return update;
+  }
+
+  // The candidates point into the entries, so they are only modified now.
+  std::unordered_map<std::string, CatalogEntry> merged;
+  merged.reserve(entries_.size() + changed.size());
+  for (auto& entry : entries_)
+  {
+    merged.emplace(PathKey(entry.path), std::move(entry));
+  }
+  for (const auto& key : removed)
+  {
+    merged.erase(key);
+  }
+  for (const auto& entry : changed)
+  {
+    merged.insert_or_assign(PathKey(entry.path), entry);
+  }
+  entries_.clear();
+  for (auto& [key, entry] : merged)
+  {
+    entries_.push_back(std::move(entry));
+  }
+  std::ranges::sort(entries_, {}, &CatalogEntry::path);
+
+  Append(changed, removed);
+  return update;
+}
+
+const CatalogEntry* Catalog::Find(const std::filesystem::path& path) const
+{
+  const auto normalized = NormalizePath(path);
+  const auto it = std::ranges::lower_bound(entries_, normalized, {}, &CatalogEntry::path);
+  if (it == entries_.end() || it->path != normalized)
+  {
+    return nullptr;
+  }
+  return &*it;
+}
+
+std::vector<CatalogEntry> Catalog::Query(const CatalogQuery& query) const
+{
+  std::vector<CatalogEntry> result;
+  for (const auto& entry : entries_)
+  {
+    if (query.Matches(entry))
+    {
+      result.push_back(entry);
+    }
+  }
+  return result;
+}
+
+double Catalog::TotalLength2D(const CatalogQuery& query) const
+{
+  double total = 0.0;
+  for (const auto& entry : entries_)
+  {
+    if (query.Matches(entry))
+    {
+      total += entry.length2d;
+    }
+  }
+  return total;
+}
+
+void Catalog::Compact()
+{
+  binary::Writer writer;
+  WriteHeader(writer);
+  for (const auto& entry : entries_)
+  {
+    WriteEntryRow(writer, entry);
+  }
+
+  std::error_code error;
+  if (index_path_.has_parent_path())
+  {
+    std::filesystem::create_directories(index_path_.parent_path(), error);
+  }
+  auto temp_path = index_path_;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+    file.close();
+    if (!file)
+    {
+      std::filesystem::remove(temp_path, error);
+      throw std::runtime_error(
+          std::format("Unable to write catalog index: {}", index_path_.string()));
+    }
+  }
+  std::filesystem::rename(temp_path, index_path_, error);
+  if (error)
+  {
+    std::filesystem::remove(temp_path, error);
+    throw std::runtime_error(
+        std::format("Unable to write catalog index: {}", index_path_.string()));
+  }
+  rows_ = entries_.size();
+  valid_size_ = writer.data().size();
+}
+
+void Catalog::Append(std::span<const CatalogEntry> changed, std::span<const std::string> removed)
+{
+  // Rewrite rather than append once most rows would be stale, which bounds the
+  // index file to about twice the size of the current entries.
+  const size_t rows = rows_ + changed.size() + removed.size();
+  if (valid_size_ < kHeaderSize || rows > 2 * entries_.size() + 64)
+  {
+    Compact();
+    return;
+  }
+
+  binary::Writer writer;
+  for (const auto& entry : changed)
+  {
+    WriteEntryRow(writer, entry);
+  }
+  for (const auto& key : removed)
+  {
+    WriteRemovedRow(writer, key);
+  }
+
+  // Drops what follows the valid rows, such as a row cut short by a crash.
+  std::error_code error;
+  if (std::filesystem::file_size(index_path_, error) != valid_size_ || error)
+  {
+    std::filesystem::resize_file(index_path_, valid_size_, error);
+    if (error)
+    {
+      Compact();
+      return;
+    }
+  }
+  std::ofstream file(index_path_, std::ios::binary | std::ios::app);
+  file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+  file.close();
+  if (!file)
+  {
+    throw std::runtime_error(
+        std::format("Unable to write catalog index: {}", index_path_.string()));
+  }
+  rows_ = rows;
+  valid_size_ += writer.data().size();
+}
+
+} // namespace fastgpx
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+// Summary of one GPX file in a `Catalog`.
+struct CatalogEntry
+{
+  std::filesystem::path path;
+  uint64_t size = 0;
+  // Ticks of the last write time of the file.
+  int64_t mtime = 0;
+  // FNV-1a hash of the file content.
+  uint64_t content_hash = 0;
+  size_t track_count = 0;
+  size_t point_count = 0;
+  double length2d = 0.0; // Meters
+  double length3d = 0.0; // Meters
+  Bounds bounds = {};
+  TimeBounds time_bounds = {};
+  // Message of the `parse_error` if the file could not be parsed. The other
+  // metrics are empty then.
+  std::optional<std::string> error = std::nullopt;
+};
+
+// Selects the entries of a `Catalog`. Empty fields match every entry.
+struct CatalogQuery
+{
+  // Entries whose bounds overlap these latitudes and longitudes.
+  std::optional<Bounds> bounds = std::nullopt;
+  // Entries whose time bounds overlap `[start_time, end_time)`. Entries
+  // without times are excluded when either is set.
+  std::optional<std::chrono::system_clock::time_point> start_time = std::nullopt;
+  std::optional<std::chrono::system_clock::time_point> end_time = std::nullopt;
+
+  bool Matches(const CatalogEntry& entry) const;
+};
+
+// Counts of the entries changed by `Catalog::Update`.
+struct CatalogUpdate
+{
+  size_t added = 0;
+  size_t updated = 0;
+  size_t removed = 0;
+  size_t unchanged = 0;
+};
+
+/**
+ * @brief Persistent index of per-file summaries of a corpus of GPX files.
+ *
+ * The entries are kept in an index file which updates append to, such that a
+ * run over a large corpus only writes the rows of the files that changed.
+ * Later rows for a path replace earlier ones. The file is rewritten once most
+ * of its rows are stale. A row cut short by a crash is dropped on open.
+ *
+ * Files are parsed with the default `ParseOptions`, without metadata. The
+ * points are summarized while streaming and never kept in memory.
+ *
+ * Not thread-safe; use one `Catalog` per index file.
+ */
+class Catalog
+{
+public:
+  /**
+   * @brief Opens the index file, or starts an empty catalog if it doesn't
+   *   exist yet or cannot be read.
+   *
+   * @param index_path Created by the first `Update`, with its parent
+   *   directories.
+   */
+  explicit Catalog(std::filesystem::path index_path);
+
+  /**
+   * @brief Scans a directory tree and brings the entries of its files up to date.
+   *
+   * Files whose size and modification time match their entry are skipped
+   * without reading them. Other files are hashed, and only parsed again if the
+   * content changed. Entries of files in the scanned tree that no longer exist
+   * are removed. Files that fail to parse get an entry with the `error`, and
+   * are retried once they change.
+   *
+   * @throws std::filesystem::filesystem_error if the directory cannot be read.
+   * @throws std::runtime_error if the index file cannot be written.
+   * @param root
+   * @param pattern Glob pattern matched against file names.
+   * @param recursive Include files in subdirectories.
+   * @param threads Number of worker threads, or 0 for one per hardware thread.
+   */
+  CatalogUpdate Update(const std::filesystem::path& root, std::string_view pattern = "*.gpx",
+                       bool recursive = true, size_t threads = 0);
+
+  // Entries sorted by path.
+  std::span<const CatalogEntry> entries() const noexcept { return entries_; }
+  const std::filesystem::path& index_path() const noexcept { return index_path_; }
+
+  // Entry of the file at `path`, or nullptr.
+  const CatalogEntry* Find(const std::filesystem::path& path) const;
+
+  // Entries matching `query`, sorted by path. Files that failed to parse are
+  // only returned by an empty query.
+  std::vector<CatalogEntry> Query(const CatalogQuery& query = {}) const;
+
+  // Sum of the 2D lengths of the entries matching `query`, in meters.
+  double TotalLength2D(const CatalogQuery& query = {}) const;
+
+  /**
+   * @brief Rewrites the index file with only the current entries.
+   *
+   * @throws std::runtime_error if the index file cannot be written.
+   */
+  void Compact();
+
+private:
+  void Append(std::span<const CatalogEntry> changed, std::span<const std::string> removed);
+
+  std::filesystem::path index_path_;
+  std::vector<CatalogEntry> entries_;
+  // Rows in the index file, including stale ones.
+  size_t rows_ = 0;
+  // Size of the valid prefix of the index file.
+  uint64_t valid_size_ = 0;
+};
+
+} // namespace fastgpx
@@ -0,0 +1,284 @@
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "fastgpx/catalog.hpp"
+#include "fastgpx/fastgpx.hpp"
+
+using Catch::Generators::as;
+using Catch::Matchers::WithinAbs;
+
+using namespace fastgpx;
+
+// Sufficient tolerance for comparing meters.
+constexpr double kMETERS_TOL = 1e-4;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+namespace {
+
+const auto gpx_dir = project_path / "gpx/2024 TopCamp";
+const auto gpx_name1 = "Connected_20240518_094959_.gpx";
+const auto gpx_name2 = "Connected_20240527_102505_Gol.gpx";
+
+// Directory with a corpus of two GPX files, a broken one and an index file.
+class TestCorpus
+{
+public:
+  explicit TestCorpus(const std::string& name)
+      : root_(std::filesystem::temp_directory_path() / name)
+  {
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(files() / "sub");
+    std::filesystem::copy_file(gpx_dir / gpx_name1, files() / gpx_name1);
+    std::filesystem::copy_file(gpx_dir / gpx_name2, files() / "sub" / gpx_name2);
+    WriteFile(files() / "broken.gpx", "<gpx><trk><trkseg>");
+  }
+  ~TestCorpus() { std::filesystem::remove_all(root_); }
+
+  std::filesystem::path files() const { return root_ / "files"; }
+  std::filesystem::path index() const { return root_ / "index" / "catalog.idx"; }
+
+  static void WriteFile(const std::filesystem::path& path, const std::string& data)
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << data;
+  }
+
+private:
+  std::filesystem::path root_;
+};
+
+void CheckEntry(const CatalogEntry& entry, const std::filesystem::path& gpx_path)
+{
+  const Gpx gpx = LoadGpx(gpx_path);
+  CHECK_FALSE(entry.error.has_value());
+  CHECK(entry.size == std::filesystem::file_size(gpx_path));
+  CHECK(entry.track_count == gpx.tracks.size());
+  size_t point_count = 0;
+  for (const auto& track : gpx.tracks)
+  {
+    for (const auto& segment : track.segments)
+    {
+      point_count += segment.columns.size();
+    }
+  }
+  CHECK(entry.point_count == point_count);
+  CHECK_THAT(entry.length2d, WithinAbs(gpx.GetLength2D(), kMETERS_TOL));
+  CHECK_THAT(entry.length3d, WithinAbs(gpx.GetLength3D(), kMETERS_TOL));
+  CHECK(entry.bounds == gpx.GetBounds());
+  CHECK(entry.time_bounds == gpx.GetTimeBounds());
+}
+
+std::chrono::system_clock::time_point Year(const int year)
+{
+  return std::chrono::sys_days(std::chrono::year(year) / std::chrono::January / 1);
+}
+
+} // namespace
+
+TEST_CASE("Catalog summarizes the files in a directory tree", "[catalog]")
+{
+  const TestCorpus corpus("fastgpx_catalog_test_scan");
+  const size_t threads = GENERATE(as<size_t>{}, 1, 0);
+  CAPTURE(threads);
+
+  Catalog catalog(corpus.index());
+  CHECK(catalog.entries().empty());
+
+  const auto update = catalog.Update(corpus.files(), "*.gpx", true, threads);
+  CHECK(update.added == 3);
+  CHECK(update.updated == 0);
+  CHECK(update.removed == 0);
+  CHECK(update.unchanged == 0);
+  REQUIRE(catalog.entries().size() == 3);
+  CHECK(std::filesystem::exists(corpus.index()));
+
+  const auto* entry1 = catalog.Find(corpus.files() / gpx_name1);
+  REQUIRE(entry1 != nullptr);
+  CheckEntry(*entry1, gpx_dir / gpx_name1);
+  const auto* entry2 = catalog.Find(corpus.files() / "sub" / gpx_name2);
+  REQUIRE(entry2 != nullptr);
+  CheckEntry(*entry2, gpx_dir / gpx_name2);
+
+  const auto* broken = catalog.Find(corpus.files() / "broken.gpx");
+  REQUIRE(broken != nullptr);
+  CHECK(broken->error.has_value());
+  CHECK(broken->track_count == 0);
+  CHECK(catalog.Find(corpus.files() / "missing.gpx") == nullptr);
+}
+
+TEST_CASE("Catalog is reopened from its index file", "[catalog]")
+{
+  const TestCorpus corpus("fastgpx_catalog_test_reopen");
+  {
+    Catalog catalog(corpus.index());
+    catalog.Update(corpus.files());
+  }
+
+  Catalog catalog(corpus.index());
+  REQUIRE(catalog.entries().size() == 3);
+  const auto* entry = catalog.Find(corpus.files() / gpx_name1);
+  REQUIRE(entry != nullptr);
+  CheckEntry(*entry, gpx_dir / gpx_name1);
+  CHECK(catalog.Find(corpus.files() / "broken.gpx")->error.has_value());
+
+  // Nothing changed, so no file is read again.
+  const auto index_size = std::filesystem::file_size(corpus.index());
+  const auto update = catalog.Update(corpus.files());
+  CHECK(update.unchanged == 3);
+  CHECK(update.added + update.updated + update.removed == 0);
+  CHECK(std::filesystem::file_size(corpus.index()) == index_size);
+}
+
+TEST_CASE("Catalog updates changed and removed files", "[catalog]")
+{
+  const TestCorpus corpus("fastgpx_catalog_test_changes");
+  {
+    Catalog catalog(corpus.index());
+    catalog.Update(corpus.files());
+  }
+
+  // Touched without changing the content.
+  const auto path1 = corpus.files() / gpx_name1;
+  std::filesystem::last_write_time(path1, std::filesystem::last_write_time(path1) +
+                                              std::chrono::seconds(10));
+  // Fixed.
+  std::filesystem::copy_file(gpx_dir / gpx_name2, corpus.files() / "broken.gpx",
+                             std::filesystem::copy_options::overwrite_existing);
+  // Removed.
+  std::filesystem::remove(corpus.files() / "sub" / gpx_name2);
+
+  {
+    Catalog catalog(corpus.index());
+    const auto update = catalog.Update(corpus.files());
+    CHECK(update.added == 0);
+    CHECK(update.updated == 2);
+    CHECK(update.removed == 1);
+    CHECK(update.unchanged == 0);
+  }
+
+  Catalog catalog(corpus.index());
+  REQUIRE(catalog.entries().size() == 2);
+  const auto* entry1 = catalog.Find(path1);
+  REQUIRE(entry1 != nullptr);
+  CheckEntry(*entry1, path1);
+  CHECK(entry1->mtime == std::filesystem::last_write_time(path1).time_since_epoch().count());
+  const auto* fixed = catalog.Find(corpus.files() / "broken.gpx");
+  REQUIRE(fixed != nullptr);
+  CheckEntry(*fixed, gpx_dir / gpx_name2);
+  CHECK(catalog.Find(corpus.files() / "sub" / gpx_name2) == nullptr);
+}
+
+TEST_CASE("Catalog only removes entries within the scanned tree", "[catalog]")
+{
+  const TestCorpus corpus("fastgpx_catalog_test_scope");
+  Catalog catalog(corpus.index());
+  catalog.Update(corpus.files());
+
+  // The file in the subdirectory is outside of a non-recursive scan.
+  auto update = catalog.Update(corpus.files(), "*.gpx", false);
+  CHECK(update.unchanged == 2);
+  CHECK(update.removed == 0);
+
+  update = catalog.Update(corpus.files() / "sub", "*.gpx", true);
+  CHECK(update.unchanged == 1);
+  CHECK(update.removed == 0);
+  CHECK(catalog.entries().size() == 3);
+}
+
+TEST_CASE("Catalog drops a row cut short in its index file", "[catalog]")
+{
+  const TestCorpus corpus("fastgpx_catalog_test_truncated");
+  {
+    Catalog catalog(corpus.index());
+    catalog.Update(corpus.files());
+  }
+  std::filesystem::resize_file(corpus.index(), std::filesystem::file_size(corpus.index()) - 8);
+
+  Catalog catalog(corpus.index());
+  CHECK(catalog.entries().size() == 2);
+  const auto update = catalog.Update(corpus.files());
+  CHECK(update.added == 1);
+  CHECK(update.unchanged == 2);
+
+  const Catalog reopened(corpus.index());
+  CHECK(reopened.entries().size() == 3);
+}
+
+TEST_CASE("Catalog ignores an index file it cannot read", "[catalog]")
+{
+  const TestCorpus corpus("fastgpx_catalog_test_invalid");
+  std::filesystem::create_directories(corpus.index().parent_path());
+  TestCorpus::WriteFile(corpus.index(), "not a catalog index");
+
+  Catalog catalog(corpus.index());
+  CHECK(catalog.entries().empty());
+  CHECK(catalog.Update(corpus.files()).added == 3);
+  CHECK(Catalog(corpus.index()).entries().size() == 3);
+}
+
+TEST_CASE("Catalog compacts its index file", "[catalog]")
+{
+  const TestCorpus corpus("fastgpx_catalog_test_compact");
+  Catalog catalog(corpus.index());
+  catalog.Update(corpus.files());
+  const auto index_size = std::filesystem::file_size(corpus.index());
+
+  const auto broken = corpus.files() / "broken.gpx";
+  for (int i = 0; i < 100; ++i)
+  {
+    TestCorpus::WriteFile(broken, std::format("<gpx><trk>{}", i));
+    std::filesystem::last_write_time(broken, std::filesystem::last_write_time(broken) +
+                                                 std::chrono::seconds(i + 1));
+    CHECK(catalog.Update(corpus.files()).updated == 1);
+  }
+  // Bounded by the rewrites rather than growing with each update.
+  CHECK(std::filesystem::file_size(corpus.index()) < 40 * index_size);
+
+  catalog.Compact();
+  CHECK(std::filesystem::file_size(corpus.index()) < 2 * index_size);
+  CHECK(Catalog(corpus.index()).entries().size() == 3);
+}
+
+TEST_CASE("Catalog queries by time and area", "[catalog]")
+{
+  const TestCorpus corpus("fastgpx_catalog_test_query");
+  Catalog catalog(corpus.index());
+  catalog.Update(corpus.files());
+
+  const double total = catalog.TotalLength2D();
+  CHECK(catalog.Query().size() == 3);
+
+  const CatalogQuery in_2024{.start_time = Year(2024), .end_time = Year(2025)};
+  CHECK(catalog.Query(in_2024).size() == 2);
+  CHECK_THAT(catalog.TotalLength2D(in_2024), WithinAbs(total, kMETERS_TOL));
+
+  const CatalogQuery in_2023{.start_time = Year(2023), .end_time = Year(2024)};
+  CHECK(catalog.Query(in_2023).empty());
+  CHECK(catalog.TotalLength2D(in_2023) == 0.0);
+
+  // Only the second file was recorded after May 26th.
+  const CatalogQuery after{.start_time = std::chrono::sys_days(std::chrono::year(2024) /
+                                                               std::chrono::May / 26)};
+  const auto later = catalog.Query(after);
+  REQUIRE(later.size() == 1);
+  CHECK(later[0].path.filename() == gpx_name2);
+
+  const auto* entry1 = catalog.Find(corpus.files() / gpx_name1);
+  REQUIRE(entry1 != nullptr);
+  const CatalogQuery area{.bounds = entry1->bounds};
+  const auto overlapping = catalog.Query(area);
+  REQUIRE_FALSE(overlapping.empty());
+  CHECK(overlapping[0].path.filename() == gpx_name1);
+
+  const CatalogQuery elsewhere{
+      .bounds = Bounds{.min = LatLong{-10.0, -10.0}, .max = LatLong{-5.0, -5.0}}};
+  CHECK(catalog.Query(elsewhere).empty());
+}
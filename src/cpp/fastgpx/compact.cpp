@@ -0,0 +1,98 @@
+#include "fastgpx/compact.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+int32_t ToFixedPoint(const double value, const double scale) noexcept
+{
+  constexpr double kMin = std::numeric_limits<int32_t>::min();
+  constexpr double kMax = std::numeric_limits<int32_t>::max();
+  const double scaled = std::round(value * scale);
+  if (std::isnan(scaled))
+  {
+    return 0;
+  }
+  return static_cast<int32_t>(std::clamp(scaled, kMin, kMax));
+}
+
+} // namespace
+
+std::optional<std::chrono::system_clock::time_point> CompactLatLong::time() const
+{
+  if (!has_time())
+  {
+    return std::nullopt;
+  }
+  return std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::milliseconds(time_ms)));
+}
+
+CompactLatLong CompactLatLong::FromLatLong(
+    const LatLong& point, const std::optional<std::chrono::system_clock::time_point> time)
+{
+  CompactLatLong compact{
+      .latitude_e7 = ToFixedPoint(point.latitude, kUnitsPerDegree),
+      .longitude_e7 = ToFixedPoint(point.longitude, kUnitsPerDegree),
+      .elevation_mm = ToFixedPoint(point.elevation, kUnitsPerMeter),
+  };
+  if (time.has_value())
+  {
+    const auto since_epoch = time->time_since_epoch();
+    compact.time_ms = std::chrono::floor<std::chrono::milliseconds>(since_epoch).count();
+  }
+  return compact;
+}
+
+LatLong CompactLatLong::ToLatLong() const
+{
+  return LatLong{latitude(), longitude(), elevation()};
+}
+
+std::vector<CompactLatLong> ToCompact(std::span<const LatLong> points)
+{
+  std::vector<CompactLatLong> compact;
+  compact.reserve(points.size());
+  for (const auto& point : points)
+  {
+    compact.push_back(CompactLatLong::FromLatLong(point));
+  }
+  return compact;
+}
+
+std::vector<CompactLatLong> ToCompact(const PointColumns& columns)
+{
+  std::vector<CompactLatLong> compact;
+  compact.reserve(columns.size());
+  for (size_t i = 0; i < columns.size(); ++i)
+  {
+    compact.push_back(CompactLatLong::FromLatLong(columns[i], columns.time[i]));
+  }
+  return compact;
+}
+
+PointColumns FromCompact(std::span<const CompactLatLong> points)
+{
+  PointColumns columns;
+  columns.reserve(points.size());
+  for (const auto& point : points)
+  {
+    columns.push_back(point.ToLatLong(), point.time());
+  }
+  return columns;
+}
+
+} // namespace fastgpx
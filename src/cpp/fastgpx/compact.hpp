@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace fastgpx {
+
+struct LatLong;
+struct PointColumns;
+
+/**
+ * @brief Fixed-point representation of `LatLong` for keeping large collections
+ *   of points in memory.
+ *
+ * Coordinates are stored with a resolution of 1e-7 degrees (about 1 cm), the
+ * elevation in millimeters and the time in milliseconds since the Unix epoch.
+ * That is 24 bytes per point including the time, which `PointColumns` keeps
+ * in a separate column.
+ *
+ * The geometry functions in `geom.hpp` and `polyline::encode` accept compact
+ * points directly.
+ */
+struct CompactLatLong
+{
+  static constexpr double kUnitsPerDegree = 1e7;
+  static constexpr double kUnitsPerMeter = 1e3;
+  // Value of `time_ms` for points without a time.
+  static constexpr int64_t kNoTime = std::numeric_limits<int64_t>::min();
+
+  int32_t latitude_e7 = 0;
+  int32_t longitude_e7 = 0;
+  int32_t elevation_mm = 0;
+  int64_t time_ms = kNoTime;
+
+  auto operator<=>(const CompactLatLong&) const = default;
+
+  double latitude() const noexcept { return latitude_e7 / kUnitsPerDegree; }
+  double longitude() const noexcept { return longitude_e7 / kUnitsPerDegree; }
+  double elevation() const noexcept { return elevation_mm / kUnitsPerMeter; }
+  bool has_time() const noexcept { return time_ms != kNoTime; }
+  std::optional<std::chrono::system_clock::time_point> time() const;
+
+  /**
+   * @brief Rounds a point to the nearest representable values.
+   *
+   * @param point
+   * @param time Truncated to milliseconds.
+   */
+  static CompactLatLong FromLatLong(const LatLong& point,
+                                    std::optional<std::chrono::system_clock::time_point> time = {});
+
+  LatLong ToLatLong() const;
+};
+
+std::vector<CompactLatLong> ToCompact(std::span<const LatLong> points);
+
+/**
+ * @brief Converts the points of a segment, including their times.
+ *
+ * @throws parse_error if a point has an invalid GPX time.
+ */
+std::vector<CompactLatLong> ToCompact(const PointColumns& columns);
+
+PointColumns FromCompact(std::span<const CompactLatLong> points);
+
+} // namespace fastgpx
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "fastgpx/compact.hpp"
+#include "fastgpx/fastgpx.hpp"
+#include "fastgpx/geom.hpp"
+#include "fastgpx/polyline.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+using namespace fastgpx;
+using namespace std::chrono_literals;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+TEST_CASE("Compact point layout", "[compact]")
+{
+  STATIC_REQUIRE(sizeof(CompactLatLong) == 24);
+}
+
+TEST_CASE("Convert point to and from compact form", "[compact]")
+{
+  const std::chrono::system_clock::time_point time =
+      std::chrono::sys_days{2024y / 5 / 18} + 9h + 49min + 59s + 250ms;
+  const LatLong point{59.3293514, -18.0686, 28.5};
+  const auto compact = CompactLatLong::FromLatLong(point, time);
+
+  CHECK(compact.latitude_e7 == 593293514);
+  CHECK(compact.longitude_e7 == -180686000);
+  CHECK(compact.elevation_mm == 28500);
+  CHECK(compact.latitude() == 59.3293514);
+  CHECK(compact.longitude() == -18.0686);
+  CHECK(compact.elevation() == 28.5);
+  REQUIRE(compact.has_time());
+  CHECK(compact.time() == time);
+  CHECK(compact.ToLatLong() == point);
+}
+
+TEST_CASE("Convert point without time to compact form", "[compact]")
+{
+  const LatLong point{1.00000004, 2.00000006, -0.0004};
+  const auto compact = CompactLatLong::FromLatLong(point);
+
+  CHECK(compact.latitude_e7 == 10000000);
+  CHECK(compact.longitude_e7 == 20000001);
+  CHECK(compact.elevation_mm == 0);
+  CHECK_FALSE(compact.has_time());
+  CHECK_FALSE(compact.time().has_value());
+}
+
+TEST_CASE("Convert segment columns to and from compact form", "[compact]")
+{
+  PointColumns columns;
+  columns.push_back({1.0, 2.0, 3.0}, "2024-05-18T09:49:59.500Z");
+  columns.push_back({4.0, 5.0, 6.0});
+  const auto compact = ToCompact(columns);
+
+  REQUIRE(compact.size() == 2);
+  const auto expected = std::chrono::sys_days{2024y / 5 / 18} + 9h + 49min + 59s + 500ms;
+  CHECK(compact[0].time() == expected);
+  CHECK_FALSE(compact[1].has_time());
+  CHECK(FromCompact(compact) == columns);
+}
+
+TEST_CASE("Compute distances of compact points", "[compact][distance]")
+{
+  // ~380km route
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  const auto gpx = LoadGpx(path);
+  const auto view = gpx.tracks.front().segments.front().points();
+  const std::vector<LatLong> points(view.begin(), view.end());
+  const auto compact = ToCompact(points);
+  REQUIRE(compact.size() == points.size());
+
+  double expected_length2d = 0.0;
+  double expected_length3d = 0.0;
+  double length2d = 0.0;
+  double length3d = 0.0;
+  double gpxpy_length2d = 0.0;
+  double expected_gpxpy_length2d = 0.0;
+  for (size_t i = 1; i < points.size(); ++i)
+  {
+    expected_length2d += distance2d(points[i - 1], points[i]);
+    expected_length3d += distance3d(points[i - 1], points[i]);
+    expected_gpxpy_length2d += v1::distance2d(points[i - 1], points[i]);
+    length2d += distance2d(compact[i - 1], compact[i]);
+    length3d += distance3d(compact[i - 1], compact[i]);
+    gpxpy_length2d += v1::distance2d(compact[i - 1], compact[i]);
+  }
+
+  // The GPX files have 7 decimals or less, so the compact form is lossless.
+  CHECK_THAT(length2d, WithinAbs(expected_length2d, 1e-4));
+  CHECK_THAT(length3d, WithinAbs(expected_length3d, 1e-4));
+  CHECK_THAT(gpxpy_length2d, WithinAbs(expected_gpxpy_length2d, 1e-4));
+  CHECK(FromCompact(compact).latitude.front() == points.front().latitude);
+}
+
+TEST_CASE("Encode compact points as polyline", "[compact][polyline]")
+{
+  const std::vector<LatLong> points{
+      {38.5, -120.2},
+      {40.7, -120.95},
+      {43.252, -126.453},
+      {-33.8688197, 151.2092955},
+      {0.0000025, -0.0000025},
+  };
+  const auto compact = ToCompact(points);
+
+  CHECK(polyline::encode(compact) == polyline::encode(points));
+  CHECK(polyline::encode(compact, polyline::Precision::Six) ==
+        polyline::encode(points, polyline::Precision::Six));
+  CHECK(polyline::encode(compact).starts_with("_p~iF~ps|U_ulLnnqC_mqNvxq`@"));
+}
@@ -3,40 +3,130 @@
 #include <pugixml.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <ctime>
 #include <filesystem>
 #include <format>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <numbers>
 #include <numeric>
 #include <print>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
 
+#include "fastgpx/arena.hpp"
+#include "fastgpx/archive.hpp"
+#include "fastgpx/cache.hpp"
 #include "fastgpx/datetime.hpp"
 #include "fastgpx/errors.hpp"
 #include "fastgpx/filesystem.hpp"
 #include "fastgpx/geom.hpp"
+#include "fastgpx/stream.hpp"
+#include "fastgpx/xml_scanner.hpp"
 
 namespace fastgpx {
 
-// TimePoint
+// TimeColumn
 
-std::chrono::system_clock::time_point TimePoint::value() const
+bool TimeColumn::operator==(const TimeColumn& other) const
 {
-  if (std::holds_alternative<std::string>(data_))
+  if (size() != other.size())
   {
-    const auto& time_string = std::get<std::string>(data_);
-    data_ = parse_gpx_time(time_string);
+    return false;
   }
-  assert(std::holds_alternative<std::chrono::system_clock::time_point>(data_));
-  return std::get<std::chrono::system_clock::time_point>(data_);
+  for (size_t i = 0; i < size(); ++i)
+  {
+    if ((*this)[i] != other[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TimeColumn::reserve(const size_t count)
+{
+  values_.reserve(count);
+  raw_ends_.reserve(count);
+}
+
+void TimeColumn::clear() noexcept
+{
+  values_.clear();
+  raw_ends_.clear();
+  raw_.clear();
+}
+
+void TimeColumn::push_back(const std::string_view raw_time)
+{
+  raw_.append(raw_time);
+  raw_ends_.push_back(raw_.size());
+  values_.push_back(raw_time.empty() ? kNoTime : kUnparsed);
+}
+
+void TimeColumn::push_back(const std::optional<time_point> time)
+{
+  raw_ends_.push_back(raw_.size());
+  values_.push_back(time.has_value() ? time->time_since_epoch().count() : kNoTime);
+}
+
+void TimeColumn::append(const TimeColumn& other, const size_t first, const size_t count)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  const size_t raw_begin = first == 0 ? 0 : other.raw_ends_[first - 1];
+  const size_t raw_end = other.raw_ends_[first + count - 1];
+  const size_t raw_size = raw_.size();
+
+  const auto begin = other.values_.begin() + static_cast<std::ptrdiff_t>(first);
+  values_.insert(values_.end(), begin, begin + static_cast<std::ptrdiff_t>(count));
+  raw_ends_.reserve(raw_ends_.size() + count);
+  for (size_t i = first; i < first + count; ++i)
+  {
+    raw_ends_.push_back(raw_size + (other.raw_ends_[i] - raw_begin));
+  }
+  raw_.append(other.raw_, raw_begin, raw_end - raw_begin);
+}
+
+void TimeColumn::append(std::span<const rep> ticks)
+{
+  values_.insert(values_.end(), ticks.begin(), ticks.end());
+  raw_ends_.resize(raw_ends_.size() + ticks.size(), raw_.size());
+}
+
+std::optional<TimeColumn::time_point> TimeColumn::operator[](const size_t index) const
+{
+  // Concurrent readers may parse the same time, and store the same ticks.
+  const std::atomic_ref<rep> ticks(values_[index]);
+  auto value = ticks.load(std::memory_order_relaxed);
+  if (value == kUnparsed)
+  {
+    const size_t begin = index == 0 ? 0 : raw_ends_[index - 1];
+    const auto raw_time = std::string_view(raw_).substr(begin, raw_ends_[index] - begin);
+    value = parse_gpx_time(raw_time).time_since_epoch().count();
+    ticks.store(value, std::memory_order_relaxed);
+  }
+  if (value == kNoTime)
+  {
+    return std::nullopt;
+  }
+  return time_point(time_point::duration(value));
 }
 
 // TimeBounds
@@ -124,6 +214,26 @@ void Bounds::Add(std::span<const LatLong> locations)
   }
 }
 
+void Bounds::Add(const PointColumns& columns)
+{
+  if (columns.empty())
+  {
+    return;
+  }
+  // Like adding the points one by one, the first point seeds the bounds.
+  if (!min.has_value())
+  {
+    min = columns[0];
+    max = min;
+  }
+  const auto [min_latitude, max_latitude] = std::ranges::minmax(columns.latitude);
+  const auto [min_longitude, max_longitude] = std::ranges::minmax(columns.longitude);
+  min->latitude = std::min(min->latitude, min_latitude);
+  min->longitude = std::min(min->longitude, min_longitude);
+  max->latitude = std::max(max->latitude, max_latitude);
+  max->longitude = std::max(max->longitude, max_longitude);
+}
+
 void Bounds::Add(const Bounds& bounds)
 {
   if (bounds.min.has_value())
@@ -143,118 +253,299 @@ Bounds Bounds::MaxBounds(const Bounds& bounds) const
   return computed_max;
 }
 
-// Segment
+// PointColumns
 
-const Bounds& Segment::GetBounds() const
+void PointColumns::reserve(const size_t count)
 {
-  if (!bounds.has_value())
+  latitude.reserve(count);
+  longitude.reserve(count);
+  elevation.reserve(count);
+  time.reserve(count);
+}
+
+void PointColumns::clear() noexcept
+{
+  latitude.clear();
+  longitude.clear();
+  elevation.clear();
+  time.clear();
+}
+
+void PointColumns::push_back(const LatLong& point, const std::string_view raw_time)
+{
+  latitude.push_back(point.latitude);
+  longitude.push_back(point.longitude);
+  elevation.push_back(point.elevation);
+  time.push_back(raw_time);
+}
+
+void PointColumns::push_back(const LatLong& point,
+                             const std::optional<TimeColumn::time_point> time_point)
+{
+  latitude.push_back(point.latitude);
+  longitude.push_back(point.longitude);
+  elevation.push_back(point.elevation);
+  time.push_back(time_point);
+}
+
+void PointColumns::append(const PointColumns& other, const size_t first, const size_t count)
+{
+  const auto append_column = [first, count](auto& column, const auto& other_column) {
+    const auto begin = other_column.begin() + static_cast<std::ptrdiff_t>(first);
+    column.insert(column.end(), begin, begin + static_cast<std::ptrdiff_t>(count));
+  };
+  append_column(latitude, other.latitude);
+  append_column(longitude, other.longitude);
+  append_column(elevation, other.elevation);
+  time.append(other.time, first, count);
+}
+
+LatLong PointColumns::operator[](const size_t index) const
+{
+  return LatLong{latitude[index], longitude[index], elevation[index]};
+}
+
+// TimeIndex
+
+TimeIndex::TimeIndex(const TimeColumn& times)
+{
+  ticks_.reserve(times.size());
+  points_.reserve(times.size());
+  for (size_t i = 0; i < times.size(); ++i)
+  {
+    if (const auto time = times[i])
+    {
+      ticks_.push_back(time->time_since_epoch().count());
+      points_.push_back(i);
+    }
+  }
+  // Recorded tracks are nearly always in order already.
+  if (std::ranges::is_sorted(ticks_))
+  {
+    return;
+  }
+  std::vector<size_t> order(ticks_.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::ranges::stable_sort(order, {}, [this](const size_t i) { return ticks_[i]; });
+  std::vector<rep> ticks(order.size());
+  std::vector<size_t> points(order.size());
+  for (size_t i = 0; i < order.size(); ++i)
   {
-    bounds = ComputeBounds();
+    ticks[i] = ticks_[order[i]];
+    points[i] = points_[order[i]];
   }
-  return bounds.value();
+  ticks_ = std::move(ticks);
+  points_ = std::move(points);
 }
 
-double Segment::GetLength2D() const
+size_t TimeIndex::LowerBound(const time_point time) const noexcept
 {
-  if (!length2D.has_value())
+  return static_cast<size_t>(
+      std::ranges::lower_bound(ticks_, time.time_since_epoch().count()) - ticks_.begin());
+}
+
+namespace {
+
+// Location at `tick`, given the position of its lower bound in `index`.
+std::optional<LatLong> LocationAt(const PointColumns& columns, const TimeIndex& index,
+                                  const size_t position, const TimeIndex::rep tick,
+                                  const Interpolation interpolation)
+{
+  const auto ticks = index.ticks();
+  if (position == ticks.size())
+  {
+    return std::nullopt;
+  }
+  const LatLong after = columns[index.points()[position]];
+  if (ticks[position] == tick)
   {
-    length2D = ComputeLength2D();
+    return after;
   }
-  return length2D.value();
+  if (position == 0)
+  {
+    return std::nullopt;
+  }
+  const LatLong before = columns[index.points()[position - 1]];
+  const double fraction = static_cast<double>(tick - ticks[position - 1]) /
+                          static_cast<double>(ticks[position] - ticks[position - 1]);
+  switch (interpolation)
+  {
+  case Interpolation::GreatCircle:
+    return interpolate_great_circle(before, after, fraction);
+  case Interpolation::Linear:
+    break;
+  }
+  return interpolate_linear(before, after, fraction);
+}
+
+} // namespace
+
+// Segment
+
+const Bounds& Segment::GetBounds() const
+{
+  return bounds.Get([this] { return ComputeBounds(); });
+}
+
+double Segment::GetLength2D() const
+{
+  return length2D.Get([this] { return ComputeLength2D(); });
 }
 
 double Segment::GetLength3D() const
 {
-  if (!length3D.has_value())
-  {
-    length3D = ComputeLength3D();
-  }
-  return length3D.value();
+  return length3D.Get([this] { return ComputeLength3D(); });
 }
 
 const TimeBounds& Segment::GetTimeBounds() const
 {
-  if (!time_bounds.has_value())
+  return time_bounds.Get([this] { return ComputeTimeBounds(); });
+}
+
+const TimeIndex& Segment::GetTimeIndex() const
+{
+  return *time_index.Get([this] { return std::make_shared<const TimeIndex>(columns.time); });
+}
+
+std::optional<LatLong> Segment::GetLocationAt(const std::chrono::system_clock::time_point time,
+                                              const Interpolation interpolation) const
+{
+  const auto& index = GetTimeIndex();
+  return LocationAt(columns, index, index.LowerBound(time), time.time_since_epoch().count(),
+                    interpolation);
+}
+
+std::vector<std::optional<LatLong>>
+Segment::GetLocationsAt(const std::span<const std::chrono::system_clock::time_point> times,
+                        const Interpolation interpolation) const
+{
+  if (!std::ranges::is_sorted(times))
+  {
+    throw std::invalid_argument("Times must be sorted");
+  }
+  const auto& index = GetTimeIndex();
+  const auto ticks = index.ticks();
+  std::vector<std::optional<LatLong>> locations;
+  locations.reserve(times.size());
+  // The lower bound only moves forward for sorted times.
+  size_t position = 0;
+  for (const auto time : times)
   {
-    time_bounds = ComputeTimeBounds();
+    const auto tick = time.time_since_epoch().count();
+    while (position < ticks.size() && ticks[position] < tick)
+    {
+      ++position;
+    }
+    locations.push_back(LocationAt(columns, index, position, tick, interpolation));
   }
-  return time_bounds.value();
+  return locations;
+}
+
+void Segment::ResetMetrics() noexcept
+{
+  bounds.Reset();
+  length2D.Reset();
+  length3D.Reset();
+  time_bounds.Reset();
+  time_index.Reset();
 }
 
 Bounds Segment::ComputeBounds() const
 {
   Bounds computed_bounds;
-  computed_bounds.Add(points);
+  computed_bounds.Add(columns);
   return computed_bounds;
 }
 
 double Segment::ComputeLength2D() const
 {
-  auto distances = std::views::zip(points, points | std::views::drop(1)) |
-                   std::views::transform([](const auto& pair) {
-                     return distance2d(std::get<0>(pair), std::get<1>(pair));
-                   });
-  return std::accumulate(distances.begin(), distances.end(), 0.0);
+  return length2d(columns.latitude, columns.longitude);
 }
 
 double Segment::ComputeLength3D() const
 {
-  auto distances = std::views::zip(points, points | std::views::drop(1)) |
-                   std::views::transform([](const auto& pair) {
-                     return distance3d(std::get<0>(pair), std::get<1>(pair));
-                   });
-  return std::accumulate(distances.begin(), distances.end(), 0.0);
+  return length3d(columns.latitude, columns.longitude, columns.elevation);
 }
 
 TimeBounds Segment::ComputeTimeBounds() const
 {
   TimeBounds computed_bounds;
-  for (const auto& point : points)
+  for (size_t i = 0; i < columns.time.size(); ++i)
   {
-    if (point.time.has_value())
+    if (const auto time = columns.time[i])
     {
-      computed_bounds.Add(point.time->value());
+      computed_bounds.Add(*time);
     }
   }
   return computed_bounds;
 }
 
+void Segment::UpdateMetrics(const size_t first)
+{
+  assert(first <= columns.size());
+  const size_t count = columns.size() - first;
+  if (count == 0)
+  {
+    return;
+  }
+  // The new points are not in the index, which is built again on next use.
+  time_index.Reset();
+
+  bounds.Update([&](Bounds& value) {
+    for (size_t i = first; i < columns.size(); ++i)
+    {
+      value.Add(columns[i]);
+    }
+  });
+
+  // The lengths continue from the last of the previous points.
+  const size_t from = first > 0 ? first - 1 : 0;
+  const auto latitude = std::span(columns.latitude).subspan(from);
+  const auto longitude = std::span(columns.longitude).subspan(from);
+  length2D.Update([&](double& value) { value += length2d(latitude, longitude); });
+  length3D.Update([&](double& value) {
+    value += length3d(latitude, longitude, std::span(columns.elevation).subspan(from));
+  });
+
+  time_bounds.Update([&](TimeBounds& value) {
+    for (size_t i = first; i < columns.time.size(); ++i)
+    {
+      if (const auto time = columns.time[i])
+      {
+        value.Add(*time);
+      }
+    }
+  });
+}
+
+void Segment::SetMetrics(const Metrics& metrics)
+{
+  bounds.Set(metrics.bounds);
+  length2D.Set(metrics.length2d);
+  length3D.Set(metrics.length3d);
+  time_bounds.Set(metrics.time_bounds);
+}
+
 // Track
 
 const Bounds& Track::GetBounds() const
 {
-  if (!bounds.has_value())
-  {
-    bounds = ComputeBounds();
-  }
-  return bounds.value();
+  return bounds.Get([this] { return ComputeBounds(); });
 }
 
 double Track::GetLength2D() const
 {
-  if (!length2D.has_value())
-  {
-    length2D = ComputeLength2D();
-  }
-  return length2D.value();
+  return length2D.Get([this] { return ComputeLength2D(); });
 }
 
 double Track::GetLength3D() const
 {
-  if (!length3D.has_value())
-  {
-    length3D = ComputeLength3D();
-  }
-  return length3D.value();
+  return length3D.Get([this] { return ComputeLength3D(); });
 }
 
 const TimeBounds& Track::GetTimeBounds() const
 {
-  if (!time_bounds.has_value())
-  {
-    time_bounds = ComputeTimeBounds();
-  }
-  return time_bounds.value();
+  return time_bounds.Get([this] { return ComputeTimeBounds(); });
 }
 
 Bounds Track::ComputeBounds() const
@@ -291,42 +582,42 @@ TimeBounds Track::ComputeTimeBounds() const
   return computed_bounds;
 }
 
+void Track::ResetMetrics() noexcept
+{
+  bounds.Reset();
+  length2D.Reset();
+  length3D.Reset();
+  time_bounds.Reset();
+}
+
+void Track::SetMetrics(const Metrics& metrics)
+{
+  bounds.Set(metrics.bounds);
+  length2D.Set(metrics.length2d);
+  length3D.Set(metrics.length3d);
+  time_bounds.Set(metrics.time_bounds);
+}
+
 // Gpx
 
 const Bounds& Gpx::GetBounds() const
 {
-  if (!bounds.has_value())
-  {
-    bounds = ComputeBounds();
-  }
-  return bounds.value();
+  return bounds.Get([this] { return ComputeBounds(); });
 }
 
 double Gpx::GetLength2D() const
 {
-  if (!length2D.has_value())
-  {
-    length2D = ComputeLength2D();
-  }
-  return length2D.value();
+  return length2D.Get([this] { return ComputeLength2D(); });
 }
 
 double Gpx::GetLength3D() const
 {
-  if (!length3D.has_value())
-  {
-    length3D = ComputeLength3D();
-  }
-  return length3D.value();
+  return length3D.Get([this] { return ComputeLength3D(); });
 }
 
 const TimeBounds& Gpx::GetTimeBounds() const
 {
-  if (!time_bounds.has_value())
-  {
-    time_bounds = ComputeTimeBounds();
-  }
-  return time_bounds.value();
+  return time_bounds.Get([this] { return ComputeTimeBounds(); });
 }
 
 Bounds Gpx::ComputeBounds() const
@@ -361,15 +652,32 @@ TimeBounds Gpx::ComputeTimeBounds() const
   return computed_bounds;
 }
 
+void Gpx::ResetMetrics() noexcept
+{
+  bounds.Reset();
+  length2D.Reset();
+  length3D.Reset();
+  time_bounds.Reset();
+}
+
+void Gpx::SetMetrics(const Metrics& metrics)
+{
+  bounds.Set(metrics.bounds);
+  length2D.Set(metrics.length2d);
+  length3D.Set(metrics.length3d);
+  time_bounds.Set(metrics.time_bounds);
+}
+
 namespace {
 
-Gpx ReadGpxXml(const pugi::xml_node& doc)
+Gpx ReadGpxXml(const pugi::xml_node& doc, const ParseOptions& options,
+               std::pmr::memory_resource* resource)
 {
-  Gpx gpx;
+  Gpx gpx(resource);
 
   pugi::xml_node root = doc.child("gpx");
 
-  const auto metadata = root.child("metadata");
+  const auto metadata = options.metadata ? root.child("metadata") : pugi::xml_node();
   if (metadata)
   {
     const auto name = metadata.child("name");
@@ -380,53 +688,67 @@ Gpx ReadGpxXml(const pugi::xml_node& doc)
   }
 
   // Iterate over each <trk> element
-  for (pugi::xml_node track = root.child("trk"); track; track = track.next_sibling("trk"))
+  size_t track_index = 0;
+  for (pugi::xml_node track = root.child("trk"); track;
+       track = track.next_sibling("trk"), track_index++)
   {
-    gpx.tracks.push_back({});
-    auto& gpx_track = gpx.tracks.back();
+    if (options.track_index.has_value() && *options.track_index != track_index)
+    {
+      continue;
+    }
+
+    const auto track_name = track.child("name");
+    // Like the stream reader, only a <name> before the segments matches.
+    if (options.track_name.has_value() &&
+        (!track_name || track_name.previous_sibling("trkseg") ||
+         *options.track_name != track_name.text().as_string()))
+    {
+      continue;
+    }
+
+    auto& gpx_track = gpx.tracks.emplace_back(resource);
+    if (options.metadata && track_name)
+    {
+      gpx_track.name.emplace(track_name.text().as_string());
+    }
 
     // Iterate over each <trkseg> element
     for (pugi::xml_node segment = track.child("trkseg"); segment;
          segment = segment.next_sibling("trkseg"))
     {
-      gpx_track.segments.push_back({});
-      auto& gpx_segment = gpx_track.segments.back();
+      auto& gpx_segment = gpx_track.segments.emplace_back(resource);
 
       pugi::xml_node prev_trkpt;
       // Iterate over each <trkpt> in the segment
       for (pugi::xml_node trkpt = segment.child("trkpt"); trkpt;
            trkpt = trkpt.next_sibling("trkpt"))
       {
-        const double lat = trkpt.attribute("lat").as_double();
-        const double lon = trkpt.attribute("lon").as_double();
+        const double lat = ParseXmlDouble(trkpt.attribute("lat").value());
+        const double lon = ParseXmlDouble(trkpt.attribute("lon").value());
 
         // <ele>
         /*
         Elevation (in meters) of the point.
         */
         double elevation = 0.0;
-        const auto ele = trkpt.child("ele");
+        const auto ele = options.elevation ? trkpt.child("ele") : pugi::xml_node();
         if (ele)
         {
-          elevation = ele.text().as_double();
+          elevation = ParseXmlDouble(ele.text().get());
         }
 
-        auto& point = gpx_segment.points.emplace_back(lat, lon, elevation);
-
-        // TODO: Add parse options, selectively choose what to parse.
         // <time>
         /*
         Creation/modification timestamp for element. Date and time in are in Univeral Coordinated
         Time (UTC), not local time! Conforms to ISO 8601 specification for date/time representation.
         Fractional seconds are allowed for millisecond timing in tracklogs.
         */
-        const auto time = trkpt.child("time");
-        if (time)
-        {
-          // Read only the raw string, but don't parse it. This is done on demand
-          // when the value is read.
-          point.time = std::string(time.text().as_string());
-        }
+        const auto time = options.time ? trkpt.child("time") : pugi::xml_node();
+        // Read only the raw string, but don't parse it. This is done on demand
+        // when the value is read.
+        const std::string_view raw_time = time ? time.text().as_string() : "";
+
+        gpx_segment.columns.push_back({lat, lon, elevation}, raw_time);
       }
     }
   }
@@ -434,10 +756,181 @@ Gpx ReadGpxXml(const pugi::xml_node& doc)
   return gpx;
 }
 
-} // namespace
+// Parses in-memory data directly, without copying it and without building a DOM.
+// Returns std::nullopt for data the stream reader doesn't handle, leaving it to
+// pugixml to deal with other encodings and to produce the canonical error for
+// malformed documents. The points of large documents are parsed on `threads`
+// threads, see `ReadGpxStreamParallel`.
+std::optional<Gpx> TryReadGpxStream(std::string_view data, const ParseOptions& options,
+                                    std::pmr::memory_resource* resource, const size_t threads = 1)
+{
+  try
+  {
+    if (threads != 1)
+    {
+      return ReadGpxStreamParallel(data, options, threads, resource);
+    }
+    GpxStreamReader reader(data, options);
+    return ReadGpxStream(reader, resource);
+  }
+  catch (const parse_error&)
+  {
+    return std::nullopt;
+  }
+}
+
+// Like `TryReadGpxStream` above, reading the file in chunks.
+std::optional<Gpx> TryReadGpxStream(const std::filesystem::path& path,
+                                    const ParseOptions& options,
+                                    std::pmr::memory_resource* resource)
+{
+  try
+  {
+    GpxStreamReader reader(path, options);
+    return ReadGpxStream(reader, resource);
+  }
+  catch (const parse_error&)
+  {
+    return std::nullopt;
+  }
+}
 
-Gpx LoadGpx(const std::filesystem::path& path)
+// Parses GPX data as it is decompressed, without a temporary copy of the whole
+// document. Like `TryReadGpxStream`, data the stream reader doesn't handle is
+// left to pugixml, for which it is decompressed in full. The `source` is the
+// file named in errors, empty for in-memory data.
+Gpx ReadCompressedGpx(const std::function<std::unique_ptr<DecompressReader>()>& open,
+                      const ParseOptions& options, std::pmr::memory_resource* resource,
+                      std::string_view source)
 {
+  try
+  {
+    const auto decompress = open();
+    GpxStreamReader reader(
+        [&](char* buffer, size_t size) { return decompress->Read(buffer, size); }, options);
+    return ReadGpxStream(reader, resource);
+  }
+  catch (const parse_error&)
+  {
+    // Decompression errors are thrown again below.
+  }
+
+  std::string data;
+  open()->ReadAll(data);
+
+  pugi::xml_document doc;
+  pugi::xml_parse_result result = doc.load_buffer(data.data(), data.size());
+  if (!result)
+  {
+    const auto message =
+        source.empty()
+            ? std::format("Failed to parse GPX data: {}", result.description())
+            : std::format("Failed to load GPX file: {} - {}", result.description(), source);
+    throw parse_error(message);
+  }
+
+  return ReadGpxXml(doc, options, resource);
+}
+
+// Opens the GPX data of a gzip file, or of a ZIP archive with a single GPX file.
+std::unique_ptr<DecompressReader> OpenCompressedGpx(std::string_view data,
+                                                    const Compression compression,
+                                                    std::string_view source)
+{
+  if (compression == Compression::Gzip)
+  {
+    return std::make_unique<GzipReader>(data);
+  }
+
+  const ZipArchive archive(data);
+  const ZipEntry* gpx_entry = nullptr;
+  size_t gpx_count = 0;
+  for (const auto& entry : archive.entries())
+  {
+    if (entry.IsGpx())
+    {
+      gpx_entry = &entry;
+      gpx_count++;
+    }
+  }
+  if (gpx_count != 1)
+  {
+    const auto message = std::format("Expected one GPX file in the archive, found {}", gpx_count);
+    throw parse_error(source.empty()
+                          ? std::format("Failed to parse GPX data: {}", message)
+                          : std::format("Failed to load GPX file: {} - {}", message, source));
+  }
+  return std::make_unique<ZipEntryReader>(data, *gpx_entry);
+}
+
+Gpx ParseCompressedGpx(std::string_view data, const Compression compression,
+                       const ParseOptions& options, std::pmr::memory_resource* resource,
+                       std::string_view source)
+{
+  return ReadCompressedGpx([&] { return OpenCompressedGpx(data, compression, source); },
+                           options, resource, source);
+}
+
+Gpx LoadGpxMapped(const std::filesystem::path& path, const ParseOptions& options,
+                  const size_t threads, std::pmr::memory_resource* resource)
+{
+  if (!std::filesystem::is_regular_file(path))
+  {
+    const auto message =
+        std::format("Failed to load GPX file: File was not found - {}", path.string());
+    throw parse_error(message);
+  }
+
+  // Fails like the other loads when the file cannot be read, such as for lack
+  // of permissions.
+  const MappedFile file = [&] {
+    try
+    {
+      return MappedFile(path);
+    }
+    catch (const std::runtime_error& error)
+    {
+      throw parse_error(std::format("Failed to load GPX file: {}", error.what()));
+    }
+  }();
+  if (const auto compression = DetectCompression(file.data()); compression != Compression::None)
+  {
+    return ParseCompressedGpx(file.data(), compression, options, resource, path.string());
+  }
+
+  if (auto gpx = TryReadGpxStream(file.data(), options, resource, threads))
+  {
+    return std::move(*gpx);
+  }
+
+  pugi::xml_document doc;
+  pugi::xml_parse_result result = doc.load_buffer(file.data().data(), file.size());
+  if (!result)
+  {
+    const auto message =
+        std::format("Failed to load GPX file: {} - {}", result.description(), path.string());
+    throw parse_error(message);
+  }
+
+  return ReadGpxXml(doc, options, resource);
+}
+
+Gpx LoadGpxFile(const std::filesystem::path& path, const LoadOptions& options,
+                std::pmr::memory_resource* resource)
+{
+  // Compressed files are always memory-mapped, and decompressed straight into
+  // the parser. Files parsed in parallel are mapped to split them in chunks.
+  if (options.memory_map || options.threads != 1 ||
+      DetectFileCompression(path) != Compression::None)
+  {
+    return LoadGpxMapped(path, options.parse, options.threads, resource);
+  }
+
+  if (auto gpx = TryReadGpxStream(path, options.parse, resource))
+  {
+    return std::move(*gpx);
+  }
+
   pugi::xml_document doc;
 
 #ifdef _WIN32
@@ -453,13 +946,105 @@ Gpx LoadGpx(const std::filesystem::path& path)
     throw parse_error(message);
   }
 
-  return ReadGpxXml(doc);
+  return ReadGpxXml(doc, options.parse, resource);
 }
 
-Gpx ParseGpx(const std::string& data)
+// Reads the cache file of the GPX file if it is up to date. Otherwise the GPX
+// file is loaded and the cache file written for the next load.
+Gpx LoadGpxCached(const std::filesystem::path& path, const LoadOptions& options,
+                  std::pmr::memory_resource* resource)
 {
+  const auto key = MakeGpxCacheKey(path, options.parse);
+  if (!key)
+  {
+    // Fails the same way as without a cache.
+    return LoadGpxFile(path, options, resource);
+  }
+
+  const auto cache_path = *options.cache_dir / key->FileName();
+  if (auto gpx = ReadGpxCache(cache_path, *key, resource))
+  {
+    return std::move(*gpx);
+  }
+
+  Gpx gpx = LoadGpxFile(path, options, resource);
+  // The document is still valid without a cache file, such as when the cache
+  // directory is read-only.
+  WriteGpxCache(gpx, *key, cache_path);
+  return gpx;
+}
+
+Gpx ParseGpxData(std::string_view data, const ParseOptions& options,
+                 std::pmr::memory_resource* resource)
+{
+  if (const auto compression = DetectCompression(data); compression != Compression::None)
+  {
+    return ParseCompressedGpx(data, compression, options, resource, {});
+  }
+
+  if (auto gpx = TryReadGpxStream(data, options, resource))
+  {
+    return std::move(*gpx);
+  }
+
+  pugi::xml_document doc;
+  pugi::xml_parse_result result = doc.load_buffer(data.data(), data.size());
+
+  if (!result)
+  {
+    const auto message = std::format("Failed to parse GPX data: {}", result.description());
+    throw parse_error(message);
+  }
+
+  return ReadGpxXml(doc, options, resource);
+}
+
+} // namespace
+
+Gpx LoadGpx(const std::filesystem::path& path, const LoadOptions& options)
+{
+  if (options.cache_dir.has_value())
+  {
+    return LoadGpxCached(path, options, std::pmr::get_default_resource());
+  }
+  return LoadGpxFile(path, options, std::pmr::get_default_resource());
+}
+
+Gpx LoadGpx(const std::filesystem::path& path, GpxArena& arena, const LoadOptions& options)
+{
+  if (options.cache_dir.has_value())
+  {
+    return LoadGpxCached(path, options, arena.resource());
+  }
+  return LoadGpxFile(path, options, arena.resource());
+}
+
+Gpx ParseGpx(std::string_view data, const ParseOptions& options)
+{
+  return ParseGpxData(data, options, std::pmr::get_default_resource());
+}
+
+Gpx ParseGpx(std::string_view data, GpxArena& arena, const ParseOptions& options)
+{
+  return ParseGpxData(data, options, arena.resource());
+}
+
+Gpx ParseGpxInPlace(std::span<char> buffer, const ParseOptions& options)
+{
+  const auto resource = std::pmr::get_default_resource();
+  const auto data = std::string_view(buffer.data(), buffer.size());
+  if (DetectCompression(data) != Compression::None)
+  {
+    return ParseGpxData(data, options, resource);
+  }
+  if (auto gpx = TryReadGpxStream(data, options, resource))
+  {
+    return std::move(*gpx);
+  }
+
+  // The document refers into the buffer, but ReadGpxXml copies what it needs.
   pugi::xml_document doc;
-  pugi::xml_parse_result result = doc.load_string(data.c_str());
+  pugi::xml_parse_result result = doc.load_buffer_inplace(buffer.data(), buffer.size());
 
   if (!result)
   {
@@ -467,7 +1052,127 @@ Gpx ParseGpx(const std::string& data)
     throw parse_error(message);
   }
 
-  return ReadGpxXml(doc);
+  return ReadGpxXml(doc, options, resource);
+}
+
+Gpx ParseGpxArchiveEntry(const ZipArchive& archive, const ZipEntry& entry,
+                         const ParseOptions& options)
+{
+  return ReadCompressedGpx(
+      [&] { return std::make_unique<ZipEntryReader>(archive.data(), entry); }, options,
+      std::pmr::get_default_resource(), entry.name);
+}
+
+// GpxParser
+
+struct GpxParser::State
+{
+  // Size of the reads when the file size is not known up front.
+  static constexpr size_t kReadChunkSize = 64 * 1024;
+
+  // The contents of the current file.
+  std::string buffer;
+  // The decompressed contents of the current file, if it is compressed.
+  std::string decompressed;
+  GpxStreamReader reader{std::string_view()};
+
+  void ReadFile(const std::filesystem::path& path)
+  {
+    const std::unique_ptr<FILE, decltype(&std::fclose)> file(open_file(path), &std::fclose);
+    if (!file)
+    {
+      const auto message =
+          std::format("Failed to load GPX file: File was not found - {}", path.string());
+      throw parse_error(message);
+    }
+
+    std::error_code error;
+    const auto file_size = std::filesystem::file_size(path, error);
+    const size_t size_hint = error ? 0 : static_cast<size_t>(file_size);
+
+    // Reuses the capacity of the buffer, without zero-filling it.
+    size_t size = 0;
+    bool eof = false;
+    buffer.clear();
+    while (!eof)
+    {
+      // One byte beyond the expected size to detect the end of the file.
+      const size_t capacity = std::max({buffer.capacity(), size_hint + 1, size + kReadChunkSize});
+      buffer.resize_and_overwrite(capacity, [&](char* data, const size_t count) {
+        const size_t read = std::fread(data + size, 1, count - size, file.get());
+        eof = read < count - size;
+        size += read;
+        return size;
+      });
+    }
+  }
+
+  Gpx Read(std::string_view data, const ParseOptions& options, std::pmr::memory_resource* resource,
+           const std::filesystem::path* path = nullptr)
+  {
+    // Compressed data is decompressed into a buffer that is kept as well, such
+    // that the warm reader can be used on it.
+    if (const auto compression = DetectCompression(data); compression != Compression::None)
+    {
+      decompressed.clear();
+      OpenCompressedGpx(data, compression, path ? path->string() : std::string())
+          ->ReadAll(decompressed);
+      data = decompressed;
+    }
+
+    try
+    {
+      reader.Reset(data, options);
+      return ReadGpxStream(reader, resource);
+    }
+    catch (const parse_error&)
+    {
+      // Fall back to pugixml, like `LoadGpx`.
+    }
+
+    pugi::xml_document doc;
+    const pugi::xml_parse_result result = doc.load_buffer(data.data(), data.size());
+    if (!result)
+    {
+      const auto message =
+          path ? std::format("Failed to load GPX file: {} - {}", result.description(),
+                             path->string())
+               : std::format("Failed to parse GPX data: {}", result.description());
+      throw parse_error(message);
+    }
+    return ReadGpxXml(doc, options, resource);
+  }
+};
+
+GpxParser::GpxParser() : state_(std::make_unique<State>()) {}
+
+GpxParser::GpxParser(GpxParser&&) noexcept = default;
+
+GpxParser& GpxParser::operator=(GpxParser&&) noexcept = default;
+
+GpxParser::~GpxParser() = default;
+
+Gpx GpxParser::Load(const std::filesystem::path& path, const ParseOptions& options)
+{
+  state_->ReadFile(path);
+  return state_->Read(state_->buffer, options, std::pmr::get_default_resource(), &path);
+}
+
+Gpx GpxParser::Load(const std::filesystem::path& path, GpxArena& arena,
+                    const ParseOptions& options)
+{
+  state_->ReadFile(path);
+  return state_->Read(state_->buffer, options, arena.resource(), &path);
+}
+
+Gpx GpxParser::Parse(std::string_view data, const ParseOptions& options)
+{
+  return state_->Read(data, options, std::pmr::get_default_resource());
+}
+
+Gpx GpxParser::Parse(std::string_view data, GpxArena& arena, const ParseOptions& options)
+{
+  return state_->Read(data, options, arena.resource());
 }
 
 } // namespace fastgpx
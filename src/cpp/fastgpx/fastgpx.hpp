@@ -2,28 +2,23 @@
 
 #include <chrono>
 #include <compare>
+#include <cstddef>
 #include <filesystem>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <ranges>
 #include <span>
 #include <string>
-#include <variant>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-namespace fastgpx {
-
-class TimePoint
-{
-public:
-  TimePoint(const std::string& time_string) : data_(time_string) {}
-  TimePoint(const std::chrono::system_clock::time_point time_point) : data_(time_point) {}
-
-  auto operator<=>(const TimePoint&) const = default;
+#include "fastgpx/lazy.hpp"
 
-  std::chrono::system_clock::time_point value() const;
-
-private:
-  mutable std::variant<std::string, std::chrono::system_clock::time_point> data_;
-};
+namespace fastgpx {
 
 struct TimeBounds
 {
@@ -39,17 +34,196 @@ struct TimeBounds
   void Add(const TimeBounds& time_bounds);
 };
 
-// Represent <trkpt> data in GPX files.
+// Represent the location of <trkpt> data in GPX files. The times are kept in
+// the `TimeColumn` of the segment.
 struct LatLong
 {
   double latitude = 0.0;
   double longitude = 0.0;
   double elevation = 0.0;
-  std::optional<TimePoint> time = std::nullopt;
 
   auto operator<=>(const LatLong&) const = default;
 };
 
+// The <trkpt> times of a segment. The raw <time> strings are kept in a single
+// buffer and only parsed when read.
+class TimeColumn
+{
+public:
+  using time_point = std::chrono::system_clock::time_point;
+  using rep = time_point::rep;
+
+  // Ticks of a point without a time.
+  static constexpr rep kNoTime = std::numeric_limits<rep>::min();
+
+  TimeColumn() = default;
+  explicit TimeColumn(std::pmr::memory_resource* resource)
+      : values_(resource), raw_ends_(resource), raw_(resource)
+  {
+  }
+
+  // Compares the parsed times.
+  bool operator==(const TimeColumn& other) const;
+
+  size_t size() const noexcept { return values_.size(); }
+  bool empty() const noexcept { return values_.empty(); }
+
+  void reserve(size_t count);
+  void clear() noexcept;
+
+  // Appends the raw <time> string of a point. Empty if the point has no time.
+  void push_back(std::string_view raw_time);
+  void push_back(std::optional<time_point> time);
+  // Appends the times `[first, first + count)` of `other`, parsed or not.
+  void append(const TimeColumn& other, size_t first, size_t count);
+  // Appends parsed times, as ticks since the epoch or `kNoTime`.
+  void append(std::span<const rep> ticks);
+
+  // Throws `parse_error` if the raw time string of the point is invalid.
+  std::optional<time_point> operator[](size_t index) const;
+
+private:
+  static constexpr rep kUnparsed = kNoTime + 1;
+
+  // Ticks since the epoch, or one of the markers above. Replaced with the
+  // parsed ticks on first read, atomically such that concurrent readers are
+  // safe.
+  mutable std::pmr::vector<rep> values_;
+  // End offset in `raw_` of the raw time string of each point.
+  std::pmr::vector<size_t> raw_ends_;
+  std::pmr::string raw_;
+};
+
+// Structure-of-arrays storage of the <trkpt> data of a segment, one column per
+// field. The metric kernels only read the columns they reduce.
+struct PointColumns
+{
+  std::pmr::vector<double> latitude;
+  std::pmr::vector<double> longitude;
+  std::pmr::vector<double> elevation;
+  TimeColumn time;
+
+  PointColumns() = default;
+  explicit PointColumns(std::pmr::memory_resource* resource)
+      : latitude(resource), longitude(resource), elevation(resource), time(resource)
+  {
+  }
+
+  bool operator==(const PointColumns&) const = default;
+
+  size_t size() const noexcept { return latitude.size(); }
+  bool empty() const noexcept { return latitude.empty(); }
+
+  void reserve(size_t count);
+  void clear() noexcept;
+  void push_back(const LatLong& point, std::string_view raw_time = {});
+  void push_back(const LatLong& point, std::optional<TimeColumn::time_point> time);
+  // Appends the points `[first, first + count)` of `other`.
+  void append(const PointColumns& other, size_t first, size_t count);
+
+  // Gathers the point at `index` from the columns.
+  LatLong operator[](size_t index) const;
+};
+
+// How a location between two points is estimated.
+enum class Interpolation
+{
+  // Linear in latitude, longitude and elevation. Accurate for points close
+  // together, such as those of a recorded track.
+  Linear,
+  // Along the great circle between the points, with linear elevation.
+  GreatCircle,
+};
+
+// Times of the points of a segment sorted for lookups by binary search. Points
+// without a time are left out.
+class TimeIndex
+{
+public:
+  using time_point = TimeColumn::time_point;
+  using rep = TimeColumn::rep;
+
+  TimeIndex() = default;
+  // Parses all the times of `times` once. Points with equal times keep their
+  // order. Throws `parse_error` if a raw time string is invalid.
+  explicit TimeIndex(const TimeColumn& times);
+
+  size_t size() const noexcept { return ticks_.size(); }
+  bool empty() const noexcept { return ticks_.empty(); }
+
+  // Sorted ticks since the epoch.
+  std::span<const rep> ticks() const noexcept { return ticks_; }
+  // Index in the column of the point of each of `ticks()`.
+  std::span<const size_t> points() const noexcept { return points_; }
+
+  // Position in `ticks()` of the first time not before `time`.
+  size_t LowerBound(time_point time) const noexcept;
+
+private:
+  std::vector<rep> ticks_;
+  std::vector<size_t> points_;
+};
+
+// Random access range gathering the points of `PointColumns` as `LatLong` values.
+class PointsView : public std::ranges::view_interface<PointsView>
+{
+public:
+  class Iterator
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = LatLong;
+    using difference_type = std::ptrdiff_t;
+    using reference = LatLong;
+    using pointer = void;
+
+    Iterator() = default;
+    Iterator(const PointColumns* columns, difference_type index) : columns_(columns), index_(index)
+    {
+    }
+
+    LatLong operator*() const { return (*columns_)[static_cast<size_t>(index_)]; }
+    LatLong operator[](difference_type offset) const { return *(*this + offset); }
+
+    Iterator& operator++() { return *this += 1; }
+    Iterator& operator--() { return *this -= 1; }
+    Iterator operator++(int) { return std::exchange(*this, *this + 1); }
+    Iterator operator--(int) { return std::exchange(*this, *this - 1); }
+    Iterator& operator+=(difference_type offset)
+    {
+      index_ += offset;
+      return *this;
+    }
+    Iterator& operator-=(difference_type offset) { return *this += -offset; }
+
+    friend Iterator operator+(Iterator it, difference_type offset) { return it += offset; }
+    friend Iterator operator+(difference_type offset, Iterator it) { return it += offset; }
+    friend Iterator operator-(Iterator it, difference_type offset) { return it -= offset; }
+    friend difference_type operator-(const Iterator& a, const Iterator& b)
+    {
+      return a.index_ - b.index_;
+    }
+    friend bool operator==(const Iterator& a, const Iterator& b) { return a.index_ == b.index_; }
+    friend auto operator<=>(const Iterator& a, const Iterator& b) { return a.index_ <=> b.index_; }
+
+  private:
+    const PointColumns* columns_ = nullptr;
+    difference_type index_ = 0;
+  };
+
+  PointsView() = default;
+  explicit PointsView(const PointColumns& columns) : columns_(&columns) {}
+
+  Iterator begin() const { return {columns_, 0}; }
+  Iterator end() const
+  {
+    return {columns_, static_cast<std::ptrdiff_t>(columns_ ? columns_->size() : 0)};
+  }
+
+private:
+  const PointColumns* columns_ = nullptr;
+};
+
 struct Bounds
 {
   std::optional<LatLong> min = std::nullopt;
@@ -61,32 +235,79 @@ struct Bounds
 
   void Add(const LatLong& location);
   void Add(std::span<const LatLong> locations);
+  void Add(const PointColumns& columns);
   void Add(const Bounds& bounds);
 
   Bounds MaxBounds(const Bounds& bounds) const;
 };
 
+// The metrics computed on first use by `Segment`, `Track` and `Gpx`.
+struct Metrics
+{
+  Bounds bounds = {};
+  double length2d = 0.0; // Meters
+  double length3d = 0.0; // Meters
+  TimeBounds time_bounds = {};
+};
+
 // Represent <trkseg> data in GPX files.
 struct Segment
 {
-  std::vector<LatLong> points;
+  PointColumns columns;
   // <extensions>
 
+  Segment() = default;
+  // Allocates the columns from `resource`, such as a `GpxArena`.
+  explicit Segment(std::pmr::memory_resource* resource) : columns(resource) {}
+
+  // Read-only view of the columns as `LatLong` values, for callers working
+  // with whole points. The view refers to the segment.
+  PointsView points() const { return PointsView(columns); }
+
   const Bounds& GetBounds() const;
   double GetLength2D() const;
   double GetLength3D() const;
   const TimeBounds& GetTimeBounds() const;
 
+  // Index of the point times, built on first use.
+  const TimeIndex& GetTimeIndex() const;
+
+  // Location at `time`, interpolated between the points recorded right before
+  // and after it. Empty if `time` is outside of the time bounds of the segment.
+  std::optional<LatLong> GetLocationAt(std::chrono::system_clock::time_point time,
+                                       Interpolation interpolation = Interpolation::Linear) const;
+
+  // Like `GetLocationAt` for many times at once, in a single pass over the
+  // time index. Throws `std::invalid_argument` if `times` is not sorted.
+  std::vector<std::optional<LatLong>>
+  GetLocationsAt(std::span<const std::chrono::system_clock::time_point> times,
+                 Interpolation interpolation = Interpolation::Linear) const;
+
+  // Discards the computed metrics and time index after the columns were
+  // replaced. Not thread-safe.
+  void ResetMetrics() noexcept;
+
+  // Updates the metrics already computed after points were appended to the
+  // columns from index `first`, reading only the new points instead of
+  // computing the metrics again. Not thread-safe.
+  void UpdateMetrics(size_t first);
+
+  // Sets metrics computed earlier for the same points, such as by a cache,
+  // instead of computing them on first use. Not thread-safe.
+  void SetMetrics(const Metrics& metrics);
+
 private:
   Bounds ComputeBounds() const;
   double ComputeLength2D() const;
   double ComputeLength3D() const;
   TimeBounds ComputeTimeBounds() const;
 
-  mutable std::optional<Bounds> bounds;
-  mutable std::optional<double> length2D;
-  mutable std::optional<double> length3D;
-  mutable std::optional<TimeBounds> time_bounds;
+  LazyValue<Bounds> bounds;
+  LazyValue<double> length2D;
+  LazyValue<double> length3D;
+  LazyValue<TimeBounds> time_bounds;
+  // Shared by copies of the segment, which keeps segments nothrow-movable.
+  LazyValue<std::shared_ptr<const TimeIndex>> time_index;
 };
 
 // Represent <trk> data in GPX files.
@@ -99,23 +320,34 @@ struct Track
   std::optional<size_t> number;
   std::optional<std::string> type;
   // <extensions>
-  std::vector<Segment> segments; // <trkseg>
+  std::pmr::vector<Segment> segments; // <trkseg>
+
+  Track() = default;
+  explicit Track(std::pmr::memory_resource* resource) : segments(resource) {}
 
   const Bounds& GetBounds() const;
   double GetLength2D() const;
   double GetLength3D() const;
   const TimeBounds& GetTimeBounds() const;
 
+  // Discards the computed metrics after the segments changed. They are
+  // computed again from the metrics of the segments. Not thread-safe.
+  void ResetMetrics() noexcept;
+
+  // Sets metrics computed earlier for the same segments, such as by a cache,
+  // instead of computing them on first use. Not thread-safe.
+  void SetMetrics(const Metrics& metrics);
+
 private:
   Bounds ComputeBounds() const;
   double ComputeLength2D() const;
   double ComputeLength3D() const;
   TimeBounds ComputeTimeBounds() const;
 
-  mutable std::optional<Bounds> bounds;
-  mutable std::optional<double> length2D;
-  mutable std::optional<double> length3D;
-  mutable std::optional<TimeBounds> time_bounds;
+  LazyValue<Bounds> bounds;
+  LazyValue<double> length2D;
+  LazyValue<double> length3D;
+  LazyValue<TimeBounds> time_bounds;
 };
 
 struct Gpx
@@ -125,27 +357,117 @@ struct Gpx
 
   // <wpt>
   // <tre>
-  std::vector<Track> tracks; // <trk>
+  std::pmr::vector<Track> tracks; // <trk>
+
+  Gpx() = default;
+  // The tracks are allocated from `resource`. The readers also pass it on to
+  // the tracks and segments they add.
+  explicit Gpx(std::pmr::memory_resource* resource) : tracks(resource) {}
 
   const Bounds& GetBounds() const;
   double GetLength2D() const;
   double GetLength3D() const;
   const TimeBounds& GetTimeBounds() const;
 
+  // Discards the computed metrics after the tracks changed. They are computed
+  // again from the metrics of the tracks. Not thread-safe.
+  void ResetMetrics() noexcept;
+
+  // Sets metrics computed earlier for the same tracks, such as by a cache,
+  // instead of computing them on first use. Not thread-safe.
+  void SetMetrics(const Metrics& metrics);
+
 private:
   Bounds ComputeBounds() const;
   double ComputeLength2D() const;
   double ComputeLength3D() const;
   TimeBounds ComputeTimeBounds() const;
 
-  mutable std::optional<Bounds> bounds;
-  mutable std::optional<double> length2D;
-  mutable std::optional<double> length3D;
-  mutable std::optional<TimeBounds> time_bounds;
+  LazyValue<Bounds> bounds;
+  LazyValue<double> length2D;
+  LazyValue<double> length3D;
+  LazyValue<TimeBounds> time_bounds;
+};
+
+// Selects which parts of the GPX data to extract. Skipped fields are left at
+// their default values.
+struct ParseOptions
+{
+  // <trkpt><ele>
+  bool elevation = true;
+  // <trkpt><time>
+  bool time = true;
+  // <metadata><name> and <trk><name>
+  bool metadata = true;
+  // Only parse the <trk> with this index in the document.
+  std::optional<size_t> track_index = std::nullopt;
+  // Only parse the <trk> elements with this <name>, which must come before
+  // their first <trkseg> as in the GPX schema.
+  std::optional<std::string> track_name = std::nullopt;
+};
+
+struct LoadOptions
+{
+  // Memory-map the file and parse it in place instead of reading it into a heap buffer.
+  bool memory_map = false;
+  ParseOptions parse = {};
+  // Parse the points of large files on this many threads, or 0 for one per
+  // hardware thread. Implies `memory_map`.
+  size_t threads = 1;
+  // Keep a binary copy of the parsed document in this directory, read instead
+  // of the GPX file while the size and modification time of the file match.
+  // See `WriteGpxCache`.
+  std::optional<std::filesystem::path> cache_dir = std::nullopt;
 };
 
-Gpx LoadGpx(const std::filesystem::path& path);
+class GpxArena;
+class ZipArchive;
+struct ZipEntry;
+
+// gzip files and ZIP archives with a single GPX file are decompressed while
+// they are parsed, without a temporary copy of the whole document.
+Gpx LoadGpx(const std::filesystem::path& path, const LoadOptions& options = {});
+
+// Allocates the document from the arena. It must not be used after the arena is
+// reset or destroyed.
+Gpx LoadGpx(const std::filesystem::path& path, GpxArena& arena, const LoadOptions& options = {});
+
+// The data is parsed without being copied where possible.
+Gpx ParseGpx(std::string_view data, const ParseOptions& options = {});
 
-Gpx ParseGpx(const std::string& path);
+// Like `ParseGpx` above, allocating the document from the arena.
+Gpx ParseGpx(std::string_view data, GpxArena& arena, const ParseOptions& options = {});
+
+// Parses a mutable buffer in place, avoiding any copies of the data. The
+// contents of the buffer are unspecified afterwards.
+Gpx ParseGpxInPlace(std::span<char> buffer, const ParseOptions& options = {});
+
+// Decompresses and parses a member of a ZIP archive. See `LoadGpxArchive` for
+// loading all the GPX files of an archive.
+Gpx ParseGpxArchiveEntry(const ZipArchive& archive, const ZipEntry& entry,
+                         const ParseOptions& options = {});
+
+// Parses GPX data file after file, keeping the file buffer and the reader state
+// allocated in between. This avoids the cold start of `LoadGpx` for every file
+// in batch jobs over many small files. Not thread-safe, use one per thread.
+class GpxParser
+{
+public:
+  GpxParser();
+  GpxParser(GpxParser&&) noexcept;
+  GpxParser& operator=(GpxParser&&) noexcept;
+  ~GpxParser();
+
+  // Reads the whole file into the buffer of the parser before parsing it.
+  Gpx Load(const std::filesystem::path& path, const ParseOptions& options = {});
+  Gpx Load(const std::filesystem::path& path, GpxArena& arena, const ParseOptions& options = {});
+
+  Gpx Parse(std::string_view data, const ParseOptions& options = {});
+  Gpx Parse(std::string_view data, GpxArena& arena, const ParseOptions& options = {});
+
+private:
+  struct State;
+  std::unique_ptr<State> state_;
+};
 
 } // namespace fastgpx
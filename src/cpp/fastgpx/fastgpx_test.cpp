@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include <catch2/benchmark/catch_benchmark.hpp>
@@ -12,8 +18,10 @@
 
 #include "fastgpx/errors.hpp"
 #include "fastgpx/fastgpx.hpp"
+#include "fastgpx/geom.hpp"
 #include "fastgpx/test_data.hpp"
 
+using Catch::Generators::as;
 using Catch::Generators::from_range;
 using Catch::Generators::table;
 using Catch::Matchers::WithinAbs;
@@ -185,6 +193,155 @@ TEST_CASE("Parse real world GPX files", "[parse][real_world]")
   }
 }
 
+TEST_CASE("Load memory-mapped real world GPX files", "[parse][real_world]")
+{
+  const auto json_path = project_path / "src/cpp/expected_gpx_data.json";
+  const auto expected_data = LoadExpectedGpxData(json_path);
+
+  const auto expected_gpx = GENERATE_REF(from_range(expected_data));
+  CAPTURE(expected_gpx.path);
+
+  const auto path = project_path / expected_gpx.path;
+  const auto gpx = fastgpx::LoadGpx(path, {.memory_map = true});
+  const auto reference = fastgpx::LoadGpx(path);
+
+  CHECK(gpx.name == reference.name);
+  REQUIRE(gpx.tracks.size() == expected_gpx.tracks.size());
+  for (size_t track_index = 0; track_index < gpx.tracks.size(); track_index++)
+  {
+    const auto& track = gpx.tracks[track_index];
+    REQUIRE(track.segments.size() == reference.tracks[track_index].segments.size());
+    for (size_t segment_index = 0; segment_index < track.segments.size(); segment_index++)
+    {
+      CHECK(track.segments[segment_index].columns ==
+            reference.tracks[track_index].segments[segment_index].columns);
+    }
+  }
+  CHECK_THAT(gpx.GetLength2D(), WithinAbs(expected_gpx.length2d, kMETERS_TOL));
+  CHECK_THAT(gpx.GetLength3D(), WithinAbs(expected_gpx.length3d, kMETERS_TOL));
+}
+
+TEST_CASE("Load real world GPX files with reused parser", "[parse][real_world][parser]")
+{
+  const auto json_path = project_path / "src/cpp/expected_gpx_data.json";
+  const auto expected_data = LoadExpectedGpxData(json_path);
+
+  // One parser for all the files, such that they reuse the buffers sized by
+  // both smaller and larger files.
+  fastgpx::GpxParser parser;
+  for (const auto& expected_gpx : expected_data)
+  {
+    CAPTURE(expected_gpx.path);
+
+    const auto path = project_path / expected_gpx.path;
+    const auto gpx = parser.Load(path);
+    const auto reference = fastgpx::LoadGpx(path);
+
+    CHECK(gpx.name == reference.name);
+    REQUIRE(gpx.tracks.size() == reference.tracks.size());
+    for (size_t track_index = 0; track_index < gpx.tracks.size(); track_index++)
+    {
+      const auto& track = gpx.tracks[track_index];
+      CHECK(track.name == reference.tracks[track_index].name);
+      REQUIRE(track.segments.size() == reference.tracks[track_index].segments.size());
+      for (size_t segment_index = 0; segment_index < track.segments.size(); segment_index++)
+      {
+        CHECK(track.segments[segment_index].columns ==
+              reference.tracks[track_index].segments[segment_index].columns);
+      }
+    }
+    CHECK_THAT(gpx.GetLength2D(), WithinAbs(expected_gpx.length2d, kMETERS_TOL));
+  }
+}
+
+TEST_CASE("Load memory-mapped non-existing file path", "[parse][simple]")
+{
+  const auto path = project_path / "gpx/not-a-real-path/fake.gpx";
+  REQUIRE_THROWS_AS(fastgpx::LoadGpx(path, {.memory_map = true}), fastgpx::parse_error);
+}
+
+TEST_CASE("Load GPX file with unicode path", "[parse][unicode]")
+{
+  // "テスト.gpx", escaped to keep the source encoding out of it.
+  const auto path = project_path / std::filesystem::path(u8"gpx/test/\u30C6\u30B9\u30C8.gpx");
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+
+  const auto gpx = fastgpx::LoadGpx(path);
+  REQUIRE_FALSE(gpx.tracks.empty());
+  const auto expected = fastgpx::ParseGpx(buffer.str());
+  CHECK(gpx.GetLength2D() == expected.GetLength2D());
+  CHECK(gpx.GetTimeBounds() == expected.GetTimeBounds());
+}
+
+TEST_CASE("Load GPX file with unicode path with reused parser", "[parse][unicode][parser]")
+{
+  // "テスト.gpx", escaped to keep the source encoding out of it.
+  const auto path = project_path / std::filesystem::path(u8"gpx/test/\u30C6\u30B9\u30C8.gpx");
+
+  fastgpx::GpxParser parser;
+  const auto gpx = parser.Load(path);
+  REQUIRE_FALSE(gpx.tracks.empty());
+  CHECK_THAT(gpx.GetLength2D(), WithinAbs(17809.2701, kMETERS_TOL));
+  // Reading a file into the buffer of the parser again.
+  CHECK(parser.Load(path).GetLength2D() == gpx.GetLength2D());
+}
+
+TEST_CASE("Load memory-mapped GPX file with unicode path", "[parse][unicode]")
+{
+  // "テスト.gpx", escaped to keep the source encoding out of it.
+  const auto path = project_path / std::filesystem::path(u8"gpx/test/\u30C6\u30B9\u30C8.gpx");
+  const size_t threads = GENERATE(as<size_t>{}, 1, 2);
+  CAPTURE(threads);
+
+  const auto expected = fastgpx::LoadGpx(path);
+  REQUIRE_FALSE(expected.tracks.empty());
+  const auto gpx = fastgpx::LoadGpx(path, {.memory_map = true, .threads = threads});
+  CHECK(gpx.GetLength2D() == expected.GetLength2D());
+  CHECK(gpx.GetTimeBounds() == expected.GetTimeBounds());
+}
+
+TEST_CASE("Load compressed GPX files", "[parse][compressed]")
+{
+  const auto file_name = GENERATE(as<std::string>{}, "segment.gpx.gz", "segment.zip");
+  const bool memory_map = GENERATE(false, true);
+  CAPTURE(file_name, memory_map);
+
+  const auto path = project_path / "gpx/test" / file_name;
+  const auto gpx = fastgpx::LoadGpx(path, {.memory_map = memory_map});
+  const auto reference = fastgpx::LoadGpx(project_path / "gpx/test/segment.gpx");
+
+  REQUIRE(gpx.tracks.size() == reference.tracks.size());
+  REQUIRE(gpx.tracks[0].segments.size() == reference.tracks[0].segments.size());
+  CHECK(gpx.tracks[0].segments[0].columns == reference.tracks[0].segments[0].columns);
+  CHECK(gpx.GetLength2D() == reference.GetLength2D());
+
+  // The parser and in-memory data detect the compression the same way.
+  fastgpx::GpxParser parser;
+  CHECK(parser.Load(path).GetLength2D() == reference.GetLength2D());
+
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  CHECK(fastgpx::ParseGpx(buffer.str()).GetLength2D() == reference.GetLength2D());
+}
+
+TEST_CASE("Load corrupt compressed GPX data", "[parse][compressed]")
+{
+  std::ifstream file(project_path / "gpx/test/segment.gpx.gz", std::ios::binary);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  auto data = buffer.str();
+
+  // Flip a bit in the CRC-32 of the trailer.
+  data[data.size() - 8] ^= 1;
+  CHECK_THROWS_AS(fastgpx::ParseGpx(data), fastgpx::parse_error);
+
+  data.resize(data.size() / 2);
+  CHECK_THROWS_AS(fastgpx::ParseGpx(data), fastgpx::parse_error);
+}
+
 TEST_CASE("Benchmark GPX Parsing", "[!benchmark][parse]")
 {
   const auto path1 = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
@@ -193,6 +350,32 @@ TEST_CASE("Benchmark GPX Parsing", "[!benchmark][parse]")
     return fastgpx::LoadGpx(path1);
   };
 
+  BENCHMARK("Connected_20240518_094959_.gpx (memory mapped)")
+  {
+    return fastgpx::LoadGpx(path1, {.memory_map = true});
+  };
+
+  std::ifstream file(path1, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const auto data = buffer.str();
+  BENCHMARK("Connected_20240518_094959_.gpx (stream reader)")
+  {
+    return fastgpx::ParseGpx(data);
+  };
+
+  // The stream reader only reads UTF-8, so the same document declared as
+  // ISO-8859-1 goes through pugixml and ReadGpxXml.
+  constexpr std::string_view utf8_encoding = "encoding='UTF-8'";
+  auto dom_data = data;
+  const auto declaration = dom_data.find(utf8_encoding);
+  REQUIRE(declaration != std::string::npos);
+  dom_data.replace(declaration, utf8_encoding.size(), "encoding='ISO-8859-1'");
+  BENCHMARK("Connected_20240518_094959_.gpx (DOM)")
+  {
+    return fastgpx::ParseGpx(dom_data);
+  };
+
   const auto path2 =
       project_path /
       "gpx/2024 TopCamp/Connected_20240520_103549_Lagerbergsgatan_35_45131_Uddevalla_Sweden.gpx";
@@ -247,8 +430,180 @@ TEST_CASE("Parse GPX from XML string", "[parse][simple]")
   CHECK_THAT(gpx.GetLength3D(), WithinAbs(1.7074, kMETERS_TOL));
 }
 
+TEST_CASE("Parse GPX from mutable buffer in place", "[parse][simple]")
+{
+  const auto path = project_path / "gpx/test/debug-segment.gpx";
+
+  std::ifstream file(path);
+  if (!file)
+  {
+    throw std::runtime_error("Cannot open file: " + path.string());
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  auto data = buffer.str();
+
+  const auto gpx = fastgpx::ParseGpxInPlace(data);
+
+  REQUIRE(gpx.tracks.size() == 1);
+  REQUIRE(gpx.tracks[0].segments.size() == 1);
+  CHECK_THAT(gpx.GetLength2D(), WithinAbs(1.3839, kMETERS_TOL));
+  CHECK_THAT(gpx.GetLength3D(), WithinAbs(1.7074, kMETERS_TOL));
+}
+
+TEST_CASE("Parse malformed GPX data", "[parse][simple]")
+{
+  CHECK_THROWS_AS(fastgpx::ParseGpx("<gpx><trk></gpx>"), fastgpx::parse_error);
+
+  std::string data = "<gpx><trk>";
+  CHECK_THROWS_AS(fastgpx::ParseGpxInPlace(data), fastgpx::parse_error);
+}
+
+namespace {
+
+constexpr std::string_view kMultiTrackGpx = R"(<?xml version="1.0"?>
+<gpx version="1.1">
+  <metadata><name>Trip</name></metadata>
+  <trk>
+    <name>First</name>
+    <trkseg>
+      <trkpt lat="63.1" lon="10.2"><ele>12.5</ele><time>2024-05-18T07:50:00Z</time></trkpt>
+    </trkseg>
+  </trk>
+  <trk>
+    <trkseg><trkpt lat="63.2" lon="10.3"/></trkseg>
+  </trk>
+  <trk>
+    <name>Third</name>
+    <trkseg><trkpt lat="63.3" lon="10.4"><ele>20.0</ele></trkpt></trkseg>
+  </trk>
+</gpx>)";
+
+} // namespace
+
+TEST_CASE("Parse track names", "[parse][options]")
+{
+  const auto gpx = fastgpx::ParseGpx(kMultiTrackGpx);
+
+  CHECK(gpx.name == "Trip");
+  REQUIRE(gpx.tracks.size() == 3);
+  CHECK(gpx.tracks[0].name == "First");
+  CHECK_FALSE(gpx.tracks[1].name.has_value());
+  CHECK(gpx.tracks[2].name == "Third");
+}
+
+TEST_CASE("Parse without elevation, time and metadata", "[parse][options]")
+{
+  const ParseOptions options{.elevation = false, .time = false, .metadata = false};
+  const auto gpx = fastgpx::ParseGpx(kMultiTrackGpx, options);
+
+  CHECK_FALSE(gpx.name.has_value());
+  REQUIRE(gpx.tracks.size() == 3);
+  CHECK_FALSE(gpx.tracks[0].name.has_value());
+  const auto& columns = gpx.tracks[0].segments[0].columns;
+  CHECK(columns.latitude[0] == 63.1);
+  CHECK(columns.elevation[0] == 0.0);
+  CHECK_FALSE(columns.time[0].has_value());
+}
+
+TEST_CASE("Parse track by index", "[parse][options]")
+{
+  const auto gpx = fastgpx::ParseGpx(kMultiTrackGpx, {.track_index = 1});
+
+  REQUIRE(gpx.tracks.size() == 1);
+  CHECK(gpx.tracks[0].segments[0].columns.latitude[0] == 63.2);
+
+  CHECK(fastgpx::ParseGpx(kMultiTrackGpx, {.track_index = 3}).tracks.empty());
+}
+
+TEST_CASE("Parse track by name", "[parse][options]")
+{
+  const auto gpx = fastgpx::ParseGpx(kMultiTrackGpx, {.track_name = "Third"});
+
+  REQUIRE(gpx.tracks.size() == 1);
+  CHECK(gpx.tracks[0].name == "Third");
+  CHECK(gpx.tracks[0].segments[0].columns.latitude[0] == 63.3);
+
+  CHECK(fastgpx::ParseGpx(kMultiTrackGpx, {.track_name = "Fourth"}).tracks.empty());
+}
+
+TEST_CASE("Parse track by name after other children", "[parse][options]")
+{
+  // The stream reader rejects other encodings than UTF-8, leaving it to pugixml.
+  const auto encoding = GENERATE(as<std::string>{}, "UTF-8", "ISO-8859-1");
+  CAPTURE(encoding);
+  const auto data = std::format(R"(<?xml version="1.0" encoding="{}"?>
+<gpx version="1.1">
+  <trk>
+    <desc>Named after its description</desc>
+    <name>Second</name>
+    <trkseg><trkpt lat="63.2" lon="10.3"/></trkseg>
+  </trk>
+  <trk>
+    <trkseg><trkpt lat="63.3" lon="10.4"/></trkseg>
+    <name>Third</name>
+  </trk>
+</gpx>)",
+                                encoding);
+
+  const auto gpx = fastgpx::ParseGpx(data, {.track_name = "Second"});
+  REQUIRE(gpx.tracks.size() == 1);
+  CHECK(gpx.tracks[0].name == "Second");
+  CHECK(gpx.tracks[0].segments[0].columns.latitude[0] == 63.2);
+
+  // Only a <name> before the segments matches, as in the GPX schema.
+  CHECK(fastgpx::ParseGpx(data, {.track_name = "Third"}).tracks.empty());
+}
+
+TEST_CASE("Load real world GPX file with parse options", "[parse][options]")
+{
+  const auto path =
+      project_path / "gpx/2024 Sommertur/Connected_20240622_102935_Kvikneveien_4694_2512_Kvikne.gpx";
+  const auto memory_map = GENERATE(false, true);
+  CAPTURE(memory_map);
+
+  const LoadOptions options{
+      .memory_map = memory_map,
+      .parse =
+          {
+              .elevation = false,
+              .time = false,
+              .track_name = "Kvikneveien 4694, 2512 Kvikne",
+          },
+  };
+  const auto gpx = fastgpx::LoadGpx(path, options);
+
+  REQUIRE(gpx.tracks.size() == 1);
+  CHECK(gpx.tracks[0].name == "Kvikneveien 4694, 2512 Kvikne");
+  CHECK_THAT(gpx.GetLength2D(), WithinAbs(262394.2281, kMETERS_TOL));
+  CHECK_THAT(gpx.GetLength3D(), WithinAbs(gpx.GetLength2D(), kMETERS_TOL));
+  CHECK(gpx.GetTimeBounds().IsEmpty());
+
+  const LoadOptions other_track{.memory_map = memory_map, .parse = {.track_name = "Other"}};
+  CHECK(fastgpx::LoadGpx(path, other_track).tracks.empty());
+}
+
 // Bounds
 
+TEST_CASE("Reuse parser after errors", "[parse][parser]")
+{
+  fastgpx::GpxParser parser;
+
+  CHECK_THROWS_AS(parser.Parse("<gpx><trk></gpx>"), fastgpx::parse_error);
+  CHECK_THROWS_AS(parser.Load(project_path / "gpx/not-a-real-path/fake.gpx"),
+                  fastgpx::parse_error);
+
+  const auto gpx = parser.Load(project_path / "gpx/test/debug-segment.gpx");
+  REQUIRE(gpx.tracks.size() == 1);
+  CHECK_THAT(gpx.GetLength2D(), WithinAbs(1.3839, kMETERS_TOL));
+
+  // The options only apply to the one call.
+  const auto without_elevation = parser.Parse(kMultiTrackGpx, {.elevation = false});
+  CHECK(without_elevation.tracks[0].segments[0].columns.elevation[0] == 0.0);
+  const auto with_elevation = parser.Parse(kMultiTrackGpx);
+  CHECK(with_elevation.tracks[0].segments[0].columns.elevation[0] == 12.5);
+}
+
 TEST_CASE("Add to Bounds", "[bounds]")
 {
   Bounds bounds;
@@ -318,3 +673,155 @@ TEST_CASE("Max Bounds", "[bounds]")
   CHECK_THAT(result2.max->latitude, WithinAbs(15.0, 1e-8));
   CHECK_THAT(result2.max->longitude, WithinAbs(30.0, 1e-8));
 }
+
+TEST_CASE("Point time column", "[segment][time]")
+{
+  STATIC_REQUIRE(std::is_trivially_copyable_v<LatLong>);
+
+  using namespace std::chrono_literals;
+  const std::chrono::system_clock::time_point time =
+      std::chrono::sys_days{2024y / 5 / 18} + 9h + 49min + 59s;
+
+  PointColumns columns;
+  columns.push_back({63.1, 10.1, 1.0}, "2024-05-18T09:49:59Z");
+  columns.push_back({63.2, 10.2, 2.0});
+  columns.push_back({63.3, 10.3, 3.0}, time + 1s);
+  columns.push_back({63.4, 10.4, 4.0}, "not a time");
+
+  REQUIRE(columns.size() == 4);
+  CHECK(columns[1] == LatLong{63.2, 10.2, 2.0});
+  CHECK(columns.time[0] == time);
+  CHECK_FALSE(columns.time[1].has_value());
+  CHECK(columns.time[2] == time + 1s);
+  // Raw times are only parsed when read.
+  CHECK_THROWS_AS(columns.time[3], parse_error);
+
+  Segment segment;
+  segment.columns = columns;
+  segment.columns.time.clear();
+  segment.columns.time.push_back(time);
+  segment.columns.time.push_back("");
+  segment.columns.time.push_back("2024-05-18T10:00:00Z");
+  segment.columns.time.push_back(std::nullopt);
+  CHECK(segment.GetTimeBounds().start_time == time);
+  CHECK(segment.GetTimeBounds().end_time == std::chrono::sys_days{2024y / 5 / 18} + 10h);
+}
+
+TEST_CASE("Locate segment points by time", "[time_index]")
+{
+  using namespace std::chrono_literals;
+  const std::chrono::system_clock::time_point time = std::chrono::sys_days{2024y / 5 / 18} + 8h;
+
+  // Out of order, with a point without a time and two points at the same time.
+  Segment segment;
+  segment.columns.push_back({63.0, 10.0, 100.0}, time);
+  segment.columns.push_back({63.2, 10.2, 300.0}, time + 20s);
+  segment.columns.push_back({63.1, 10.1, 200.0}, time + 10s);
+  segment.columns.push_back({50.0, 5.0, 0.0}, std::nullopt);
+  segment.columns.push_back({63.3, 10.3, 400.0}, time + 20s);
+
+  const auto& index = segment.GetTimeIndex();
+  REQUIRE(index.size() == 4);
+  CHECK(std::ranges::is_sorted(index.ticks()));
+  CHECK(std::vector(index.points().begin(), index.points().end()) ==
+        std::vector<size_t>{0, 2, 1, 4});
+  CHECK(&segment.GetTimeIndex() == &index);
+
+  CHECK(segment.GetLocationAt(time) == LatLong{63.0, 10.0, 100.0});
+  CHECK(segment.GetLocationAt(time + 10s) == LatLong{63.1, 10.1, 200.0});
+  // The first of the points recorded at the same time.
+  CHECK(segment.GetLocationAt(time + 20s) == LatLong{63.2, 10.2, 300.0});
+  CHECK_FALSE(segment.GetLocationAt(time - 1s).has_value());
+  CHECK_FALSE(segment.GetLocationAt(time + 21s).has_value());
+
+  const auto between = segment.GetLocationAt(time + 5s);
+  REQUIRE(between.has_value());
+  CHECK_THAT(between->latitude, WithinAbs(63.05, 1e-9));
+  CHECK_THAT(between->longitude, WithinAbs(10.05, 1e-9));
+  CHECK_THAT(between->elevation, WithinAbs(150.0, 1e-9));
+
+  // Close to linear over short distances, and on the great circle.
+  const auto on_circle = segment.GetLocationAt(time + 5s, Interpolation::GreatCircle);
+  REQUIRE(on_circle.has_value());
+  CHECK_THAT(on_circle->latitude, WithinAbs(63.05, 1e-3));
+  CHECK_THAT(on_circle->longitude, WithinAbs(10.05, 1e-3));
+  CHECK_THAT(on_circle->elevation, WithinAbs(150.0, 1e-9));
+  const LatLong first{63.0, 10.0};
+  const LatLong second{63.1, 10.1};
+  CHECK_THAT(haversine(first, *on_circle) + haversine(*on_circle, second),
+             WithinAbs(haversine(first, second), kMETERS_TOL));
+  CHECK_THAT(haversine(first, *on_circle), WithinAbs(haversine(first, second) / 2, kMETERS_TOL));
+
+  // Appended points are indexed on next use.
+  const size_t first_new = segment.columns.size();
+  segment.columns.push_back({63.4, 10.4, 500.0}, time + 30s);
+  segment.UpdateMetrics(first_new);
+  CHECK(segment.GetTimeIndex().size() == 5);
+  CHECK(segment.GetLocationAt(time + 30s) == LatLong{63.4, 10.4, 500.0});
+
+  CHECK_FALSE(Segment().GetLocationAt(time).has_value());
+}
+
+TEST_CASE("Locate many times in one pass", "[time_index]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  const auto gpx = fastgpx::LoadGpx(path);
+  const auto& segment = gpx.tracks[0].segments[0];
+  const auto interpolation = GENERATE(Interpolation::Linear, Interpolation::GreatCircle);
+
+  // Points, points in between and times outside of the segment.
+  const auto& bounds = segment.GetTimeBounds();
+  REQUIRE(bounds.start_time.has_value());
+  std::vector<std::chrono::system_clock::time_point> times;
+  times.push_back(*bounds.start_time - std::chrono::hours(1));
+  for (auto time = *bounds.start_time; time <= *bounds.end_time; time += std::chrono::seconds(7))
+  {
+    times.push_back(time);
+  }
+  times.push_back(*bounds.end_time);
+  times.push_back(*bounds.end_time + std::chrono::hours(1));
+
+  const auto locations = segment.GetLocationsAt(times, interpolation);
+  REQUIRE(locations.size() == times.size());
+  CHECK_FALSE(locations.front().has_value());
+  CHECK_FALSE(locations.back().has_value());
+  for (size_t i = 0; i < times.size(); ++i)
+  {
+    CAPTURE(i);
+    REQUIRE(locations[i] == segment.GetLocationAt(times[i], interpolation));
+  }
+
+  std::ranges::reverse(times);
+  CHECK_THROWS_AS(segment.GetLocationsAt(times), std::invalid_argument);
+}
+
+TEST_CASE("Benchmark time lookups", "[!benchmark][time_index]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  const auto gpx = fastgpx::LoadGpx(path);
+  const auto& segment = gpx.tracks[0].segments[0];
+  const auto start = *segment.GetTimeBounds().start_time;
+  std::vector<std::chrono::system_clock::time_point> times;
+  for (int i = 0; i < 1000; ++i)
+  {
+    times.push_back(start + std::chrono::seconds(i * 3));
+  }
+
+  BENCHMARK("GetLocationAt")
+  {
+    size_t found = 0;
+    for (const auto time : times)
+    {
+      if (segment.GetLocationAt(time))
+      {
+        ++found;
+      }
+    }
+    return found;
+  };
+
+  BENCHMARK("GetLocationsAt")
+  {
+    return segment.GetLocationsAt(times);
+  };
+}
@@ -1,9 +1,18 @@
 #include "fastgpx/filesystem.hpp"
 
+#include <algorithm>
+#include <format>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 #ifdef _WIN32
-  #include <windows.h> // for _wfopen
+  #include <windows.h> // for _wfopen, MapViewOfFile
+#else
+  #include <fcntl.h>    // for open
+  #include <sys/mman.h> // for mmap, madvise
+  #include <sys/stat.h> // for fstat
+  #include <unistd.h>   // for close
 #endif
 
 namespace fastgpx {
@@ -56,9 +65,9 @@ FILE* open_file(const std::filesystem::path& file_path)
   FILE* file = nullptr;
 
 #ifdef _WIN32
-  // On Windows, open with wide string support
-  const auto pathu16 = utf8_to_utf16(file_path.string());
-  _wfopen_s(&file, pathu16.c_str(), L"rb");
+  // The native path is already UTF-16 on Windows, whereas `string()` would
+  // convert it to the ANSI code page.
+  _wfopen_s(&file, file_path.c_str(), L"rb");
 #else
   // On other platforms, open with standard fopen
   file = fopen(file_path.string().c_str(), "rb");
@@ -67,4 +76,194 @@ FILE* open_file(const std::filesystem::path& file_path)
   return file;
 }
 
+bool match_glob(std::string_view pattern, std::string_view name) noexcept
+{
+  // Greedy matching with backtracking to the most recent `*`.
+  size_t p = 0;
+  size_t n = 0;
+  size_t star = std::string_view::npos;
+  size_t star_name = 0;
+  while (n < name.size())
+  {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+    {
+      p++;
+      n++;
+    }
+    else if (p < pattern.size() && pattern[p] == '*')
+    {
+      star = p++;
+      star_name = n;
+    }
+    else if (star != std::string_view::npos)
+    {
+      p = star + 1;
+      n = ++star_name;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*')
+  {
+    p++;
+  }
+  return p == pattern.size();
+}
+
+namespace {
+
+template <typename Iterator>
+void collect_files(Iterator iterator, std::string_view pattern,
+                   std::vector<std::filesystem::path>& files)
+{
+  for (const auto& entry : iterator)
+  {
+    if (!entry.is_regular_file())
+    {
+      continue;
+    }
+    const auto name = entry.path().filename().u8string();
+    if (match_glob(pattern, std::string_view(reinterpret_cast<const char*>(name.data()),
+                                             name.size())))
+    {
+      files.push_back(entry.path());
+    }
+  }
+}
+
+} // namespace
+
+std::vector<std::filesystem::path> find_files(const std::filesystem::path& root,
+                                              std::string_view pattern, bool recursive)
+{
+  std::vector<std::filesystem::path> files;
+  if (recursive)
+  {
+    collect_files(std::filesystem::recursive_directory_iterator(root), pattern, files);
+  }
+  else
+  {
+    collect_files(std::filesystem::directory_iterator(root), pattern, files);
+  }
+  std::ranges::sort(files);
+  return files;
+}
+
+MappedFile::MappedFile(const std::filesystem::path& file_path)
+{
+#ifdef _WIN32
+  // The native path is already UTF-16 on Windows.
+  const HANDLE file = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error(std::format("Unable to open file: {}", file_path.string()));
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size))
+  {
+    CloseHandle(file);
+    throw std::runtime_error(std::format("Unable to get file size: {}", file_path.string()));
+  }
+
+  // Mapping an empty file is an error, so leave the view empty instead.
+  if (file_size.QuadPart > 0)
+  {
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+      throw std::runtime_error(std::format("Unable to map file: {}", file_path.string()));
+    }
+    // The view keeps the mapping alive after its handle is closed.
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr)
+    {
+      throw std::runtime_error(std::format("Unable to map file: {}", file_path.string()));
+    }
+    data_ = static_cast<const char*>(view);
+    size_ = static_cast<size_t>(file_size.QuadPart);
+  }
+  else
+  {
+    CloseHandle(file);
+  }
+#else
+  const int fd = ::open(file_path.string().c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+  {
+    throw std::runtime_error(std::format("Unable to open file: {}", file_path.string()));
+  }
+
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) == -1)
+  {
+    ::close(fd);
+    throw std::runtime_error(std::format("Unable to get file size: {}", file_path.string()));
+  }
+
+  // Mapping an empty file is an error, so leave the view empty instead.
+  const auto file_size = static_cast<size_t>(file_stat.st_size);
+  if (file_size > 0)
+  {
+    void* address = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+      throw std::runtime_error(std::format("Unable to map file: {}", file_path.string()));
+    }
+  #ifdef MADV_SEQUENTIAL
+    // Aggressive read-ahead; pages behind the parser can be dropped early.
+    ::madvise(address, file_size, MADV_SEQUENTIAL);
+  #endif
+    data_ = static_cast<const char*>(address);
+    size_ = file_size;
+  }
+  else
+  {
+    ::close(fd);
+  }
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this != &other)
+  {
+    Unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile()
+{
+  Unmap();
+}
+
+void MappedFile::Unmap() noexcept
+{
+  if (data_ == nullptr)
+  {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+#else
+  ::munmap(const_cast<char*>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
 } // namespace fastgpx
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace fastgpx {
 
@@ -16,11 +19,68 @@ std::wstring utf8_to_utf16(const std::string& utf8_str);
 #endif
 
 /**
- * @brief Opens a file for reading in binary mode given a UTF-8 path.
+ * @brief Opens a file for reading in binary mode.
  *
- * @param file_path UTF-8 file path.
- * @return FILE*
+ * @param file_path Opened by its native path, which is UTF-16 on Windows.
+ * @return FILE* or `nullptr` if the file cannot be opened.
  */
 FILE* open_file(const std::filesystem::path& file_path);
 
+/**
+ * @brief Matches a file name against a glob pattern.
+ *
+ * Supports `*` (any sequence of characters) and `?` (any single character).
+ * Matching is case-sensitive.
+ *
+ * @param pattern
+ * @param name UTF-8 file name.
+ */
+bool match_glob(std::string_view pattern, std::string_view name) noexcept;
+
+/**
+ * @brief Lists the regular files in a directory whose file names match a glob pattern.
+ *
+ * @throws std::filesystem::filesystem_error if the directory cannot be read.
+ * @param root
+ * @param pattern See `match_glob`.
+ * @param recursive Include files in subdirectories.
+ * @return std::vector<std::filesystem::path> Sorted file paths.
+ */
+std::vector<std::filesystem::path> find_files(const std::filesystem::path& root,
+                                              std::string_view pattern, bool recursive);
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Uses `mmap` with `MADV_SEQUENTIAL` on POSIX systems and `MapViewOfFile` on
+ * Windows. The pages are read on demand from the page cache without copying
+ * them into a heap buffer.
+ */
+class MappedFile
+{
+public:
+  /**
+   * @brief Maps the file into memory.
+   *
+   * @throws std::runtime_error if the file cannot be opened or mapped.
+   * @param file_path UTF-8 file path.
+   */
+  explicit MappedFile(const std::filesystem::path& file_path);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  ~MappedFile();
+
+  std::string_view data() const noexcept { return {data_, size_}; }
+  size_t size() const noexcept { return size_; }
+
+private:
+  void Unmap() noexcept;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
 } // namespace fastgpx
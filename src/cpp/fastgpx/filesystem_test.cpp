@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <filesystem>
 #include <stdexcept>
@@ -23,10 +24,89 @@ TEST_CASE("Open file with ascii path for binary reading", "[filesystem]")
   CHECK(fclose(file) == 0);
 }
 
-#ifdef _WIN32
+TEST_CASE("Open file with unicode path for binary reading", "[filesystem][unicode]")
+{
+  // "テスト.gpx", escaped to keep the source encoding out of it.
+  const auto path = project_path / std::filesystem::path(u8"gpx/test/\u30C6\u30B9\u30C8.gpx");
+
+  const auto file = fastgpx::open_file(path);
+  REQUIRE(file != nullptr);
+
+  std::array<char, 5> buffer;
+  const auto result = fread(buffer.data(), sizeof(char), buffer.size(), file);
+  CHECK(result == buffer.size());
+  CHECK(std::string(buffer.data(), buffer.size()) == "<?xml");
 
-// TODO: Test unicode path.
-//   UTF-8 encoding in C++ source files can be a pain.
+  CHECK(fclose(file) == 0);
+}
+
+TEST_CASE("Match glob patterns", "[filesystem]")
+{
+  CHECK(fastgpx::match_glob("*.gpx", "track.gpx"));
+  CHECK(fastgpx::match_glob("*.gpx", ".gpx"));
+  CHECK_FALSE(fastgpx::match_glob("*.gpx", "track.gpx.bak"));
+  CHECK_FALSE(fastgpx::match_glob("*.gpx", "track.GPX"));
+  CHECK(fastgpx::match_glob("Connected_*_*.gpx", "Connected_20240518_094959_.gpx"));
+  CHECK(fastgpx::match_glob("segment?.gpx", "segment1.gpx"));
+  CHECK_FALSE(fastgpx::match_glob("segment?.gpx", "segment.gpx"));
+  CHECK(fastgpx::match_glob("*", ""));
+  CHECK_FALSE(fastgpx::match_glob("", "track.gpx"));
+}
+
+TEST_CASE("Find files in directory", "[filesystem]")
+{
+  const auto root = project_path / "gpx/test";
+  const auto files = fastgpx::find_files(root, "*.gpx", false);
+
+  REQUIRE(files.size() == 4);
+  CHECK(files[0] == root / "debug-segment.gpx");
+  CHECK(files[1] == root / "segment.gpx");
+}
+
+TEST_CASE("Find files in directory recursively", "[filesystem]")
+{
+  const auto root = project_path / "gpx";
+  const auto flat = fastgpx::find_files(root, "*.gpx", false);
+  const auto recursive = fastgpx::find_files(root, "*.gpx", true);
+
+  CHECK(recursive.size() > flat.size());
+  CHECK(std::ranges::is_sorted(recursive));
+  CHECK(std::ranges::find(recursive, root / "test/debug-segment.gpx") != recursive.end());
+}
+
+TEST_CASE("Find files in non-existing directory", "[filesystem]")
+{
+  const auto root = project_path / "gpx/not-a-real-path";
+  REQUIRE_THROWS_AS(fastgpx::find_files(root, "*.gpx", true),
+                    std::filesystem::filesystem_error);
+}
+
+TEST_CASE("Memory-map file", "[filesystem]")
+{
+  const auto path = project_path / "gpx/test/debug-segment.gpx";
+
+  const fastgpx::MappedFile file(path);
+  REQUIRE(file.size() == std::filesystem::file_size(path));
+  CHECK(file.data().starts_with("<?xml"));
+}
+
+TEST_CASE("Memory-map file with unicode path", "[filesystem][unicode]")
+{
+  // "テスト.gpx", escaped to keep the source encoding out of it.
+  const auto path = project_path / std::filesystem::path(u8"gpx/test/\u30C6\u30B9\u30C8.gpx");
+
+  const fastgpx::MappedFile file(path);
+  REQUIRE(file.size() == std::filesystem::file_size(path));
+  CHECK(file.data().starts_with("<?xml"));
+}
+
+TEST_CASE("Memory-map non-existing file", "[filesystem]")
+{
+  const auto path = project_path / "gpx/not-a-real-path/fake.gpx";
+  REQUIRE_THROWS_AS(fastgpx::MappedFile(path), std::runtime_error);
+}
+
+#ifdef _WIN32
 
 TEST_CASE("Convert UTF-8 string to UTF-16 string", "[filesystem][unicode]")
 {
@@ -1,11 +1,53 @@
 #include "fastgpx/geom.hpp"
 
+#include <array>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <numbers>
+#include <span>
 
+#include "fastgpx/compact.hpp"
 #include "fastgpx/fastgpx.hpp"
 
 namespace fastgpx {
+
+namespace {
+
+// Uniform access to the coordinates of the point types.
+
+double Latitude(const LatLong& point) noexcept
+{
+  return point.latitude;
+}
+
+double Longitude(const LatLong& point) noexcept
+{
+  return point.longitude;
+}
+
+double Elevation(const LatLong& point) noexcept
+{
+  return point.elevation;
+}
+
+double Latitude(const CompactLatLong& point) noexcept
+{
+  return point.latitude();
+}
+
+double Longitude(const CompactLatLong& point) noexcept
+{
+  return point.longitude();
+}
+
+double Elevation(const CompactLatLong& point) noexcept
+{
+  return point.elevation();
+}
+
+} // namespace
+
 namespace v1 {
 
 // latitude/longitude in GPX files is always in WGS84 datum
@@ -21,11 +63,12 @@ double to_radians(double degrees) noexcept
   return degrees * TO_RADIANS;
 }
 
-double haversine(const LatLong& ll1, const LatLong& ll2) noexcept
+template<typename Point>
+double haversine_impl(const Point& ll1, const Point& ll2) noexcept
 {
-  const auto d_lon = to_radians(ll1.longitude - ll2.longitude);
-  const auto lat1 = to_radians(ll1.latitude);
-  const auto lat2 = to_radians(ll2.latitude);
+  const auto d_lon = to_radians(Longitude(ll1) - Longitude(ll2));
+  const auto lat1 = to_radians(Latitude(ll1));
+  const auto lat2 = to_radians(Latitude(ll2));
   const auto d_lat = lat1 - lat2;
 
   const auto a = std::pow(std::sin(d_lat / 2), 2) +
@@ -57,40 +100,63 @@ double haversine(const LatLong& ll1, const LatLong& ll2) noexcept
  * @param use_2d
  * @return double Meters
  */
-double distance(const LatLong& ll2, const LatLong& ll1, bool use_haversine = false,
+template<typename Point>
+double distance(const Point& ll2, const Point& ll1, bool use_haversine = false,
                 bool use_2d = true) noexcept
 {
-  if (use_haversine ||
-      (std::abs(ll1.latitude - ll2.latitude) > .2 || std::abs(ll1.longitude - ll2.longitude) > .2))
-    return v1::haversine(ll1, ll2);
+  if (use_haversine || (std::abs(Latitude(ll1) - Latitude(ll2)) > .2 ||
+                        std::abs(Longitude(ll1) - Longitude(ll2)) > .2))
+    return v1::haversine_impl(ll1, ll2);
 
-  const auto coef = std::cos(to_radians(ll1.latitude));
-  const auto x = ll1.latitude - ll2.latitude;
-  const auto y = (ll1.longitude - ll2.longitude) * coef;
+  const auto coef = std::cos(to_radians(Latitude(ll1)));
+  const auto x = Latitude(ll1) - Latitude(ll2);
+  const auto y = (Longitude(ll1) - Longitude(ll2)) * coef;
 
   const auto distance_2d = std::sqrt(x * x + y * y) * ONE_DEGREE;
 
   // TODO: Make elevation into std::optional?
   // if (ll1.elevation is None || elevation_2 is None || ll1.elevation == elevation_2)
   //     return distance_2d
-  if (use_2d || ll1.elevation == ll2.elevation)
+  if (use_2d || Elevation(ll1) == Elevation(ll2))
     return distance_2d;
 
   // return std::sqrt(std::pow(distance_2d, 2.0) + std::pow((ll1.elevation - ll2.elevation), 2.0));
-  const auto ele_diff = ll1.elevation - ll2.elevation;
+  const auto ele_diff = Elevation(ll1) - Elevation(ll2);
   return std::sqrt((distance_2d * distance_2d) + (ele_diff * ele_diff));
 }
 
+double haversine(const LatLong& ll1, const LatLong& ll2) noexcept
+{
+  return v1::haversine_impl(ll1, ll2);
+}
+
+double haversine(const CompactLatLong& ll1, const CompactLatLong& ll2) noexcept
+{
+  return v1::haversine_impl(ll1, ll2);
+}
+
 double distance2d(const LatLong& ll1, const LatLong& ll2, bool use_haversine) noexcept
 {
   return v1::distance(ll1, ll2, use_haversine, true);
 }
 
+double distance2d(const CompactLatLong& ll1, const CompactLatLong& ll2,
+                  bool use_haversine) noexcept
+{
+  return v1::distance(ll1, ll2, use_haversine, true);
+}
+
 double distance3d(const LatLong& ll1, const LatLong& ll2, bool use_haversine) noexcept
 {
   return v1::distance(ll1, ll2, use_haversine, false);
 }
 
+double distance3d(const CompactLatLong& ll1, const CompactLatLong& ll2,
+                  bool use_haversine) noexcept
+{
+  return v1::distance(ll1, ll2, use_haversine, false);
+}
+
 } // namespace v1
 
 namespace v2 {
@@ -117,32 +183,154 @@ inline constexpr double rad_to_deg(double radians) noexcept
 /// @brief Earth's quadratic mean radius for WGS84
 constexpr const double EARTH_RADIUS_IN_METERS = 6372797.560856;
 
-double haversine(const LatLong& ll1, const LatLong& ll2) noexcept
+// `cos_lat1` and `cos_lat2` are the cosines of the latitudes in radians, which
+// the segment kernels compute only once per point.
+inline double haversine_impl(const double lat1, const double lon1, const double cos_lat1,
+                             const double lat2, const double lon2, const double cos_lat2) noexcept
 {
   using namespace geom;
   // https://github.com/osmcode/libosmium/blob/f88048769c13210ca81efca17668dc57ea64c632/include/osmium/geom/haversine.hpp#L48-L73
-  double lon = std::sin(deg_to_rad(ll1.longitude - ll2.longitude) * 0.5);
+  double lon = std::sin(deg_to_rad(lon1 - lon2) * 0.5);
   lon *= lon;
 
-  double lat = std::sin(deg_to_rad(ll1.latitude - ll2.latitude) * 0.5);
+  double lat = std::sin(deg_to_rad(lat1 - lat2) * 0.5);
   lat *= lat;
 
-  const double tmp = std::cos(deg_to_rad(ll1.latitude)) * std::cos(deg_to_rad(ll2.latitude));
+  const double tmp = cos_lat1 * cos_lat2;
   return 2.0 * EARTH_RADIUS_IN_METERS * std::asin(std::sqrt(lat + tmp * lon));
 }
 
+template<typename Point>
+double haversine_impl(const Point& ll1, const Point& ll2) noexcept
+{
+  using namespace geom;
+  return haversine_impl(Latitude(ll1), Longitude(ll1), std::cos(deg_to_rad(Latitude(ll1))),
+                        Latitude(ll2), Longitude(ll2), std::cos(deg_to_rad(Latitude(ll2))));
+}
+
+// Sums `distance(haversine, elevation delta)` over consecutive points.
+template<typename Distance>
+double length_impl(std::span<const double> latitudes, std::span<const double> longitudes,
+                   std::span<const double> elevations, Distance distance) noexcept
+{
+  using namespace geom;
+  assert(latitudes.size() == longitudes.size());
+  double length = 0.0;
+  if (latitudes.empty())
+  {
+    return length;
+  }
+  double previous_cos = std::cos(deg_to_rad(latitudes[0]));
+  for (size_t i = 1; i < latitudes.size(); ++i)
+  {
+    const double cos_lat = std::cos(deg_to_rad(latitudes[i]));
+    const double surface = haversine_impl(latitudes[i - 1], longitudes[i - 1], previous_cos,
+                                            latitudes[i], longitudes[i], cos_lat);
+    length += distance(surface, elevations.empty() ? 0.0 : elevations[i - 1] - elevations[i]);
+    previous_cos = cos_lat;
+  }
+  return length;
+}
+
+template<typename Point>
+double distance3d_impl(const Point& ll1, const Point& ll2) noexcept
+{
+  const auto distance = v2::haversine_impl(ll1, ll2);
+
+  const auto elevation_diff = Elevation(ll1) - Elevation(ll2);
+  return std::sqrt((distance * distance) + (elevation_diff * elevation_diff));
+}
+
+double haversine(const LatLong& ll1, const LatLong& ll2) noexcept
+{
+  return v2::haversine_impl(ll1, ll2);
+}
+
+double haversine(const CompactLatLong& ll1, const CompactLatLong& ll2) noexcept
+{
+  return v2::haversine_impl(ll1, ll2);
+}
+
 double distance2d(const LatLong& ll1, const LatLong& ll2) noexcept
 {
   return v2::haversine(ll1, ll2);
 }
 
+double distance2d(const CompactLatLong& ll1, const CompactLatLong& ll2) noexcept
+{
+  return v2::haversine(ll1, ll2);
+}
+
 double distance3d(const LatLong& ll1, const LatLong& ll2) noexcept
 {
-  const auto distance = v2::haversine(ll1, ll2);
+  return v2::distance3d_impl(ll1, ll2);
+}
 
-  const auto elevation_diff = ll1.elevation - ll2.elevation;
-  return std::sqrt((distance * distance) + (elevation_diff * elevation_diff));
+double distance3d(const CompactLatLong& ll1, const CompactLatLong& ll2) noexcept
+{
+  return v2::distance3d_impl(ll1, ll2);
+}
+
+double length2d(std::span<const double> latitudes, std::span<const double> longitudes) noexcept
+{
+  return v2::length_impl(latitudes, longitudes, {},
+                         [](const double distance, double) { return distance; });
+}
+
+double length3d(std::span<const double> latitudes, std::span<const double> longitudes,
+                std::span<const double> elevations) noexcept
+{
+  assert(elevations.size() == latitudes.size());
+  return v2::length_impl(latitudes, longitudes, elevations,
+                         [](const double distance, const double elevation_diff) {
+                           return std::sqrt((distance * distance) +
+                                            (elevation_diff * elevation_diff));
+                         });
 }
 } // namespace v2
 
+LatLong interpolate_linear(const LatLong& ll1, const LatLong& ll2, const double fraction) noexcept
+{
+  return LatLong{
+      ll1.latitude + (ll2.latitude - ll1.latitude) * fraction,
+      ll1.longitude + (ll2.longitude - ll1.longitude) * fraction,
+      ll1.elevation + (ll2.elevation - ll1.elevation) * fraction,
+  };
+}
+
+LatLong interpolate_great_circle(const LatLong& ll1, const LatLong& ll2,
+                                 const double fraction) noexcept
+{
+  constexpr double kDegrees = 180.0 / std::numbers::pi;
+  const auto to_vector = [](const LatLong& ll) {
+    const double latitude = ll.latitude / kDegrees;
+    const double longitude = ll.longitude / kDegrees;
+    return std::array{std::cos(latitude) * std::cos(longitude),
+                      std::cos(latitude) * std::sin(longitude), std::sin(latitude)};
+  };
+  const auto v1 = to_vector(ll1);
+  const auto v2 = to_vector(ll2);
+
+  // Angle between the points, stable for nearby points unlike `acos`.
+  const std::array cross{v1[1] * v2[2] - v1[2] * v2[1], v1[2] * v2[0] - v1[0] * v2[2],
+                         v1[0] * v2[1] - v1[1] * v2[0]};
+  const double dot = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+  const double angle = std::atan2(std::hypot(cross[0], cross[1], cross[2]), dot);
+  if (angle < 1e-12)
+  {
+    return interpolate_linear(ll1, ll2, fraction);
+  }
+
+  const double a = std::sin((1.0 - fraction) * angle) / std::sin(angle);
+  const double b = std::sin(fraction * angle) / std::sin(angle);
+  const double x = a * v1[0] + b * v2[0];
+  const double y = a * v1[1] + b * v2[1];
+  const double z = a * v1[2] + b * v2[2];
+  return LatLong{
+      std::atan2(z, std::hypot(x, y)) * kDegrees,
+      std::atan2(y, x) * kDegrees,
+      ll1.elevation + (ll2.elevation - ll1.elevation) * fraction,
+  };
+}
+
 } // namespace fastgpx
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <span>
+
 namespace fastgpx {
 struct LatLong;
+struct CompactLatLong;
 
 /**
  * @brief Geometry logic matching gpxpy.
@@ -17,6 +20,7 @@ namespace v1 {
  * @return double Meters.
  */
 double haversine(const LatLong& ll1, const LatLong& ll2) noexcept;
+double haversine(const CompactLatLong& ll1, const CompactLatLong& ll2) noexcept;
 
 /**
  * @brief Computes the distance in 2d between two point using gpxpy logic.
@@ -29,6 +33,8 @@ double haversine(const LatLong& ll1, const LatLong& ll2) noexcept;
  * @return double Meters
  */
 double distance2d(const LatLong& ll1, const LatLong& ll2, bool use_haversine = false) noexcept;
+double distance2d(const CompactLatLong& ll1, const CompactLatLong& ll2,
+                  bool use_haversine = false) noexcept;
 
 /**
  * @brief Computes the distance in 3d between two point using gpxpy logic.
@@ -41,6 +47,8 @@ double distance2d(const LatLong& ll1, const LatLong& ll2, bool use_haversine = f
  * @return double Meters
  */
 double distance3d(const LatLong& ll1, const LatLong& ll2, bool use_haversine = false) noexcept;
+double distance3d(const CompactLatLong& ll1, const CompactLatLong& ll2,
+                  bool use_haversine = false) noexcept;
 } // namespace v1
 
 /**
@@ -58,6 +66,7 @@ namespace v2 {
  * @return double Meters.
  */
 double haversine(const LatLong& ll1, const LatLong& ll2) noexcept;
+double haversine(const CompactLatLong& ll1, const CompactLatLong& ll2) noexcept;
 
 /**
  * @brief Computes the distance in 2d between two point using gpxpy logic.
@@ -67,6 +76,7 @@ double haversine(const LatLong& ll1, const LatLong& ll2) noexcept;
  * @return double Meters
  */
 double distance2d(const LatLong& ll1, const LatLong& ll2) noexcept;
+double distance2d(const CompactLatLong& ll1, const CompactLatLong& ll2) noexcept;
 
 /**
  * @brief Computes the distance in 3d between two point using gpxpy logic.
@@ -76,11 +86,56 @@ double distance2d(const LatLong& ll1, const LatLong& ll2) noexcept;
  * @return double Meters
  */
 double distance3d(const LatLong& ll1, const LatLong& ll2) noexcept;
+double distance3d(const CompactLatLong& ll1, const CompactLatLong& ll2) noexcept;
+
+/**
+ * @brief Sum of `distance2d` between consecutive points, given as columns of
+ *   the same length.
+ *
+ * @param latitudes
+ * @param longitudes
+ * @return double Meters
+ */
+double length2d(std::span<const double> latitudes, std::span<const double> longitudes) noexcept;
+
+/**
+ * @brief Sum of `distance3d` between consecutive points, given as columns of
+ *   the same length.
+ *
+ * @param latitudes
+ * @param longitudes
+ * @param elevations
+ * @return double Meters
+ */
+double length3d(std::span<const double> latitudes, std::span<const double> longitudes,
+                std::span<const double> elevations) noexcept;
 
 } // namespace v2
 
 using v2::distance2d;
 using v2::distance3d;
 using v2::haversine;
+using v2::length2d;
+using v2::length3d;
+
+/**
+ * @brief Location at `fraction` of the way from `ll1` to `ll2`, linear in
+ *   latitude, longitude and elevation.
+ *
+ * @param ll1
+ * @param ll2
+ * @param fraction 0 for `ll1` and 1 for `ll2`.
+ */
+LatLong interpolate_linear(const LatLong& ll1, const LatLong& ll2, double fraction) noexcept;
+
+/**
+ * @brief Location at `fraction` of the way from `ll1` to `ll2` along the great
+ *   circle between them. The elevation is interpolated linearly.
+ *
+ * @param ll1
+ * @param ll2
+ * @param fraction 0 for `ll1` and 1 for `ll2`.
+ */
+LatLong interpolate_great_circle(const LatLong& ll1, const LatLong& ll2, double fraction) noexcept;
 
 } // namespace fastgpx
@@ -1,5 +1,4 @@
 #include <filesystem>
-#include <functional>
 #include <numeric>
 #include <ranges>
 #include <string>
@@ -20,17 +19,18 @@ using Catch::Matchers::WithinAbs;
 
 const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
 
-using GpxLengthFunc = const std::function<double(const fastgpx::LatLong&, const fastgpx::LatLong&)>;
-static double GpxLength(const fastgpx::Gpx& gpx, const GpxLengthFunc& func)
+// A function pointer rather than std::function, to select the `LatLong` overloads.
+using GpxLengthFunc = double (*)(const fastgpx::LatLong&, const fastgpx::LatLong&);
+static double GpxLength(const fastgpx::Gpx& gpx, const GpxLengthFunc func)
 {
   double distance = 0.0;
   for (const auto& track : gpx.tracks)
   {
     for (const auto& segment : track.segments)
     {
-      const auto& points = segment.points;
+      const auto points = segment.points();
       auto distances = std::views::zip(points, points | std::views::drop(1)) |
-                       std::views::transform([&func](const auto& pair) {
+                       std::views::transform([func](const auto& pair) {
                          return func(std::get<0>(pair), std::get<1>(pair));
                        });
       distance += std::accumulate(distances.begin(), distances.end(), 0.0);
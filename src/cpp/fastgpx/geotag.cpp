@@ -0,0 +1,229 @@
+#include "fastgpx/geotag.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "fastgpx/geom.hpp"
+#include "fastgpx/parallel.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+using rep = TimeIndex::rep;
+
+// Times per block of the sweep, which the threads take turns on.
+constexpr size_t kBlockSize = 16 * 1024;
+
+// Time span of a segment with times.
+struct Interval
+{
+  rep start = 0;
+  rep end = 0;
+  size_t document = 0;
+  size_t track = 0;
+  size_t segment = 0;
+  const PointColumns* columns = nullptr;
+  const TimeIndex* index = nullptr;
+};
+
+// Interval reaching the times of a sweep, with the lower bound of the current
+// time in its index.
+struct Active
+{
+  const Interval* interval = nullptr;
+  size_t position = 0;
+};
+
+struct Candidate
+{
+  LatLong location;
+  // Time to the closest point the location is taken from.
+  rep distance = 0;
+};
+
+// Location at `tick` in the segment of `active`, whose position is the lower
+// bound of `tick`.
+std::optional<Candidate> Locate(const Active& active, const rep tick, const GeotagOptions& options)
+{
+  const auto& index = *active.interval->index;
+  const auto& columns = *active.interval->columns;
+  const auto ticks = index.ticks();
+  const auto point = [&](const size_t i) { return columns[index.points()[i]]; };
+  const size_t position = active.position;
+  if (position < ticks.size() && ticks[position] == tick)
+  {
+    return Candidate{point(position), 0};
+  }
+
+  const std::optional<rep> max_gap =
+      options.max_gap ? std::optional(options.max_gap->count()) : std::nullopt;
+  // Before the first or after the last point of the segment.
+  if (position == 0 || position == ticks.size())
+  {
+    const size_t end = position == 0 ? 0 : position - 1;
+    const rep distance = position == 0 ? ticks[end] - tick : tick - ticks[end];
+    if (!max_gap || distance > *max_gap)
+    {
+      return std::nullopt;
+    }
+    return Candidate{point(end), distance};
+  }
+
+  const rep before = ticks[position - 1];
+  const rep after = ticks[position];
+  if (max_gap && after - before > *max_gap)
+  {
+    return std::nullopt;
+  }
+  const double fraction =
+      static_cast<double>(tick - before) / static_cast<double>(after - before);
+  const rep distance = std::min(tick - before, after - tick);
+  if (options.interpolation == Interpolation::GreatCircle)
+  {
+    return Candidate{interpolate_great_circle(point(position - 1), point(position), fraction),
+                     distance};
+  }
+  return Candidate{interpolate_linear(point(position - 1), point(position), fraction), distance};
+}
+
+// Matches the times at `order`, sorted by time, against `intervals`, sorted by
+// start. The active intervals are found from scratch for the first time, such
+// that blocks can be swept independently.
+void Sweep(std::span<const Interval> intervals, std::span<const size_t> order,
+           std::span<const std::chrono::system_clock::time_point> times,
+           const GeotagOptions& options, GeotagResult& result)
+{
+  const rep reach = options.max_gap ? options.max_gap->count() : 0;
+  const auto rank = [](const Interval& interval, const Candidate& candidate) {
+    return std::tuple(candidate.distance, interval.document, interval.track, interval.segment);
+  };
+  std::vector<Active> active;
+  size_t next = 0;
+  for (const size_t i : order)
+  {
+    const rep tick = times[i].time_since_epoch().count();
+    while (next < intervals.size() && intervals[next].start - reach <= tick)
+    {
+      const Interval& interval = intervals[next++];
+      if (interval.end + reach >= tick)
+      {
+        active.push_back({&interval, interval.index->LowerBound(times[i])});
+      }
+    }
+    std::erase_if(active, [&](const Active& a) { return a.interval->end + reach < tick; });
+
+    std::optional<Candidate> best;
+    const Interval* best_interval = nullptr;
+    for (auto& a : active)
+    {
+      const auto ticks = a.interval->index->ticks();
+      while (a.position < ticks.size() && ticks[a.position] < tick)
+      {
+        ++a.position;
+      }
+      const auto candidate = Locate(a, tick, options);
+      if (!candidate)
+      {
+        continue;
+      }
+      if (!best || rank(*a.interval, *candidate) < rank(*best_interval, *best))
+      {
+        best = candidate;
+        best_interval = a.interval;
+      }
+    }
+
+    if (best)
+    {
+      result.latitude[i] = best->location.latitude;
+      result.longitude[i] = best->location.longitude;
+      result.elevation[i] = best->location.elevation;
+      result.document[i] = static_cast<int64_t>(best_interval->document);
+      result.track[i] = static_cast<int64_t>(best_interval->track);
+      result.segment[i] = static_cast<int64_t>(best_interval->segment);
+    }
+  }
+}
+
+} // namespace
+
+GeotagResult::GeotagResult(const size_t size)
+    : latitude(size, std::numeric_limits<double>::quiet_NaN()),
+      longitude(size, std::numeric_limits<double>::quiet_NaN()),
+      elevation(size, std::numeric_limits<double>::quiet_NaN()), document(size, kNoMatch),
+      track(size, kNoMatch), segment(size, kNoMatch)
+{
+}
+
+GeotagResult Geotag(std::span<const std::chrono::system_clock::time_point> times,
+                    std::span<const Gpx* const> documents, const GeotagOptions& options)
+{
+  std::vector<Interval> intervals;
+  for (size_t d = 0; d < documents.size(); ++d)
+  {
+    const auto& tracks = documents[d]->tracks;
+    for (size_t t = 0; t < tracks.size(); ++t)
+    {
+      const auto& segments = tracks[t].segments;
+      for (size_t s = 0; s < segments.size(); ++s)
+      {
+        intervals.push_back({.document = d, .track = t, .segment = s});
+      }
+    }
+  }
+
+  // Parsing the times of the points dominates for small batches of times.
+  ParallelFor(intervals.size(), options.threads, [&](const size_t i) {
+    auto& interval = intervals[i];
+    const auto& segment =
+        documents[interval.document]->tracks[interval.track].segments[interval.segment];
+    interval.columns = &segment.columns;
+    interval.index = &segment.GetTimeIndex();
+    if (!interval.index->empty())
+    {
+      interval.start = interval.index->ticks().front();
+      interval.end = interval.index->ticks().back();
+    }
+  });
+  std::erase_if(intervals, [](const Interval& interval) { return interval.index->empty(); });
+  std::ranges::stable_sort(intervals, {}, &Interval::start);
+
+  std::vector<size_t> order(times.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  if (!std::ranges::is_sorted(times))
+  {
+    std::ranges::stable_sort(order, {}, [&](const size_t i) { return times[i]; });
+  }
+
+  GeotagResult result(times.size());
+  const size_t block_count = (order.size() + kBlockSize - 1) / kBlockSize;
+  ParallelFor(block_count, options.threads, [&](const size_t block) {
+    const size_t first = block * kBlockSize;
+    const auto block_order =
+        std::span<const size_t>(order).subspan(first, std::min(kBlockSize, order.size() - first));
+    Sweep(intervals, block_order, times, options, result);
+  });
+  return result;
+}
+
+GeotagResult Geotag(std::span<const std::chrono::system_clock::time_point> times,
+                    std::span<const Gpx> documents, const GeotagOptions& options)
+{
+  std::vector<const Gpx*> pointers;
+  pointers.reserve(documents.size());
+  for (const auto& gpx : documents)
+  {
+    pointers.push_back(&gpx);
+  }
+  return Geotag(times, pointers, options);
+}
+
+} // namespace fastgpx
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+struct GeotagOptions
+{
+  // Longest time between the two points a location is interpolated between.
+  // Times in longer gaps, such as while the receiver had no fix, are not
+  // matched. Times this close before the first or after the last point of a
+  // segment take the location of that point. No limit, and no matches outside
+  // of the segments, if empty.
+  std::optional<std::chrono::system_clock::duration> max_gap = std::nullopt;
+  Interpolation interpolation = Interpolation::Linear;
+  // Number of threads, or 0 for one per hardware thread.
+  size_t threads = 1;
+};
+
+// Locations matched to times by `Geotag`, one element of each column per time.
+struct GeotagResult
+{
+  // Index of a time without a match.
+  static constexpr int64_t kNoMatch = -1;
+
+  // Degrees and meters, NaN for the times without a match.
+  std::vector<double> latitude;
+  std::vector<double> longitude;
+  std::vector<double> elevation;
+  // Indices of the segment each time was matched to, or `kNoMatch`.
+  std::vector<int64_t> document;
+  std::vector<int64_t> track;
+  std::vector<int64_t> segment;
+
+  GeotagResult() = default;
+  // `size` times without a match.
+  explicit GeotagResult(size_t size);
+
+  size_t size() const noexcept { return latitude.size(); }
+  bool matched(size_t index) const noexcept { return document[index] != kNoMatch; }
+};
+
+/**
+ * @brief Finds the location at each of `times` in the segments of `documents`.
+ *
+ * The times are sorted once and swept over the time spans of all segments,
+ * interpolating within each overlapping segment from the point at a cursor
+ * that only moves forward. Where the spans of segments overlap, such as for
+ * two devices recording the same trip, the segment with a point closest in
+ * time wins, then the first in the order of documents, tracks and segments.
+ *
+ * @throws parse_error if a time of a point is invalid.
+ * @param times Any order. Photo capture times must be in UTC, like GPX times.
+ * @param documents The result refers to them by their index in this list.
+ * @param options
+ */
+GeotagResult Geotag(std::span<const std::chrono::system_clock::time_point> times,
+                    std::span<const Gpx* const> documents, const GeotagOptions& options = {});
+GeotagResult Geotag(std::span<const std::chrono::system_clock::time_point> times,
+                    std::span<const Gpx> documents, const GeotagOptions& options = {});
+
+} // namespace fastgpx
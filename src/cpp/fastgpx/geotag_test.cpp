@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "fastgpx/batch.hpp"
+#include "fastgpx/fastgpx.hpp"
+#include "fastgpx/geotag.hpp"
+
+using Catch::Generators::as;
+using Catch::Matchers::WithinAbs;
+
+using namespace fastgpx;
+using namespace std::chrono_literals;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+namespace {
+
+using time_point = std::chrono::system_clock::time_point;
+
+const time_point kStart = std::chrono::sys_days{2024y / 5 / 18} + 8h;
+
+std::vector<Gpx> LoadTopCamp()
+{
+  const auto directory = project_path / "gpx/2024 TopCamp";
+  return LoadGpxFiles(std::vector<std::filesystem::path>{
+      directory / "Connected_20240518_094959_.gpx",
+      directory / "Connected_20240519_092555_Gamla_torget_1_68530_Torsby_Sweden.gpx",
+      directory / "Connected_20240527_102505_Gol.gpx",
+  });
+}
+
+// Document with one segment per list of `(offset from kStart, latitude)`.
+Gpx MakeGpx(const std::vector<std::vector<std::pair<std::chrono::seconds, double>>>& segments)
+{
+  Gpx gpx;
+  auto& track = gpx.tracks.emplace_back();
+  for (const auto& points : segments)
+  {
+    auto& segment = track.segments.emplace_back();
+    for (const auto& [offset, latitude] : points)
+    {
+      segment.columns.push_back({latitude, 10.0, 0.0}, kStart + offset);
+    }
+  }
+  return gpx;
+}
+
+} // namespace
+
+TEST_CASE("Geotag matches times to the segments of many documents", "[geotag]")
+{
+  const auto documents = LoadTopCamp();
+  const size_t threads = GENERATE(as<size_t>{}, 1, 0);
+  CAPTURE(threads);
+
+  // Points, times between them and times outside of all documents, shuffled.
+  std::vector<time_point> times;
+  for (const auto& gpx : documents)
+  {
+    const auto& segment = gpx.tracks[0].segments[0];
+    const auto& bounds = segment.GetTimeBounds();
+    for (auto time = *bounds.start_time; time <= *bounds.end_time; time += 13s)
+    {
+      times.push_back(time);
+    }
+  }
+  times.push_back(*documents[0].GetTimeBounds().start_time - 1h);
+  times.push_back(*documents[2].GetTimeBounds().end_time + 1h);
+  std::ranges::shuffle(times, std::mt19937(42));
+
+  const auto result = Geotag(times, documents, {.threads = threads});
+  REQUIRE(result.size() == times.size());
+  size_t matched = 0;
+  for (size_t i = 0; i < times.size(); ++i)
+  {
+    CAPTURE(i);
+    if (!result.matched(i))
+    {
+      CHECK(std::isnan(result.latitude[i]));
+      CHECK(result.track[i] == GeotagResult::kNoMatch);
+      continue;
+    }
+    matched++;
+    REQUIRE(result.document[i] >= 0);
+    const auto& segment = documents[static_cast<size_t>(result.document[i])]
+                              .tracks[static_cast<size_t>(result.track[i])]
+                              .segments[static_cast<size_t>(result.segment[i])];
+    const auto expected = segment.GetLocationAt(times[i]);
+    REQUIRE(expected.has_value());
+    CHECK(result.latitude[i] == expected->latitude);
+    CHECK(result.longitude[i] == expected->longitude);
+    CHECK(result.elevation[i] == expected->elevation);
+  }
+  CHECK(matched == times.size() - 2);
+}
+
+TEST_CASE("Geotag skips gaps longer than the maximum", "[geotag]")
+{
+  // A gap of 10 minutes between the last two points.
+  const auto gpx = MakeGpx({{{0s, 60.0}, {10s, 60.1}, {610s, 60.2}}});
+  const std::vector<time_point> times{
+      kStart - 30s, kStart + 5s, kStart + 310s, kStart + 640s, kStart + 700s,
+  };
+
+  const auto any_gap = Geotag(times, std::span(&gpx, 1));
+  CHECK(any_gap.matched(1));
+  CHECK(any_gap.matched(2));
+  CHECK_THAT(any_gap.latitude[2], WithinAbs(60.15, 1e-9));
+  // Nothing outside of the segment without a maximum gap.
+  CHECK_FALSE(any_gap.matched(0));
+  CHECK_FALSE(any_gap.matched(3));
+
+  const auto result = Geotag(times, std::span(&gpx, 1), {.max_gap = 60s});
+  CHECK(result.matched(0));
+  CHECK(result.latitude[0] == 60.0);
+  CHECK_THAT(result.latitude[1], WithinAbs(60.05, 1e-9));
+  CHECK_FALSE(result.matched(2));
+  CHECK(result.matched(3));
+  CHECK(result.latitude[3] == 60.2);
+  CHECK_FALSE(result.matched(4));
+}
+
+TEST_CASE("Geotag prefers the segment with the closest point", "[geotag]")
+{
+  const std::vector<Gpx> documents{
+      MakeGpx({{{0s, 60.0}, {100s, 61.0}}, {{200s, 62.0}, {300s, 63.0}}}),
+      MakeGpx({{{40s, 50.0}, {60s, 51.0}}}),
+      MakeGpx({{{0s, 40.0}, {100s, 41.0}}}),
+  };
+  const std::vector<time_point> times{
+      kStart + 10s, kStart + 50s, kStart + 150s, kStart + 250s, kStart + 100s,
+  };
+
+  const auto result = Geotag(times, documents, {.max_gap = 120s});
+  // Equally close points, so the first document wins.
+  CHECK(result.document[0] == 0);
+  CHECK(result.document[1] == 1);
+  // Between the segments of the first document, equally close to both.
+  CHECK(result.document[2] == 0);
+  CHECK(result.segment[2] == 0);
+  CHECK(result.latitude[2] == 61.0);
+  CHECK(result.document[3] == 0);
+  CHECK(result.segment[3] == 1);
+  CHECK(result.document[4] == 0);
+  CHECK(result.latitude[4] == 61.0);
+}
+
+TEST_CASE("Geotag without documents or times", "[geotag]")
+{
+  const std::vector<time_point> times{kStart};
+  const auto result = Geotag(times, std::vector<Gpx>{Gpx{}});
+  REQUIRE(result.size() == 1);
+  CHECK_FALSE(result.matched(0));
+  CHECK(Geotag({}, LoadTopCamp()).size() == 0);
+}
+
+TEST_CASE("Benchmark geotag", "[!benchmark][geotag]")
+{
+  const auto documents = LoadTopCamp();
+  const auto& bounds = documents[0].GetTimeBounds();
+  std::vector<time_point> times;
+  std::mt19937 random(42);
+  std::uniform_int_distribution<time_point::rep> distribution(
+      bounds.start_time->time_since_epoch().count(), bounds.end_time->time_since_epoch().count());
+  for (int i = 0; i < 1'000'000; ++i)
+  {
+    times.push_back(time_point(time_point::duration(distribution(random))));
+  }
+
+  BENCHMARK("Geotag")
+  {
+    return Geotag(times, documents);
+  };
+
+  BENCHMARK("Geotag on all threads")
+  {
+    return Geotag(times, documents, {.threads = 0});
+  };
+}
@@ -0,0 +1,471 @@
+#include "fastgpx/inflate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "fastgpx/errors.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+// Maximum distance of back-references.
+constexpr size_t kWindowSize = 32 * 1024;
+
+constexpr size_t kMaxLiteralCodes = 286;
+constexpr size_t kMaxDistanceCodes = 30;
+constexpr size_t kFixedLiteralCodes = 288;
+constexpr size_t kEndOfBlock = 256;
+constexpr size_t kMaxMatchLength = 258;
+
+constexpr std::array<uint16_t, 29> kLengthBase = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+constexpr std::array<uint8_t, 29> kLengthExtraBits = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+constexpr std::array<uint16_t, 30> kDistanceBase = {
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+constexpr std::array<uint8_t, 30> kDistanceExtraBits = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+// Order in which the code length code lengths of dynamic blocks are stored.
+constexpr std::array<uint8_t, 19> kCodeLengthOrder = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+};
+
+// Slicing-by-8 tables of the reflected CRC-32 polynomial. `kCrc32Tables[0]` is
+// the classic byte-wise table, the others advance the CRC by further bytes.
+constexpr std::array<std::array<uint32_t, 256>, 8> kCrc32Tables = [] {
+  std::array<std::array<uint32_t, 256>, 8> tables{};
+  for (uint32_t i = 0; i < 256; ++i)
+  {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit)
+    {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+    }
+    tables[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; ++i)
+  {
+    for (size_t t = 1; t < tables.size(); ++t)
+    {
+      const uint32_t previous = tables[t - 1][i];
+      tables[t][i] = tables[0][previous & 0xFF] ^ (previous >> 8);
+    }
+  }
+  return tables;
+}();
+
+uint32_t ReverseBits(uint32_t code, const size_t length)
+{
+  uint32_t reversed = 0;
+  for (size_t i = 0; i < length; ++i)
+  {
+    reversed = (reversed << 1) | (code & 1);
+    code >>= 1;
+  }
+  return reversed;
+}
+
+[[noreturn]] void ThrowInvalid(const char* reason)
+{
+  throw parse_error(std::string("Invalid DEFLATE data: ") + reason);
+}
+
+} // namespace
+
+uint32_t Crc32(std::string_view data, uint32_t crc) noexcept
+{
+  const auto& t = kCrc32Tables;
+  const auto byte = [&](size_t index) { return static_cast<unsigned char>(data[index]); };
+
+  crc = ~crc;
+  size_t i = 0;
+  for (; i + 8 <= data.size(); i += 8)
+  {
+    const uint32_t low = crc ^ (uint32_t{byte(i)} | uint32_t{byte(i + 1)} << 8 |
+                                uint32_t{byte(i + 2)} << 16 | uint32_t{byte(i + 3)} << 24);
+    crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^
+          t[4][low >> 24] ^ t[3][byte(i + 4)] ^ t[2][byte(i + 5)] ^ t[1][byte(i + 6)] ^
+          t[0][byte(i + 7)];
+  }
+  for (; i < data.size(); ++i)
+  {
+    crc = t[0][(crc ^ byte(i)) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+void Inflater::HuffmanCode::Build(const uint8_t* lengths, const size_t count)
+{
+  counts.fill(0);
+  fast.fill(0);
+  for (size_t symbol = 0; symbol < count; ++symbol)
+  {
+    counts[lengths[symbol]]++;
+  }
+  counts[0] = 0;
+
+  // Incomplete codes are allowed, such as a single distance code. Decoding an
+  // unused code fails instead.
+  int left = 1;
+  for (size_t length = 1; length <= kMaxBits; ++length)
+  {
+    left = (left << 1) - counts[length];
+    if (left < 0)
+    {
+      ThrowInvalid("over-subscribed Huffman code");
+    }
+  }
+
+  std::array<uint16_t, kMaxBits + 1> offsets{};
+  for (size_t length = 1; length < kMaxBits; ++length)
+  {
+    offsets[length + 1] = static_cast<uint16_t>(offsets[length] + counts[length]);
+  }
+  for (size_t symbol = 0; symbol < count; ++symbol)
+  {
+    if (lengths[symbol] != 0)
+    {
+      symbols[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+    }
+  }
+
+  // The codes are packed starting with their most significant bit, so the
+  // table is indexed by the reversed code.
+  uint32_t code = 0;
+  size_t index = 0;
+  for (size_t length = 1; length <= kFastBits; ++length)
+  {
+    for (size_t i = 0; i < counts[length]; ++i, ++code, ++index)
+    {
+      const auto entry = static_cast<uint16_t>((symbols[index] << 4) | length);
+      for (uint32_t slot = ReverseBits(code, length); slot < fast.size(); slot += 1u << length)
+      {
+        fast[slot] = entry;
+      }
+    }
+    code <<= 1;
+  }
+}
+
+Inflater::Inflater(std::string_view data) : data_(data) {}
+
+size_t Inflater::Read(char* buffer, const size_t size)
+{
+  if (end_ - read_pos_ < size)
+  {
+    // Discard the output that is both read and too far back to be referred to.
+    const size_t history = end_ > kWindowSize ? end_ - kWindowSize : 0;
+    const size_t discard = std::min(read_pos_, history);
+    if (discard >= kWindowSize)
+    {
+      std::memmove(output_.data(), output_.data() + discard, end_ - discard);
+      end_ -= discard;
+      read_pos_ -= discard;
+    }
+    Decode(read_pos_ + size);
+  }
+
+  const size_t count = std::min(size, end_ - read_pos_);
+  std::memcpy(buffer, output_.data() + read_pos_, count);
+  read_pos_ += count;
+  return count;
+}
+
+void Inflater::Decode(const size_t target)
+{
+  // Room for a match that starts just before the target.
+  if (output_.size() < target + kMaxMatchLength)
+  {
+    output_.resize(target + kMaxMatchLength);
+  }
+  while (end_ < target && state_ != State::Done)
+  {
+    switch (state_)
+    {
+    case State::BlockHeader:
+      ReadBlockHeader();
+      break;
+    case State::Stored:
+      ReadStored(target);
+      break;
+    case State::Huffman:
+      ReadHuffman(target);
+      break;
+    case State::Done:
+      break;
+    }
+  }
+}
+
+void Inflater::ReadBlockHeader()
+{
+  last_block_ = Bits(1) != 0;
+  switch (Bits(2))
+  {
+  case 0:
+  {
+    // Stored blocks start at a byte boundary. The whole bytes left in the bit
+    // buffer are handed back to the input.
+    Bits(bit_count_ % 8);
+    pos_ -= bit_count_ / 8;
+    bit_buffer_ = 0;
+    bit_count_ = 0;
+
+    if (data_.size() - pos_ < 4)
+    {
+      ThrowInvalid("unexpected end of data");
+    }
+    const auto byte = [&](size_t offset) {
+      return static_cast<size_t>(static_cast<unsigned char>(data_[pos_ + offset]));
+    };
+    const size_t length = byte(0) | (byte(1) << 8);
+    const size_t inverted_length = byte(2) | (byte(3) << 8);
+    if (length != (~inverted_length & 0xFFFF))
+    {
+      ThrowInvalid("stored block length mismatch");
+    }
+    pos_ += 4;
+    stored_remaining_ = length;
+    state_ = State::Stored;
+    break;
+  }
+  case 1:
+    ReadFixedCodes();
+    state_ = State::Huffman;
+    break;
+  case 2:
+    ReadDynamicCodes();
+    state_ = State::Huffman;
+    break;
+  default:
+    ThrowInvalid("invalid block type");
+  }
+}
+
+void Inflater::ReadStored(const size_t target)
+{
+  const size_t count = std::min(stored_remaining_, target - end_);
+  if (data_.size() - pos_ < count)
+  {
+    ThrowInvalid("unexpected end of data");
+  }
+  std::memcpy(output_.data() + end_, data_.data() + pos_, count);
+  end_ += count;
+  pos_ += count;
+  stored_remaining_ -= count;
+  if (stored_remaining_ == 0)
+  {
+    state_ = last_block_ ? State::Done : State::BlockHeader;
+  }
+}
+
+void Inflater::ReadHuffman(const size_t target)
+{
+  char* const output = output_.data();
+  while (end_ < target)
+  {
+    const int symbol = DecodeSymbol(literals_);
+    if (symbol < static_cast<int>(kEndOfBlock))
+    {
+      output[end_++] = static_cast<char>(symbol);
+      continue;
+    }
+    if (symbol == static_cast<int>(kEndOfBlock))
+    {
+      state_ = last_block_ ? State::Done : State::BlockHeader;
+      return;
+    }
+
+    const auto length_index = static_cast<size_t>(symbol) - kEndOfBlock - 1;
+    if (length_index >= kLengthBase.size())
+    {
+      ThrowInvalid("invalid length code");
+    }
+    const size_t length = kLengthBase[length_index] + Bits(kLengthExtraBits[length_index]);
+
+    const auto distance_index = static_cast<size_t>(DecodeSymbol(distances_));
+    if (distance_index >= kDistanceBase.size())
+    {
+      ThrowInvalid("invalid distance code");
+    }
+    const size_t distance =
+        kDistanceBase[distance_index] + Bits(kDistanceExtraBits[distance_index]);
+    if (distance > end_)
+    {
+      ThrowInvalid("distance too far back");
+    }
+
+    const char* source = output + end_ - distance;
+    char* destination = output + end_;
+    if (distance >= length)
+    {
+      std::memcpy(destination, source, length);
+    }
+    else
+    {
+      // The match overlaps the bytes being written, repeating the last
+      // `distance` bytes.
+      for (size_t i = 0; i < length; ++i)
+      {
+        destination[i] = source[i];
+      }
+    }
+    end_ += length;
+  }
+}
+
+void Inflater::ReadDynamicCodes()
+{
+  const size_t literal_count = Bits(5) + 257;
+  const size_t distance_count = Bits(5) + 1;
+  const size_t code_length_count = Bits(4) + 4;
+  if (literal_count > kMaxLiteralCodes || distance_count > kMaxDistanceCodes)
+  {
+    ThrowInvalid("too many length or distance codes");
+  }
+
+  std::array<uint8_t, kCodeLengthOrder.size()> code_lengths{};
+  for (size_t i = 0; i < code_length_count; ++i)
+  {
+    code_lengths[kCodeLengthOrder[i]] = static_cast<uint8_t>(Bits(3));
+  }
+  HuffmanCode code_length_code;
+  code_length_code.Build(code_lengths.data(), code_lengths.size());
+
+  std::array<uint8_t, kMaxLiteralCodes + kMaxDistanceCodes> lengths{};
+  const size_t total = literal_count + distance_count;
+  size_t index = 0;
+  while (index < total)
+  {
+    const int symbol = DecodeSymbol(code_length_code);
+    if (symbol < 16)
+    {
+      lengths[index++] = static_cast<uint8_t>(symbol);
+      continue;
+    }
+
+    uint8_t value = 0;
+    size_t repeat = 0;
+    if (symbol == 16)
+    {
+      if (index == 0)
+      {
+        ThrowInvalid("repeated length with no first length");
+      }
+      value = lengths[index - 1];
+      repeat = 3 + Bits(2);
+    }
+    else if (symbol == 17)
+    {
+      repeat = 3 + Bits(3);
+    }
+    else
+    {
+      repeat = 11 + Bits(7);
+    }
+    if (index + repeat > total)
+    {
+      ThrowInvalid("too many code lengths");
+    }
+    std::fill_n(lengths.begin() + static_cast<std::ptrdiff_t>(index), repeat, value);
+    index += repeat;
+  }
+
+  if (lengths[kEndOfBlock] == 0)
+  {
+    ThrowInvalid("missing end-of-block code");
+  }
+  literals_.Build(lengths.data(), literal_count);
+  distances_.Build(lengths.data() + literal_count, distance_count);
+}
+
+void Inflater::ReadFixedCodes()
+{
+  std::array<uint8_t, kFixedLiteralCodes> lengths{};
+  std::fill(lengths.begin(), lengths.begin() + 144, uint8_t{8});
+  std::fill(lengths.begin() + 144, lengths.begin() + 256, uint8_t{9});
+  std::fill(lengths.begin() + 256, lengths.begin() + 280, uint8_t{7});
+  std::fill(lengths.begin() + 280, lengths.end(), uint8_t{8});
+  literals_.Build(lengths.data(), lengths.size());
+
+  std::array<uint8_t, kMaxDistanceCodes> distance_lengths{};
+  distance_lengths.fill(5);
+  distances_.Build(distance_lengths.data(), distance_lengths.size());
+}
+
+int Inflater::DecodeSymbol(const HuffmanCode& code)
+{
+  if (bit_count_ < HuffmanCode::kMaxBits)
+  {
+    Refill();
+  }
+  const uint16_t entry = code.fast[bit_buffer_ & (code.fast.size() - 1)];
+  if (entry != 0)
+  {
+    const size_t length = entry & 0xFu;
+    if (length > bit_count_)
+    {
+      ThrowInvalid("unexpected end of data");
+    }
+    bit_buffer_ >>= length;
+    bit_count_ -= length;
+    return entry >> 4;
+  }
+
+  // Codes longer than the lookup table, decoded one bit at a time.
+  int value = 0;
+  int first = 0;
+  int index = 0;
+  for (size_t length = 1; length <= HuffmanCode::kMaxBits; ++length)
+  {
+    value |= static_cast<int>(Bits(1));
+    const int count = code.counts[length];
+    if (value - count < first)
+    {
+      return code.symbols[static_cast<size_t>(index + (value - first))];
+    }
+    index += count;
+    first = (first + count) << 1;
+    value <<= 1;
+  }
+  ThrowInvalid("invalid Huffman code");
+}
+
+void Inflater::Refill() noexcept
+{
+  while (bit_count_ <= 56 && pos_ < data_.size())
+  {
+    bit_buffer_ |= uint64_t{static_cast<unsigned char>(data_[pos_++])} << bit_count_;
+    bit_count_ += 8;
+  }
+}
+
+uint32_t Inflater::Bits(const size_t count)
+{
+  if (bit_count_ < count)
+  {
+    Refill();
+    if (bit_count_ < count)
+    {
+      ThrowInvalid("unexpected end of data");
+    }
+  }
+  const auto value = static_cast<uint32_t>(bit_buffer_ & ((uint64_t{1} << count) - 1));
+  bit_buffer_ >>= count;
+  bit_count_ -= count;
+  return value;
+}
+
+} // namespace fastgpx
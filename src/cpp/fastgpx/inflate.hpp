@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace fastgpx {
+
+/**
+ * @brief Computes the CRC-32 used by gzip and ZIP archives.
+ *
+ * @param data
+ * @param crc The CRC of the preceding data, to compute the CRC incrementally.
+ */
+uint32_t Crc32(std::string_view data, uint32_t crc = 0) noexcept;
+
+/**
+ * @brief Streaming decompressor for raw DEFLATE data (RFC 1951).
+ *
+ * The compressed data is read from memory, typically a memory-mapped file, and
+ * decompressed on demand as it is read. Only the last 32 KiB of output needed
+ * by back-references are kept, besides the output not yet read.
+ */
+class Inflater
+{
+public:
+  /**
+   * @param data Raw DEFLATE data, without a zlib or gzip header. Must outlive
+   *   the inflater.
+   */
+  explicit Inflater(std::string_view data);
+
+  /**
+   * @brief Reads the next decompressed bytes.
+   *
+   * @throws parse_error if the compressed data is malformed or truncated.
+   * @param buffer
+   * @param size
+   * @return size_t Number of bytes read. Less than `size` only at the end of
+   *   the data.
+   */
+  size_t Read(char* buffer, size_t size);
+
+  /**
+   * @brief True when the final block has been decompressed and read.
+   */
+  bool finished() const noexcept { return state_ == State::Done && read_pos_ == end_; }
+
+  /**
+   * @brief Number of bytes of the compressed data consumed so far. Once
+   *   finished, this is the size of the DEFLATE stream.
+   */
+  size_t consumed() const noexcept { return pos_ - bit_count_ / 8; }
+
+private:
+  enum class State : unsigned char
+  {
+    BlockHeader,
+    Stored,
+    Huffman,
+    Done,
+  };
+
+  // Canonical Huffman code. Codes up to `kFastBits` long are decoded with a
+  // single table lookup, longer codes bit by bit.
+  struct HuffmanCode
+  {
+    static constexpr size_t kFastBits = 10;
+    static constexpr size_t kMaxBits = 15;
+
+    // (symbol << 4) | length, or 0 for codes longer than `kFastBits`.
+    std::array<uint16_t, 1 << kFastBits> fast{};
+    // Number of codes of each length.
+    std::array<uint16_t, kMaxBits + 1> counts{};
+    // Symbols ordered by code.
+    std::array<uint16_t, 288> symbols{};
+
+    void Build(const uint8_t* lengths, size_t count);
+  };
+
+  void Decode(size_t target);
+  void ReadBlockHeader();
+  void ReadStored(size_t target);
+  void ReadHuffman(size_t target);
+  void ReadDynamicCodes();
+  void ReadFixedCodes();
+  int DecodeSymbol(const HuffmanCode& code);
+  void Refill() noexcept;
+  uint32_t Bits(size_t count);
+
+  std::string_view data_;
+  size_t pos_ = 0;
+  uint64_t bit_buffer_ = 0;
+  size_t bit_count_ = 0;
+
+  State state_ = State::BlockHeader;
+  bool last_block_ = false;
+  size_t stored_remaining_ = 0;
+  HuffmanCode literals_;
+  HuffmanCode distances_;
+
+  // Decompressed data in `[0, end_)`: the history referred to by
+  // back-references, followed by the output not yet read.
+  std::string output_;
+  size_t end_ = 0;
+  size_t read_pos_ = 0;
+};
+
+} // namespace fastgpx
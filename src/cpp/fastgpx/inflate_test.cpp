@@ -0,0 +1,91 @@
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "fastgpx/errors.hpp"
+#include "fastgpx/inflate.hpp"
+
+using namespace fastgpx;
+
+namespace {
+
+std::string InflateAll(std::string_view data, const size_t chunk_size = 4)
+{
+  Inflater inflater(data);
+  std::string output;
+  std::string chunk(chunk_size, '\0');
+  size_t read = 0;
+  do
+  {
+    read = inflater.Read(chunk.data(), chunk.size());
+    output.append(chunk.data(), read);
+  } while (read == chunk.size());
+  CHECK(inflater.finished());
+  return output;
+}
+
+} // namespace
+
+TEST_CASE("CRC-32", "[inflate]")
+{
+  CHECK(Crc32("") == 0);
+  CHECK(Crc32("123456789") == 0xCBF43926);
+  // Incrementally, across the boundaries of the eight byte blocks.
+  CHECK(Crc32("6789", Crc32("12345")) == 0xCBF43926);
+}
+
+TEST_CASE("Inflate stored block", "[inflate]")
+{
+  constexpr std::string_view data("\x01\x05\x00\xFA\xFFHello", 10);
+  CHECK(InflateAll(data) == "Hello");
+
+  Inflater inflater(data);
+  std::string output(16, '\0');
+  CHECK(inflater.Read(output.data(), output.size()) == 5);
+  CHECK(inflater.consumed() == data.size());
+}
+
+TEST_CASE("Inflate fixed Huffman block with back-references", "[inflate]")
+{
+  constexpr std::string_view data("\xF3\x48\xCD\xC9\xC9\xD7\x51\xF0\x40\xA2\x14\x01");
+  CHECK(InflateAll(data) == "Hello, Hello, Hello!");
+  CHECK(InflateAll(data, 1) == "Hello, Hello, Hello!");
+
+  // Data following the DEFLATE stream is not consumed.
+  const auto trailing = std::string(data) + "trailer";
+  Inflater inflater(trailing);
+  std::string output(64, '\0');
+  CHECK(inflater.Read(output.data(), output.size()) == 20);
+  CHECK(inflater.consumed() == data.size());
+}
+
+TEST_CASE("Inflate malformed data", "[inflate]")
+{
+  std::string output(64, '\0');
+
+  // Block type 3 is reserved.
+  Inflater reserved_block("\x07");
+  CHECK_THROWS_AS(reserved_block.Read(output.data(), output.size()), parse_error);
+
+  // The length of stored blocks is followed by its complement.
+  Inflater stored_length(std::string_view("\x01\x05\x00\x00\x00Hello", 10));
+  CHECK_THROWS_AS(stored_length.Read(output.data(), output.size()), parse_error);
+
+  Inflater truncated("\xF3\x48\xCD\xC9\xC9");
+  CHECK_THROWS_AS(truncated.Read(output.data(), output.size()), parse_error);
+
+  // The stored block is five bytes long, but only three follow.
+  Inflater truncated_stored(std::string_view("\x01\x05\x00\xFA\xFFHel", 8));
+  CHECK_THROWS_AS(truncated_stored.Read(output.data(), output.size()), parse_error);
+
+  // Four code length codes of length one are more than a code of that length
+  // can hold.
+  Inflater over_subscribed(std::string_view("\x05\x00\x92\x04", 4));
+  CHECK_THROWS_AS(over_subscribed.Read(output.data(), output.size()), parse_error);
+
+  // A literal followed by a match at distance two, which is before the start of
+  // the output.
+  Inflater distance_too_far(std::string_view("\x4B\x04\x42\x00", 4));
+  CHECK_THROWS_AS(distance_too_far.Read(output.data(), output.size()), parse_error);
+}
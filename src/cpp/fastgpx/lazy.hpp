@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace fastgpx {
+
+/**
+ * @brief Value computed on first use, which can be read from multiple threads.
+ *
+ * Threads finding the value missing compute it concurrently, and the first to
+ * finish publishes its result. The computation must therefore not have side
+ * effects. This trades rare duplicate work on first use for not holding a lock
+ * per cached value.
+ *
+ * Copies keep the value when it has been computed. Copying or assigning while
+ * other threads read the value is a data race, as for any other member.
+ */
+template<typename T>
+class LazyValue
+{
+public:
+  LazyValue() = default;
+
+  // Also used for moves. Not throwing keeps the classes holding lazy values
+  // nothrow-movable, such that vectors of them move rather than copy on growth.
+  LazyValue(const LazyValue& other) noexcept(std::is_nothrow_copy_constructible_v<T>)
+  {
+    CopyFrom(other);
+  }
+
+  LazyValue& operator=(const LazyValue& other) noexcept(std::is_nothrow_copy_assignable_v<T>)
+  {
+    if (this != &other)
+    {
+      CopyFrom(other);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Returns the value, computing it with `compute` if it is missing.
+   *
+   * @throws Whatever `compute` throws. The value is left missing.
+   * @param compute Callable returning a `T`.
+   */
+  template<typename Compute>
+  const T& Get(Compute&& compute) const
+  {
+    if (state_.load(std::memory_order_acquire) != State::Ready)
+    {
+      T computed = std::forward<Compute>(compute)();
+      auto expected = State::Empty;
+      if (state_.compare_exchange_strong(expected, State::Writing, std::memory_order_acquire))
+      {
+        value_.emplace(std::move(computed));
+        state_.store(State::Ready, std::memory_order_release);
+        state_.notify_all();
+      }
+      else
+      {
+        // Another thread is publishing the same value.
+        while (state_.load(std::memory_order_acquire) == State::Writing)
+        {
+          state_.wait(State::Writing, std::memory_order_acquire);
+        }
+      }
+    }
+    return *value_;
+  }
+
+  bool has_value() const noexcept { return state_.load(std::memory_order_acquire) == State::Ready; }
+
+  /**
+   * @brief Applies `update` to the value if it has been computed, such as to
+   *   account for appended data without computing it again.
+   *
+   * Not thread-safe, like assignment.
+   *
+   * @param update Callable taking a `T&`.
+   */
+  template<typename Modify>
+  void Update(Modify&& update)
+  {
+    if (has_value())
+    {
+      std::forward<Modify>(update)(*value_);
+    }
+  }
+
+  /**
+   * @brief Replaces the value, such as with one computed earlier.
+   *
+   * Not thread-safe, like assignment.
+   */
+  void Set(T value)
+  {
+    value_.emplace(std::move(value));
+    state_.store(State::Ready, std::memory_order_release);
+  }
+
+  /**
+   * @brief Discards the value, such that it is computed again on next use.
+   *
+   * Not thread-safe, like assignment.
+   */
+  void Reset() noexcept
+  {
+    state_.store(State::Empty, std::memory_order_relaxed);
+    value_.reset();
+  }
+
+private:
+  enum class State : uint8_t
+  {
+    Empty,
+    Writing,
+    Ready,
+  };
+
+  void CopyFrom(const LazyValue& other)
+  {
+    if (other.has_value())
+    {
+      value_ = other.value_;
+      state_.store(State::Ready, std::memory_order_release);
+    }
+    else
+    {
+      state_.store(State::Empty, std::memory_order_relaxed);
+      value_.reset();
+    }
+  }
+
+  mutable std::atomic<State> state_ = State::Empty;
+  mutable std::optional<T> value_;
+};
+
+} // namespace fastgpx
@@ -0,0 +1,148 @@
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "fastgpx/fastgpx.hpp"
+#include "fastgpx/lazy.hpp"
+#include "fastgpx/parallel.hpp"
+
+using namespace fastgpx;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+// Vectors of these must move their elements on growth, keeping the memory
+// resource of their columns.
+static_assert(std::is_nothrow_move_constructible_v<Segment>);
+static_assert(std::is_nothrow_move_constructible_v<Track>);
+static_assert(std::is_nothrow_move_constructible_v<Gpx>);
+
+TEST_CASE("Lazy value is computed on first use", "[lazy]")
+{
+  LazyValue<int> value;
+  CHECK_FALSE(value.has_value());
+
+  int calls = 0;
+  CHECK(value.Get([&] { return ++calls; }) == 1);
+  CHECK(value.Get([&] { return ++calls; }) == 1);
+  CHECK(value.has_value());
+  CHECK(calls == 1);
+}
+
+TEST_CASE("Lazy value copies keep the computed value", "[lazy]")
+{
+  LazyValue<int> value;
+  const LazyValue<int> empty_copy(value);
+  value.Get([] { return 42; });
+
+  const LazyValue<int> copy(value);
+  CHECK(copy.Get([] { return 0; }) == 42);
+  CHECK_FALSE(empty_copy.has_value());
+
+  LazyValue<int> assigned;
+  assigned = empty_copy;
+  CHECK_FALSE(assigned.has_value());
+  assigned = value;
+  CHECK(assigned.Get([] { return 0; }) == 42);
+}
+
+TEST_CASE("Lazy value is left missing when the computation throws", "[lazy]")
+{
+  LazyValue<int> value;
+  CHECK_THROWS_AS(value.Get([]() -> int { throw std::runtime_error("failed"); }),
+                  std::runtime_error);
+  CHECK_FALSE(value.has_value());
+  CHECK(value.Get([] { return 7; }) == 7);
+}
+
+TEST_CASE("Lazy value is updated only when computed", "[lazy]")
+{
+  LazyValue<int> value;
+  value.Update([](int& v) { v += 1; });
+  CHECK_FALSE(value.has_value());
+
+  value.Get([] { return 41; });
+  value.Update([](int& v) { v += 1; });
+  CHECK(value.Get([] { return 0; }) == 42);
+
+  value.Reset();
+  CHECK_FALSE(value.has_value());
+  CHECK(value.Get([] { return 7; }) == 7);
+}
+
+TEST_CASE("Lazy value read concurrently", "[lazy]")
+{
+  const LazyValue<int> value;
+  std::atomic<int> calls = 0;
+  std::vector<int> results(64);
+  ParallelFor(results.size(), 8, [&](const size_t index) {
+    results[index] = value.Get([&] { return 100 + calls++; });
+  });
+
+  const int published = value.Get([] { return -1; });
+  CHECK(calls >= 1);
+  for (const int result : results)
+  {
+    CHECK(result == published);
+  }
+}
+
+TEST_CASE("Segment metrics computed concurrently", "[lazy]")
+{
+  Segment segment;
+  for (int i = 0; i < 1000; ++i)
+  {
+    const LatLong point{
+        .latitude = 60.0 + i * 0.001, .longitude = 10.0, .elevation = static_cast<double>(i)};
+    segment.columns.push_back(point, i % 2 == 0 ? "2024-05-18T12:00:00Z" : "2024-05-18T12:30:00Z");
+  }
+  Track track;
+  track.segments.push_back(segment);
+  const Track expected = track;
+
+  ParallelFor(16, 8, [&](size_t) {
+    track.GetLength2D();
+    track.GetLength3D();
+    track.GetBounds();
+    track.GetTimeBounds();
+  });
+
+  CHECK(track.GetLength2D() == expected.GetLength2D());
+  CHECK(track.GetLength3D() == expected.GetLength3D());
+  CHECK(track.GetBounds() == expected.GetBounds());
+  CHECK(track.GetTimeBounds() == expected.GetTimeBounds());
+}
+
+TEST_CASE("Stress shared GPX metrics", "[lazy]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  const Gpx expected = LoadGpx(path);
+  const double expected_length2d = expected.GetLength2D();
+  const double expected_length3d = expected.GetLength3D();
+  const Bounds expected_bounds = expected.GetBounds();
+  const TimeBounds expected_time_bounds = expected.GetTimeBounds();
+
+  for (int round = 0; round < 20; ++round)
+  {
+    // A fresh document per round, such that the threads race to fill the caches.
+    const Gpx gpx = LoadGpx(path);
+    std::atomic<int> mismatches = 0;
+    ParallelFor(64, 16, [&](const size_t index) {
+      // Reach the caches through different levels first.
+      const auto& segments = gpx.tracks.front().segments;
+      const auto& segment = segments[index % segments.size()];
+      segment.GetTimeBounds();
+      segment.GetLength3D();
+      if (gpx.GetLength2D() != expected_length2d || gpx.GetLength3D() != expected_length3d ||
+          gpx.GetBounds() != expected_bounds || gpx.GetTimeBounds() != expected_time_bounds)
+      {
+        mismatches++;
+      }
+    });
+    REQUIRE(mismatches == 0);
+  }
+}
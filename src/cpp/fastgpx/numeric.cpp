@@ -0,0 +1,81 @@
+#include "fastgpx/numeric.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <system_error>
+
+namespace fastgpx {
+
+namespace {
+
+// Powers of ten that are exactly representable as doubles.
+constexpr std::array<double, 23> kPowersOfTen = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Integers up to 2^53 are exactly representable as doubles.
+constexpr uint64_t kMaxExactMantissa = uint64_t{1} << 53;
+
+// Enough digits to accumulate without overflowing uint64_t.
+constexpr size_t kMaxMantissaDigits = 19;
+
+bool IsDigit(const char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+double ParseDoubleFallback(std::string_view text) noexcept
+{
+  double value = 0.0;
+  const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc() ? value : 0.0;
+}
+
+} // namespace
+
+double ParseDouble(std::string_view text) noexcept
+{
+  if (!text.empty() && text.front() == '+')
+  {
+    // Unlike strtod, std::from_chars doesn't accept a leading plus sign.
+    text.remove_prefix(1);
+  }
+
+  // Clinger's fast path: when both the decimal mantissa and the power of ten
+  // are exact doubles, a single IEEE division is correctly rounded.
+  size_t i = 0;
+  const bool negative = i < text.size() && text[i] == '-';
+  if (negative)
+  {
+    i++;
+  }
+  uint64_t mantissa = 0;
+  size_t digits = 0;
+  size_t fraction_digits = 0;
+  for (; i < text.size() && IsDigit(text[i]); ++i, ++digits)
+  {
+    mantissa = mantissa * 10 + static_cast<uint64_t>(text[i] - '0');
+  }
+  if (i < text.size() && text[i] == '.')
+  {
+    for (++i; i < text.size() && IsDigit(text[i]); ++i, ++digits, ++fraction_digits)
+    {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(text[i] - '0');
+    }
+  }
+  const bool has_exponent = i < text.size() && (text[i] == 'e' || text[i] == 'E');
+  if (digits == 0 || digits > kMaxMantissaDigits || has_exponent ||
+      mantissa > kMaxExactMantissa || fraction_digits >= kPowersOfTen.size())
+  {
+    return ParseDoubleFallback(text);
+  }
+
+  const double value = static_cast<double>(mantissa) / kPowersOfTen[fraction_digits];
+  return negative ? -value : value;
+}
+
+} // namespace fastgpx
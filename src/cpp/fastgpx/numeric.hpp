@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string_view>
+
+namespace fastgpx {
+
+/**
+ * @brief Locale-independent parser for the leading decimal number of `text`,
+ *   such as GPX coordinates and elevations.
+ *
+ * Short decimals like `59.3293514` are converted exactly with a single
+ * floating point division. Longer mantissas and exponents fall back to
+ * `std::from_chars`. Both give the correctly rounded result.
+ *
+ * An optional leading `+` or `-` sign is accepted. Trailing characters are
+ * ignored, like `strtod`.
+ *
+ * @param text
+ * @return double 0.0 if `text` doesn't start with a number.
+ */
+double ParseDouble(std::string_view text) noexcept;
+
+} // namespace fastgpx
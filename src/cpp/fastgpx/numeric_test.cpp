@@ -0,0 +1,120 @@
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "fastgpx/numeric.hpp"
+
+using namespace fastgpx;
+
+namespace {
+
+double FromChars(std::string_view text)
+{
+  double value = 0.0;
+  const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc() ? value : 0.0;
+}
+
+// Coordinates formatted like GPX writers do, with up to 9 fractional digits.
+std::vector<std::string> RandomCoordinates(const size_t count)
+{
+  std::mt19937_64 engine(2024);
+  std::uniform_real_distribution<double> degrees(-180.0, 180.0);
+  std::uniform_int_distribution<int> precision(0, 9);
+  std::vector<std::string> coordinates;
+  coordinates.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    coordinates.push_back(std::format("{:.{}f}", degrees(engine), precision(engine)));
+  }
+  return coordinates;
+}
+
+} // namespace
+
+TEST_CASE("Parse decimal numbers", "[numeric]")
+{
+  CHECK(ParseDouble("59.3293514") == 59.3293514);
+  CHECK(ParseDouble("-18.0686") == -18.0686);
+  CHECK(ParseDouble("+152.5") == 152.5);
+  CHECK(ParseDouble("0.1") == 0.1);
+  CHECK(ParseDouble("42") == 42.0);
+  CHECK(ParseDouble("7.") == 7.0);
+  CHECK(ParseDouble(".5") == 0.5);
+  CHECK(std::signbit(ParseDouble("-0.0")));
+}
+
+TEST_CASE("Parse decimal numbers outside the fast path", "[numeric]")
+{
+  CHECK(ParseDouble("1e5") == 1e5);
+  CHECK(ParseDouble("2.5E-3") == 2.5e-3);
+  CHECK(ParseDouble("9007199254740993") == 9007199254740993.0);
+  CHECK(ParseDouble("0.30000000000000004") == 0.30000000000000004);
+  CHECK(ParseDouble("123456789012345678901234") == 123456789012345678901234.0);
+  CHECK(ParseDouble("0.00000000000000000000000123") == 1.23e-24);
+  CHECK(ParseDouble("1e400") == 0.0);
+}
+
+TEST_CASE("Parse invalid decimal numbers", "[numeric]")
+{
+  CHECK(ParseDouble("") == 0.0);
+  CHECK(ParseDouble("-") == 0.0);
+  CHECK(ParseDouble(".") == 0.0);
+  CHECK(ParseDouble("abc") == 0.0);
+  CHECK(ParseDouble("1.5abc") == 1.5);
+  CHECK(ParseDouble("1,5") == 1.0);
+}
+
+TEST_CASE("Parse decimal numbers matches std::from_chars", "[numeric]")
+{
+  for (const auto& coordinate : RandomCoordinates(10'000))
+  {
+    CAPTURE(coordinate);
+    REQUIRE(ParseDouble(coordinate) == FromChars(coordinate));
+  }
+}
+
+TEST_CASE("Benchmark parse decimal numbers", "[!benchmark][numeric]")
+{
+  // One million points, each with a latitude and a longitude.
+  const auto coordinates = RandomCoordinates(2'000'000);
+
+  BENCHMARK("ParseDouble per million points")
+  {
+    double sum = 0.0;
+    for (const auto& coordinate : coordinates)
+    {
+      sum += ParseDouble(coordinate);
+    }
+    return sum;
+  };
+  BENCHMARK("std::from_chars per million points")
+  {
+    double sum = 0.0;
+    for (const auto& coordinate : coordinates)
+    {
+      sum += FromChars(coordinate);
+    }
+    return sum;
+  };
+  BENCHMARK("std::strtod per million points")
+  {
+    double sum = 0.0;
+    for (const auto& coordinate : coordinates)
+    {
+      sum += std::strtod(coordinate.c_str(), nullptr);
+    }
+    return sum;
+  };
+}
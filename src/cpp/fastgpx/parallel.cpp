@@ -0,0 +1,131 @@
+#include "fastgpx/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fastgpx {
+
+size_t ResolveThreadCount(const size_t threads) noexcept
+{
+  if (threads > 0)
+  {
+    return threads;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ParallelFor(const size_t count, const size_t threads,
+                 const std::function<void(size_t)>& func)
+{
+  const size_t workers = std::min(ResolveThreadCount(threads), count);
+  if (workers <= 1)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      func(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_index = 0;
+  std::atomic<bool> failed = false;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  const auto worker = [&] {
+    while (!failed.load(std::memory_order_relaxed))
+    {
+      const size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+      if (index >= count)
+      {
+        break;
+      }
+      try
+      {
+        func(index);
+      }
+      catch (...)
+      {
+        const std::lock_guard lock(error_mutex);
+        if (!error)
+        {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  {
+    // The calling thread is one of the workers.
+    std::vector<std::jthread> pool;
+    pool.reserve(workers - 1);
+    for (size_t i = 1; i < workers; ++i)
+    {
+      pool.emplace_back(worker);
+    }
+    worker();
+  }
+
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+// ThreadPool
+
+ThreadPool::ThreadPool(const size_t threads)
+{
+  const size_t count = ResolveThreadCount(threads);
+  workers_.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    workers_.emplace_back([this] { Work(); });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    const std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  workers_.clear(); // Joins.
+}
+
+void ThreadPool::Submit(std::move_only_function<void()> task)
+{
+  {
+    const std::lock_guard lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  ready_.notify_one();
+}
+
+void ThreadPool::Work()
+{
+  while (true)
+  {
+    std::move_only_function<void()> task;
+    {
+      std::unique_lock lock(mutex_);
+      ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty())
+      {
+        return; // Stopping, and all the tasks have run.
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+} // namespace fastgpx
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fastgpx {
+
+/**
+ * @brief Resolves a requested worker count.
+ *
+ * @param threads Requested number of threads, or 0 for one per hardware thread.
+ * @return size_t At least 1.
+ */
+size_t ResolveThreadCount(size_t threads) noexcept;
+
+/**
+ * @brief Calls `func` for each index in `[0, count)` using up to `threads` workers.
+ *
+ * Indices are handed out dynamically, so workers that finish early pick up the
+ * remaining work. Runs on the calling thread when only one worker is needed.
+ *
+ * @throws The first exception thrown by `func`, after all workers have stopped.
+ *   Workers stop picking up new indices once an exception has been thrown.
+ * @param count
+ * @param threads Number of workers, or 0 for one per hardware thread.
+ * @param func
+ */
+void ParallelFor(size_t count, size_t threads, const std::function<void(size_t)>& func);
+
+/**
+ * @brief Fixed set of worker threads running submitted tasks in FIFO order.
+ *
+ * Unlike `ParallelFor`, the workers outlive each batch of work, and `Submit`
+ * returns immediately. Used to complete asynchronous loads in the background.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * @param threads Number of workers, or 0 for one per hardware thread.
+   */
+  explicit ThreadPool(size_t threads = 0);
+
+  /**
+   * @brief Runs the tasks already submitted, then joins the workers.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Queues a task to run on one of the workers.
+   *
+   * An exception escaping the task terminates the program, as for
+   * `std::thread`. Tasks report their errors themselves.
+   *
+   * @param task
+   */
+  void Submit(std::move_only_function<void()> task);
+
+  size_t size() const noexcept { return workers_.size(); }
+
+private:
+  void Work();
+
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::move_only_function<void()>> tasks_;
+  bool stopping_ = false;
+  std::vector<std::jthread> workers_;
+};
+
+} // namespace fastgpx
@@ -0,0 +1,100 @@
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "fastgpx/parallel.hpp"
+
+using Catch::Generators::as;
+
+using namespace fastgpx;
+
+TEST_CASE("Resolve thread count", "[parallel]")
+{
+  CHECK(ResolveThreadCount(3) == 3);
+  CHECK(ResolveThreadCount(0) >= 1);
+}
+
+TEST_CASE("Parallel for visits each index once", "[parallel]")
+{
+  const size_t threads = GENERATE(as<size_t>{}, 0, 1, 2, 8);
+  CAPTURE(threads);
+
+  std::vector<std::atomic<int>> visits(1000);
+  ParallelFor(visits.size(), threads, [&](const size_t index) { visits[index]++; });
+
+  for (const auto& count : visits)
+  {
+    CHECK(count == 1);
+  }
+}
+
+TEST_CASE("Parallel for with no work", "[parallel]")
+{
+  bool called = false;
+  ParallelFor(0, 4, [&](size_t) { called = true; });
+  CHECK_FALSE(called);
+}
+
+TEST_CASE("Parallel for propagates exceptions", "[parallel]")
+{
+  const size_t threads = GENERATE(as<size_t>{}, 1, 4);
+  CAPTURE(threads);
+
+  REQUIRE_THROWS_AS(ParallelFor(100, threads,
+                                [](const size_t index) {
+                                  if (index == 42)
+                                  {
+                                    throw std::runtime_error("failed");
+                                  }
+                                }),
+                    std::runtime_error);
+}
+
+TEST_CASE("Thread pool runs each submitted task", "[parallel]")
+{
+  const size_t threads = GENERATE(as<size_t>{}, 0, 1, 4);
+  CAPTURE(threads);
+
+  std::vector<std::atomic<int>> runs(500);
+  {
+    ThreadPool pool(threads);
+    CHECK(pool.size() == ResolveThreadCount(threads));
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+      pool.Submit([&runs, i] { runs[i]++; });
+    }
+    // The destructor runs the queued tasks before joining.
+  }
+
+  for (const auto& count : runs)
+  {
+    CHECK(count == 1);
+  }
+}
+
+TEST_CASE("Thread pool runs tasks off the calling thread", "[parallel]")
+{
+  std::mutex mutex;
+  std::vector<std::thread::id> ids;
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < 8; ++i)
+    {
+      pool.Submit([&] {
+        const std::lock_guard lock(mutex);
+        ids.push_back(std::this_thread::get_id());
+      });
+    }
+  }
+  REQUIRE(ids.size() == 8);
+  for (const auto& id : ids)
+  {
+    CHECK(id != std::this_thread::get_id());
+  }
+}
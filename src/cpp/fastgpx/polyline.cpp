@@ -1,25 +1,37 @@
 #include "fastgpx/polyline.hpp"
 
 #include <cmath>
+#include <cstdint>
 #include <utility>
 
+#include "fastgpx/compact.hpp"
 #include "fastgpx/fastgpx.hpp"
 
 namespace fastgpx {
 
 namespace polyline {
 
-std::string encode(std::span<const LatLong> locations, Precision precision)
+namespace {
+
+int Factor(const Precision precision)
+{
+  return (precision == Precision::Six) ? 1'000'000 : 100'000;
+}
+
+// Encodes the locations from their coordinates already scaled to integers by
+// `to_scaled(location, lat, lng)`.
+template<typename Location, typename ToScaled>
+std::string Encode(std::span<const Location> locations, ToScaled to_scaled)
 {
-  const int factor = (precision == Precision::Six) ? 1'000'000 : 100'000;
   std::string encoded_polyline;
   int last_lat = 0;
   int last_lng = 0;
 
   for (const auto& coord : locations)
   {
-    const int lat = static_cast<int>(std::round(coord.latitude * factor));
-    const int lng = static_cast<int>(std::round(coord.longitude * factor));
+    int lat = 0;
+    int lng = 0;
+    to_scaled(coord, lat, lng);
 
     const int delta_lat = lat - last_lat;
     const int delta_lng = lng - last_lng;
@@ -46,9 +58,37 @@ std::string encode(std::span<const LatLong> locations, Precision precision)
   return encoded_polyline;
 }
 
+// Divides and rounds half away from zero, like std::round.
+int RoundedDivide(const int32_t value, const int32_t divisor)
+{
+  const int32_t half = divisor / 2;
+  return (value < 0) ? (value - half) / divisor : (value + half) / divisor;
+}
+
+} // namespace
+
+std::string encode(std::span<const LatLong> locations, Precision precision)
+{
+  const int factor = Factor(precision);
+  return Encode(locations, [factor](const LatLong& coord, int& lat, int& lng) {
+    lat = static_cast<int>(std::round(coord.latitude * factor));
+    lng = static_cast<int>(std::round(coord.longitude * factor));
+  });
+}
+
+std::string encode(std::span<const CompactLatLong> locations, Precision precision)
+{
+  // Scale the fixed-point values directly to avoid rounding twice.
+  const int32_t divisor = static_cast<int32_t>(CompactLatLong::kUnitsPerDegree) / Factor(precision);
+  return Encode(locations, [divisor](const CompactLatLong& coord, int& lat, int& lng) {
+    lat = RoundedDivide(coord.latitude_e7, divisor);
+    lng = RoundedDivide(coord.longitude_e7, divisor);
+  });
+}
+
 std::vector<LatLong> decode(std::string_view encoded, Precision precision)
 {
-  const int factor = (precision == Precision::Six) ? 1'000'000 : 100'000;
+  const int factor = Factor(precision);
   std::vector<LatLong> coordinates;
   size_t index = 0;
   int lat = 0;
@@ -7,6 +7,7 @@
 
 namespace fastgpx {
 struct LatLong;
+struct CompactLatLong;
 
 namespace polyline {
 
@@ -17,6 +18,8 @@ enum class Precision
 };
 
 std::string encode(std::span<const LatLong> locations, Precision precision = Precision::Five);
+std::string encode(std::span<const CompactLatLong> locations,
+                   Precision precision = Precision::Five);
 
 std::vector<LatLong> decode(std::string_view encoded, Precision precision = Precision::Five);
 
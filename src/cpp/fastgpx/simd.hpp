@@ -0,0 +1,114 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define FASTGPX_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+/**
+ * @brief Character search helpers for the XML scanning hot paths.
+ *
+ * SSE2 is part of the x86-64 baseline, so these need no runtime dispatch. Other
+ * architectures use the scalar fallback.
+ */
+namespace fastgpx::simd {
+
+/**
+ * @brief Finds the first occurrence of `c` in `data`.
+ *
+ * @return Offset of the character, or `std::string_view::npos`.
+ */
+inline size_t FindChar(std::string_view data, const char c) noexcept
+{
+  size_t i = 0;
+#ifdef FASTGPX_SSE2
+  const __m128i needle = _mm_set1_epi8(c);
+  for (; i + 16 <= data.size(); i += 16)
+  {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+    const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+    if (mask != 0)
+    {
+      return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+  }
+#endif
+  const void* found = std::memchr(data.data() + i, c, data.size() - i);
+  return found != nullptr ? static_cast<size_t>(static_cast<const char*>(found) - data.data())
+                          : std::string_view::npos;
+}
+
+/**
+ * @brief Finds the first occurrence of any of the characters `a`, `b` or `c` in `data`.
+ *
+ * @return Offset of the character, or `std::string_view::npos`.
+ */
+inline size_t FindAnyOf(std::string_view data, const char a, const char b, const char c) noexcept
+{
+  size_t i = 0;
+#ifdef FASTGPX_SSE2
+  const __m128i needle_a = _mm_set1_epi8(a);
+  const __m128i needle_b = _mm_set1_epi8(b);
+  const __m128i needle_c = _mm_set1_epi8(c);
+  for (; i + 16 <= data.size(); i += 16)
+  {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+    const __m128i matches =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, needle_a), _mm_cmpeq_epi8(chunk, needle_b)),
+                     _mm_cmpeq_epi8(chunk, needle_c));
+    const int mask = _mm_movemask_epi8(matches);
+    if (mask != 0)
+    {
+      return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+  }
+#endif
+  for (; i < data.size(); ++i)
+  {
+    if (data[i] == a || data[i] == b || data[i] == c)
+    {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+/**
+ * @brief Counts the leading XML whitespace characters (space, tab, CR, LF) of `data`.
+ */
+inline size_t CountWhitespace(std::string_view data) noexcept
+{
+  size_t i = 0;
+#ifdef FASTGPX_SSE2
+  // Indentation between elements is often longer than a few characters.
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  for (; i + 16 <= data.size(); i += 16)
+  {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+    const __m128i matches =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                     _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+    const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(matches));
+    if (mask != 0xFFFF)
+    {
+      return i + static_cast<size_t>(std::countr_one(mask));
+    }
+  }
+#endif
+  while (i < data.size() &&
+         (data[i] == ' ' || data[i] == '\t' || data[i] == '\r' || data[i] == '\n'))
+  {
+    ++i;
+  }
+  return i;
+}
+
+} // namespace fastgpx::simd
@@ -0,0 +1,473 @@
+#include "fastgpx/spatial.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <numbers>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "fastgpx/binary.hpp"
+#include "fastgpx/errors.hpp"
+#include "fastgpx/filesystem.hpp"
+#include "fastgpx/geom.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+constexpr std::string_view kSpatialMagic = "FGPXRTRE";
+// Bump when the layout of the index files changes.
+constexpr uint32_t kSpatialVersion = 1;
+// Children per node of the tree.
+constexpr size_t kNodeCapacity = 16;
+
+// Meters per degree of latitude, on the sphere of `haversine`.
+constexpr double kMetersPerDegree = 6372797.560856 * std::numbers::pi / 180.0;
+
+bool Overlaps(const auto& a, const auto& b)
+{
+  return a.min_latitude <= b.max_latitude && b.min_latitude <= a.max_latitude &&
+         a.min_longitude <= b.max_longitude && b.min_longitude <= a.max_longitude;
+}
+
+// Shortest distance in meters from `center` to a location within `box`.
+double DistanceToBox(const LatLong& center, const auto& box)
+{
+  const double latitude = std::clamp(center.latitude, box.min_latitude, box.max_latitude);
+  if (center.longitude >= box.min_longitude && center.longitude <= box.max_longitude)
+  {
+    return haversine(center, LatLong{latitude, center.longitude});
+  }
+
+  // The closest location is on a meridian edge, though not at the latitude of
+  // the center but towards the pole. The cosine of the distance along the edge
+  // is a sinusoid of the latitude, so the minimum is at its peak or at an end.
+  const double phi = center.latitude * std::numbers::pi / 180.0;
+  double distance = std::numeric_limits<double>::infinity();
+  for (const double longitude : {box.min_longitude, box.max_longitude})
+  {
+    const double delta = (longitude - center.longitude) * std::numbers::pi / 180.0;
+    const double peak =
+        std::atan2(std::sin(phi), std::cos(phi) * std::cos(delta)) * 180.0 / std::numbers::pi;
+    distance = std::min({distance, haversine(center, LatLong{box.min_latitude, longitude}),
+                         haversine(center, LatLong{box.max_latitude, longitude})});
+    if (peak >= box.min_latitude && peak <= box.max_latitude)
+    {
+      distance = std::min(distance, haversine(center, LatLong{peak, longitude}));
+    }
+  }
+  return distance;
+}
+
+void Extend(auto& box, const auto& other)
+{
+  box.min_latitude = std::min(box.min_latitude, other.min_latitude);
+  box.min_longitude = std::min(box.min_longitude, other.min_longitude);
+  box.max_latitude = std::max(box.max_latitude, other.max_latitude);
+  box.max_longitude = std::max(box.max_longitude, other.max_longitude);
+}
+
+// Orders `boxes` with Sort-Tile-Recursive packing: sorted into vertical slices
+// by longitude, then by latitude within each slice, such that each run of
+// `kNodeCapacity` boxes is close together.
+template <typename Box>
+std::vector<size_t> TileOrder(std::span<const Box> boxes)
+{
+  const auto center_latitude = [&](size_t i) {
+    return boxes[i].min_latitude + boxes[i].max_latitude;
+  };
+  const auto center_longitude = [&](size_t i) {
+    return boxes[i].min_longitude + boxes[i].max_longitude;
+  };
+
+  std::vector<size_t> order(boxes.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::ranges::sort(order, {}, center_longitude);
+
+  const size_t node_count = (boxes.size() + kNodeCapacity - 1) / kNodeCapacity;
+  const auto slice_count =
+      static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(node_count))));
+  const size_t slice_size = std::max<size_t>(slice_count * kNodeCapacity, 1);
+  for (size_t first = 0; first < order.size(); first += slice_size)
+  {
+    const auto begin = order.begin() + static_cast<ptrdiff_t>(first);
+    const auto end = order.begin() + static_cast<ptrdiff_t>(std::min(first + slice_size,
+                                                                       order.size()));
+    std::ranges::sort(begin, end, {}, center_latitude);
+  }
+  return order;
+}
+
+template <typename T>
+void Permute(std::vector<T>& values, std::span<const size_t> order)
+{
+  std::vector<T> permuted;
+  permuted.reserve(values.size());
+  for (const size_t index : order)
+  {
+    permuted.push_back(std::move(values[index]));
+  }
+  values = std::move(permuted);
+}
+
+// Sorts the matches and merges the ranges of adjacent chunks.
+std::vector<SpatialMatch> MergeMatches(std::vector<SpatialMatch> matches)
+{
+  std::ranges::sort(matches);
+  std::vector<SpatialMatch> merged;
+  for (const auto& match : matches)
+  {
+    if (!merged.empty())
+    {
+      auto& last = merged.back();
+      if (last.document == match.document && last.track == match.track &&
+          last.segment == match.segment && last.end_point == match.first_point)
+      {
+        last.end_point = match.end_point;
+        continue;
+      }
+    }
+    merged.push_back(match);
+  }
+  return merged;
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(std::span<const Gpx* const> documents, const size_t chunk_size)
+    : chunk_size_(std::max<size_t>(chunk_size, 1))
+{
+  for (size_t i = 0; i < documents.size(); ++i)
+  {
+    Add(i, *documents[i]);
+  }
+  Build();
+}
+
+SpatialIndex::SpatialIndex(std::span<const Gpx> documents, const size_t chunk_size)
+    : chunk_size_(std::max<size_t>(chunk_size, 1))
+{
+  for (size_t i = 0; i < documents.size(); ++i)
+  {
+    Add(i, documents[i]);
+  }
+  Build();
+}
+
+void SpatialIndex::Add(const size_t document_index, const Gpx& gpx)
+{
+  for (size_t t = 0; t < gpx.tracks.size(); ++t)
+  {
+    const auto& segments = gpx.tracks[t].segments;
+    for (size_t s = 0; s < segments.size(); ++s)
+    {
+      const auto& columns = segments[s].columns;
+      const size_t size = columns.size();
+      for (size_t first = 0; first < size; first += chunk_size_)
+      {
+        const size_t end = std::min(first + chunk_size_, size);
+        // Also covers the line to the first point of the next chunk.
+        const size_t box_end = std::min(end + 1, size);
+        Box box{
+            .min_latitude = columns.latitude[first],
+            .min_longitude = columns.longitude[first],
+            .max_latitude = columns.latitude[first],
+            .max_longitude = columns.longitude[first],
+        };
+        for (size_t i = first + 1; i < box_end; ++i)
+        {
+          box.min_latitude = std::min(box.min_latitude, columns.latitude[i]);
+          box.min_longitude = std::min(box.min_longitude, columns.longitude[i]);
+          box.max_latitude = std::max(box.max_latitude, columns.latitude[i]);
+          box.max_longitude = std::max(box.max_longitude, columns.longitude[i]);
+        }
+        items_.push_back({document_index, t, s, first, end});
+        item_boxes_.push_back(box);
+      }
+    }
+  }
+}
+
+void SpatialIndex::Build()
+{
+  if (items_.empty())
+  {
+    return;
+  }
+
+  const auto order = TileOrder<Box>(item_boxes_);
+  Permute(items_, order);
+  Permute(item_boxes_, order);
+
+  // Groups each run of `kNodeCapacity` children into a node of the level above.
+  const auto add_level = [&](std::span<const Box> boxes, const size_t first_child) {
+    levels_.push_back(nodes_.size());
+    for (size_t first = 0; first < boxes.size(); first += kNodeCapacity)
+    {
+      const size_t count = std::min(kNodeCapacity, boxes.size() - first);
+      Node node{.box = boxes[first], .first = first_child + first, .count = count};
+      for (size_t i = first + 1; i < first + count; ++i)
+      {
+        Extend(node.box, boxes[i]);
+      }
+      nodes_.push_back(node);
+    }
+  };
+  add_level(item_boxes_, 0);
+
+  while (nodes_.size() - levels_.back() > 1)
+  {
+    // Tiles the nodes of the last level before grouping them. Their children
+    // are in the level below, which is not reordered.
+    const size_t level = levels_.back();
+    std::vector<Node> level_nodes(nodes_.begin() + static_cast<ptrdiff_t>(level), nodes_.end());
+    std::vector<Box> boxes;
+    boxes.reserve(level_nodes.size());
+    for (const auto& node : level_nodes)
+    {
+      boxes.push_back(node.box);
+    }
+    const auto level_order = TileOrder<Box>(boxes);
+    Permute(level_nodes, level_order);
+    Permute(boxes, level_order);
+    std::ranges::copy(level_nodes, nodes_.begin() + static_cast<ptrdiff_t>(level));
+    add_level(boxes, level);
+  }
+}
+
+template <typename Enter, typename Accept>
+std::vector<SpatialMatch> SpatialIndex::Search(const Enter& enter, const Accept& accept) const
+{
+  std::vector<SpatialMatch> matches;
+  if (nodes_.empty())
+  {
+    return matches;
+  }
+
+  // Pairs of node index and level.
+  std::vector<std::pair<size_t, size_t>> stack{{nodes_.size() - 1, levels_.size() - 1}};
+  while (!stack.empty())
+  {
+    const auto [index, level] = stack.back();
+    stack.pop_back();
+    const Node& node = nodes_[index];
+    if (!enter(node.box))
+    {
+      continue;
+    }
+    for (size_t child = node.first; child < node.first + node.count; ++child)
+    {
+      if (level > 0)
+      {
+        stack.emplace_back(child, level - 1);
+      }
+      else if (accept(item_boxes_[child]))
+      {
+        matches.push_back(items_[child]);
+      }
+    }
+  }
+  return MergeMatches(std::move(matches));
+}
+
+std::vector<SpatialMatch> SpatialIndex::Query(const Bounds& bounds) const
+{
+  if (!bounds.min.has_value() || !bounds.max.has_value())
+  {
+    return {};
+  }
+  const Box query{
+      .min_latitude = bounds.min->latitude,
+      .min_longitude = bounds.min->longitude,
+      .max_latitude = bounds.max->latitude,
+      .max_longitude = bounds.max->longitude,
+  };
+  const auto overlaps = [&](const Box& box) { return Overlaps(box, query); };
+  return Search(overlaps, overlaps);
+}
+
+std::vector<SpatialMatch> SpatialIndex::QueryRadius(const LatLong& center,
+                                                    const double radius) const
+{
+  // Box around the circle, to skip the nodes far away. The circle is widest
+  // towards the pole, at asin(sin(angle) / cos(latitude)) of longitude, and
+  // spans all longitudes if it reaches the pole.
+  const double latitude_delta = radius / kMetersPerDegree;
+  const double angle = latitude_delta * std::numbers::pi / 180.0;
+  const double cos_latitude = std::cos(center.latitude * std::numbers::pi / 180.0);
+  const double longitude_delta =
+      std::abs(center.latitude) + latitude_delta < 90.0
+          ? std::asin(std::min(std::sin(angle) / cos_latitude, 1.0)) * 180.0 / std::numbers::pi
+          : 360.0;
+  const Box around{
+      .min_latitude = center.latitude - latitude_delta,
+      .min_longitude = center.longitude - longitude_delta,
+      .max_latitude = center.latitude + latitude_delta,
+      .max_longitude = center.longitude + longitude_delta,
+  };
+
+  return Search([&](const Box& box) { return Overlaps(box, around); },
+                [&](const Box& box) {
+                  return Overlaps(box, around) && DistanceToBox(center, box) <= radius;
+                });
+}
+
+Bounds SpatialIndex::GetBounds() const
+{
+  if (nodes_.empty())
+  {
+    return {};
+  }
+  const Box& box = nodes_.back().box;
+  return Bounds{
+      .min = LatLong{box.min_latitude, box.min_longitude},
+      .max = LatLong{box.max_latitude, box.max_longitude},
+  };
+}
+
+void SpatialIndex::Save(const std::filesystem::path& path) const
+{
+  binary::Writer writer;
+  writer.WriteColumn<char>(kSpatialMagic);
+  writer.Write(kSpatialVersion);
+  writer.Write(binary::kByteOrderMark);
+  writer.Write<uint64_t>(chunk_size_);
+
+  const auto write_box = [&](const Box& box) {
+    writer.Write(box.min_latitude);
+    writer.Write(box.min_longitude);
+    writer.Write(box.max_latitude);
+    writer.Write(box.max_longitude);
+  };
+  writer.Write<uint64_t>(items_.size());
+  for (size_t i = 0; i < items_.size(); ++i)
+  {
+    const auto& item = items_[i];
+    writer.Write<uint64_t>(item.document);
+    writer.Write<uint64_t>(item.track);
+    writer.Write<uint64_t>(item.segment);
+    writer.Write<uint64_t>(item.first_point);
+    writer.Write<uint64_t>(item.end_point);
+    write_box(item_boxes_[i]);
+  }
+  writer.Write<uint64_t>(nodes_.size());
+  for (const auto& node : nodes_)
+  {
+    write_box(node.box);
+    writer.Write<uint64_t>(node.first);
+    writer.Write<uint64_t>(node.count);
+  }
+  writer.Write<uint64_t>(levels_.size());
+  for (const size_t level : levels_)
+  {
+    writer.Write<uint64_t>(level);
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+  file.close();
+  if (!file)
+  {
+    throw std::runtime_error(std::format("Unable to write spatial index: {}", path.string()));
+  }
+}
+
+SpatialIndex SpatialIndex::Load(const std::filesystem::path& path)
+{
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(path, error))
+  {
+    throw parse_error(std::format("Unable to open spatial index: {}", path.string()));
+  }
+  const MappedFile file(path);
+  binary::Reader reader(file.data());
+  const auto magic = reader.ReadColumn<char>(kSpatialMagic.size());
+  if (std::string_view(magic.data(), magic.size()) != kSpatialMagic)
+  {
+    throw parse_error(std::format("Not a spatial index: {}", path.string()));
+  }
+  if (reader.Read<uint32_t>() != kSpatialVersion ||
+      reader.Read<uint32_t>() != binary::kByteOrderMark)
+  {
+    throw parse_error(
+        std::format("Unsupported version or byte order of spatial index: {}", path.string()));
+  }
+
+  SpatialIndex index;
+  index.chunk_size_ = static_cast<size_t>(reader.Read<uint64_t>());
+  const auto read_box = [&] {
+    return Box{
+        .min_latitude = reader.Read<double>(),
+        .min_longitude = reader.Read<double>(),
+        .max_latitude = reader.Read<double>(),
+        .max_longitude = reader.Read<double>(),
+    };
+  };
+  const auto read_size = [&] { return static_cast<size_t>(reader.Read<uint64_t>()); };
+
+  // Each item takes 9 fields, each node 6.
+  const size_t item_count = reader.ReadCount(9 * binary::kAlignment);
+  index.items_.reserve(item_count);
+  index.item_boxes_.reserve(item_count);
+  for (size_t i = 0; i < item_count; ++i)
+  {
+    auto& item = index.items_.emplace_back();
+    item.document = read_size();
+    item.track = read_size();
+    item.segment = read_size();
+    item.first_point = read_size();
+    item.end_point = read_size();
+    index.item_boxes_.push_back(read_box());
+  }
+  const size_t node_count = reader.ReadCount(6 * binary::kAlignment);
+  index.nodes_.reserve(node_count);
+  for (size_t i = 0; i < node_count; ++i)
+  {
+    auto& node = index.nodes_.emplace_back();
+    node.box = read_box();
+    node.first = read_size();
+    node.count = read_size();
+  }
+  const size_t level_count = reader.ReadCount(binary::kAlignment);
+  for (size_t i = 0; i < level_count; ++i)
+  {
+    index.levels_.push_back(read_size());
+  }
+
+  // Checks the children of each node are in the level below, such that
+  // queries stay within the data.
+  const auto& levels = index.levels_;
+  bool valid = reader.AtEnd() && (node_count == 0) == (level_count == 0) &&
+               (node_count == 0 || (levels.front() == 0 && levels.back() == node_count - 1));
+  for (size_t level = 0; valid && level < level_count; ++level)
+  {
+    const size_t begin = levels[level];
+    const size_t end = level + 1 < level_count ? levels[level + 1] : node_count;
+    const size_t child_begin = level > 0 ? levels[level - 1] : 0;
+    const size_t child_end = level > 0 ? begin : item_count;
+    valid = begin < end && end <= node_count;
+    for (size_t i = begin; valid && i < end; ++i)
+    {
+      const auto& node = index.nodes_[i];
+      valid = node.first >= child_begin && node.first <= child_end &&
+              node.count <= child_end - node.first;
+    }
+  }
+  if (!valid)
+  {
+    throw parse_error(std::format("Invalid spatial index: {}", path.string()));
+  }
+  return index;
+}
+
+} // namespace fastgpx
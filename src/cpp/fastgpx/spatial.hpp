@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+// Range of points of a segment found by a `SpatialIndex` query.
+struct SpatialMatch
+{
+  // Index of the document in the documents the index was built from.
+  size_t document = 0;
+  size_t track = 0;
+  size_t segment = 0;
+  size_t first_point = 0;
+  // One past the last point of the range.
+  size_t end_point = 0;
+
+  auto operator<=>(const SpatialMatch&) const = default;
+};
+
+/**
+ * @brief R-tree over the bounding boxes of the segments of many documents.
+ *
+ * Each segment is split into chunks of up to `chunk_size` points, whose boxes
+ * are the leaves of the tree. A chunk's box also covers the first point of the
+ * next chunk, such that the line between them is covered. The tree is bulk
+ * loaded with Sort-Tile-Recursive packing and is immutable once built.
+ *
+ * Queries return the point ranges of the chunks whose boxes match, with the
+ * ranges of adjacent chunks merged. These are candidates: a chunk's box can
+ * match while none of its points do. Smaller chunks give tighter ranges for a
+ * larger index.
+ *
+ * The index refers to the documents by their indices only, such that it can
+ * be saved and loaded without them.
+ *
+ * @note Boxes are in latitude and longitude, and don't wrap around the
+ *   antimeridian.
+ */
+class SpatialIndex
+{
+public:
+  static constexpr size_t kDefaultChunkSize = 32;
+
+  SpatialIndex() = default;
+
+  /**
+   * @brief Builds the index over the segments of `documents`.
+   *
+   * @param documents The matches refer to them by their index in this list.
+   * @param chunk_size Maximum number of points per leaf box.
+   */
+  explicit SpatialIndex(std::span<const Gpx* const> documents,
+                        size_t chunk_size = kDefaultChunkSize);
+  explicit SpatialIndex(std::span<const Gpx> documents, size_t chunk_size = kDefaultChunkSize);
+
+  /**
+   * @brief Finds the points whose chunks overlap `bounds`.
+   *
+   * @param bounds Only the latitudes and longitudes are used.
+   * @return Ranges sorted by document, track, segment and point.
+   */
+  std::vector<SpatialMatch> Query(const Bounds& bounds) const;
+
+  /**
+   * @brief Finds the points whose chunks come within `radius` of `center`.
+   *
+   * @param center
+   * @param radius Meters.
+   * @return Ranges sorted by document, track, segment and point.
+   */
+  std::vector<SpatialMatch> QueryRadius(const LatLong& center, double radius) const;
+
+  // Bounds of all indexed points.
+  Bounds GetBounds() const;
+
+  size_t chunk_size() const noexcept { return chunk_size_; }
+  // Number of leaf boxes.
+  size_t size() const noexcept { return items_.size(); }
+  bool empty() const noexcept { return items_.empty(); }
+
+  /**
+   * @brief Writes the index to a binary file.
+   *
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  void Save(const std::filesystem::path& path) const;
+
+  /**
+   * @brief Reads an index written by `Save`.
+   *
+   * @throws parse_error if the file cannot be read, was written by another
+   *   version of the format or on a platform of another byte order.
+   */
+  static SpatialIndex Load(const std::filesystem::path& path);
+
+private:
+  // Box in degrees, which unlike `Bounds` is never empty.
+  struct Box
+  {
+    double min_latitude = 0.0;
+    double min_longitude = 0.0;
+    double max_latitude = 0.0;
+    double max_longitude = 0.0;
+  };
+
+  // Node of the tree, whose children are the nodes of the level below or, for
+  // the lowest level, the items.
+  struct Node
+  {
+    Box box;
+    size_t first = 0;
+    size_t count = 0;
+  };
+
+  void Add(size_t document_index, const Gpx& gpx);
+  void Build();
+
+  // Returns the merged ranges of the items whose boxes `accept` takes, skipping
+  // the nodes whose boxes `enter` rejects.
+  template <typename Enter, typename Accept>
+  std::vector<SpatialMatch> Search(const Enter& enter, const Accept& accept) const;
+
+  size_t chunk_size_ = kDefaultChunkSize;
+  // Leaves, in the order of the lowest level of nodes.
+  std::vector<SpatialMatch> items_;
+  std::vector<Box> item_boxes_;
+  // All levels of nodes, from the lowest to the root.
+  std::vector<Node> nodes_;
+  // Offset of each level in `nodes_`.
+  std::vector<size_t> levels_;
+};
+
+} // namespace fastgpx
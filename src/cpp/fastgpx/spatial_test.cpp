@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "fastgpx/batch.hpp"
+#include "fastgpx/errors.hpp"
+#include "fastgpx/fastgpx.hpp"
+#include "fastgpx/geom.hpp"
+#include "fastgpx/spatial.hpp"
+
+using Catch::Generators::as;
+
+using namespace fastgpx;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+namespace {
+
+std::vector<Gpx> LoadTopCamp()
+{
+  const auto directory = project_path / "gpx/2024 TopCamp";
+  return LoadGpxFiles(std::vector<std::filesystem::path>{
+      directory / "Connected_20240518_094959_.gpx",
+      directory / "Connected_20240519_092555_Gamla_torget_1_68530_Torsby_Sweden.gpx",
+      directory / "Connected_20240527_102505_Gol.gpx",
+  });
+}
+
+// Checks the ranges are sorted, merged, within their segments, and cover each
+// point `matches` accepts.
+void CheckMatches(const std::vector<Gpx>& documents, const std::vector<SpatialMatch>& matches,
+                  const std::function<bool(const LatLong&)>& match)
+{
+  for (size_t i = 0; i < matches.size(); ++i)
+  {
+    const auto& range = matches[i];
+    REQUIRE(range.document < documents.size());
+    REQUIRE(range.track < documents[range.document].tracks.size());
+    const auto& segments = documents[range.document].tracks[range.track].segments;
+    REQUIRE(range.segment < segments.size());
+    CHECK(range.first_point < range.end_point);
+    CHECK(range.end_point <= segments[range.segment].columns.size());
+    if (i > 0)
+    {
+      const auto& previous = matches[i - 1];
+      CHECK(previous < range);
+      CHECK_FALSE((previous.document == range.document && previous.track == range.track &&
+                   previous.segment == range.segment &&
+                   previous.end_point == range.first_point));
+    }
+  }
+
+  size_t expected_points = 0;
+  for (size_t d = 0; d < documents.size(); ++d)
+  {
+    for (size_t t = 0; t < documents[d].tracks.size(); ++t)
+    {
+      const auto& segments = documents[d].tracks[t].segments;
+      for (size_t s = 0; s < segments.size(); ++s)
+      {
+        const auto& columns = segments[s].columns;
+        for (size_t p = 0; p < columns.size(); ++p)
+        {
+          if (!match(LatLong{columns.latitude[p], columns.longitude[p]}))
+          {
+            continue;
+          }
+          expected_points++;
+          const bool covered = std::ranges::any_of(matches, [&](const SpatialMatch& range) {
+            return range.document == d && range.track == t && range.segment == s &&
+                   range.first_point <= p && p < range.end_point;
+          });
+          CAPTURE(d, t, s, p);
+          REQUIRE(covered);
+        }
+      }
+    }
+  }
+  CHECK(expected_points > 0);
+}
+
+} // namespace
+
+TEST_CASE("Spatial index bounding box query", "[spatial]")
+{
+  const auto documents = LoadTopCamp();
+  const size_t chunk_size = GENERATE(as<size_t>{}, 32, 1, 1000);
+  CAPTURE(chunk_size);
+  const SpatialIndex index(documents, chunk_size);
+  CHECK(index.chunk_size() == chunk_size);
+  CHECK_FALSE(index.empty());
+
+  // Around the start of the first document.
+  const auto start = documents[0].tracks[0].segments[0].points()[0];
+  const Bounds bounds{
+      .min = LatLong{start.latitude - 0.01, start.longitude - 0.01},
+      .max = LatLong{start.latitude + 0.01, start.longitude + 0.01},
+  };
+  const auto matches = index.Query(bounds);
+  REQUIRE_FALSE(matches.empty());
+  CheckMatches(documents, matches, [&](const LatLong& point) {
+    return point.latitude >= bounds.min->latitude && point.latitude <= bounds.max->latitude &&
+           point.longitude >= bounds.min->longitude && point.longitude <= bounds.max->longitude;
+  });
+
+  CHECK(index.Query(Bounds{}).empty());
+  CHECK(index.Query(Bounds{.min = LatLong{-10.0, -10.0}, .max = LatLong{-5.0, -5.0}}).empty());
+}
+
+TEST_CASE("Spatial index radius query", "[spatial]")
+{
+  const auto documents = LoadTopCamp();
+  const SpatialIndex index(documents);
+
+  const auto center = documents[2].tracks[0].segments[0].points()[50];
+  const double radius = 2000.0;
+  const auto matches = index.QueryRadius(center, radius);
+  REQUIRE_FALSE(matches.empty());
+  CHECK(std::ranges::all_of(matches, [](const SpatialMatch& m) { return m.document == 2; }));
+  CheckMatches(documents, matches,
+               [&](const LatLong& point) { return haversine(center, point) <= radius; });
+
+  CHECK(index.QueryRadius(LatLong{-45.0, -45.0}, 1000.0).empty());
+}
+
+TEST_CASE("Spatial index radius query east of a chunk", "[spatial]")
+{
+  // A chunk along the 10th meridian, whose closest location to the center is
+  // at 60.38 degrees north, about 554.0 km away. Its corner at 60 degrees north
+  // is 555.6 km away.
+  Gpx gpx;
+  auto& segment = gpx.tracks.emplace_back().segments.emplace_back();
+  segment.columns.push_back({60.0, 10.0, 0.0});
+  segment.columns.push_back({70.0, 10.0, 0.0});
+  const SpatialIndex index(std::span(&gpx, 1));
+
+  const LatLong center{60.0, 0.0};
+  CHECK(index.QueryRadius(center, 555000.0).size() == 1);
+  CHECK(index.QueryRadius(center, 553000.0).empty());
+  CHECK(index.QueryRadius(LatLong{60.0, 20.0}, 555000.0).size() == 1);
+}
+
+TEST_CASE("Spatial index bounds", "[spatial]")
+{
+  const auto documents = LoadTopCamp();
+  const SpatialIndex index(documents);
+
+  Bounds expected;
+  for (const auto& gpx : documents)
+  {
+    expected.Add(gpx.GetBounds());
+  }
+  const Bounds bounds = index.GetBounds();
+  REQUIRE(bounds.min.has_value());
+  CHECK(bounds.min->latitude == expected.min->latitude);
+  CHECK(bounds.min->longitude == expected.min->longitude);
+  CHECK(bounds.max->latitude == expected.max->latitude);
+  CHECK(bounds.max->longitude == expected.max->longitude);
+}
+
+TEST_CASE("Empty spatial index", "[spatial]")
+{
+  const SpatialIndex index(std::vector<Gpx>{Gpx{}});
+  CHECK(index.empty());
+  CHECK(index.size() == 0);
+  CHECK(index.GetBounds().IsEmpty());
+  CHECK(index.QueryRadius(LatLong{0.0, 0.0}, 1000.0).empty());
+  CHECK(SpatialIndex().Query(Bounds{.min = LatLong{0.0, 0.0}, .max = LatLong{1.0, 1.0}}).empty());
+}
+
+TEST_CASE("Spatial index built from pointers to documents", "[spatial]")
+{
+  const auto documents = LoadTopCamp();
+  const std::vector<const Gpx*> pointers{&documents[2], &documents[0]};
+  const SpatialIndex index(pointers);
+
+  const auto center = documents[0].tracks[0].segments[0].points()[0];
+  const auto matches = index.QueryRadius(center, 100.0);
+  REQUIRE_FALSE(matches.empty());
+  CHECK(matches.front().document == 1);
+}
+
+TEST_CASE("Save and load spatial index", "[spatial]")
+{
+  const auto documents = LoadTopCamp();
+  const SpatialIndex index(documents, 16);
+  const auto path = std::filesystem::temp_directory_path() / "fastgpx_spatial_test.idx";
+  index.Save(path);
+
+  const SpatialIndex loaded = SpatialIndex::Load(path);
+  CHECK(loaded.size() == index.size());
+  CHECK(loaded.chunk_size() == 16);
+  CHECK(loaded.GetBounds() == index.GetBounds());
+  const auto center = documents[1].tracks[0].segments[0].points()[0];
+  CHECK(loaded.QueryRadius(center, 5000.0) == index.QueryRadius(center, 5000.0));
+  CHECK(loaded.Query(index.GetBounds()) == index.Query(index.GetBounds()));
+
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+  CHECK_THROWS_AS(SpatialIndex::Load(path), parse_error);
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "not a spatial index";
+  }
+  CHECK_THROWS_AS(SpatialIndex::Load(path), parse_error);
+  std::filesystem::remove(path);
+  CHECK_THROWS_AS(SpatialIndex::Load(path), parse_error);
+}
+
+TEST_CASE("Benchmark spatial index", "[!benchmark][spatial]")
+{
+  const auto documents = LoadTopCamp();
+  const SpatialIndex index(documents);
+  const auto center = documents[0].tracks[0].segments[0].points()[0];
+
+  BENCHMARK("Build")
+  {
+    return SpatialIndex(documents);
+  };
+
+  BENCHMARK("QueryRadius")
+  {
+    return index.QueryRadius(center, 1000.0);
+  };
+}
@@ -0,0 +1,842 @@
+#include "fastgpx/stream.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "fastgpx/errors.hpp"
+#include "fastgpx/filesystem.hpp"
+#include "fastgpx/parallel.hpp"
+#include "fastgpx/simd.hpp"
+#include "fastgpx/trkpt_scanner.hpp"
+#include "fastgpx/xml_scanner.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+// Upper bound of a <trkpt> element handled by `ScanTrkpt`. Larger points, typically
+// with extensions, take the general path.
+constexpr size_t kMaxFastTrkptSize = 1024;
+
+// Documents smaller than this are not worth splitting for `ReadGpxStreamParallel`.
+constexpr size_t kMinParallelSize = 1024 * 1024;
+// Smallest chunk scanned for points by one task of `ReadGpxStreamParallel`.
+constexpr size_t kMinParallelChunkSize = 256 * 1024;
+
+// Bytes read last by `GpxTailReader::Poll`, compared with the file on the next
+// poll to detect a rewritten file. The times of the points make them unique.
+constexpr size_t kTailSize = 256;
+
+bool IsWhitespace(std::string_view text)
+{
+  return text.find_first_not_of(" \t\r\n") == std::string_view::npos;
+}
+
+void AddEvent(Gpx& gpx, const GpxEvent& event, std::pmr::memory_resource* resource)
+{
+  switch (event.type)
+  {
+  case GpxEventType::Name:
+    gpx.name.emplace(event.text);
+    break;
+  case GpxEventType::TrackBegin:
+    gpx.tracks.emplace_back(resource);
+    break;
+  case GpxEventType::TrackName:
+    gpx.tracks.back().name.emplace(event.text);
+    break;
+  case GpxEventType::SegmentBegin:
+    gpx.tracks.back().segments.emplace_back(resource);
+    break;
+  case GpxEventType::Point:
+  {
+    // Read only the raw string, but don't parse it. This is done on demand
+    // when the value is read.
+    gpx.tracks.back().segments.back().columns.push_back(event.point, event.time);
+    break;
+  }
+  case GpxEventType::TrackEnd:
+  case GpxEventType::SegmentEnd:
+    break;
+  }
+}
+
+// Consecutive <trkpt> elements, separated only by whitespace.
+struct PointRun
+{
+  // Input range of the elements, from the `<` of the first to the `>` of the last.
+  size_t begin = 0;
+  size_t end = 0;
+  // Range of the points in `PointChunk::columns`.
+  size_t first = 0;
+  size_t count = 0;
+};
+
+// Points parsed from a chunk of the input by `ScanPointRuns`.
+struct PointChunk
+{
+  PointColumns columns;
+  // Input offset of the `<` of each point, such that a run can be resumed
+  // after points the reader parsed itself.
+  std::vector<size_t> offsets;
+  std::vector<PointRun> runs;
+};
+
+// Parses the runs of <trkpt> elements starting in `[begin, end)` with the fast
+// path. The last run may extend past `end`. The runs are found without regard
+// to the document structure, so the caller only uses those it reaches.
+void ScanPointRuns(std::string_view data, const size_t begin, const size_t end,
+                   const ParseOptions& options, PointChunk& chunk)
+{
+  constexpr std::string_view kStartTag = "<trkpt";
+  TrkptData point;
+  size_t pos = begin;
+  while ((pos = data.find(kStartTag, pos)) < end)
+  {
+    PointRun run{.begin = pos, .end = pos, .first = chunk.columns.size()};
+    while (pos < end)
+    {
+      const size_t length = ScanTrkpt(data.substr(pos), options, point);
+      if (length == 0)
+      {
+        break;
+      }
+      chunk.columns.push_back({point.latitude, point.longitude, point.elevation}, point.time);
+      chunk.offsets.push_back(pos);
+      pos += length;
+      run.end = pos;
+      pos += simd::CountWhitespace(data.substr(pos));
+    }
+    run.count = chunk.columns.size() - run.first;
+    if (run.count == 0)
+    {
+      pos = run.begin + kStartTag.size();
+      continue;
+    }
+    chunk.runs.push_back(run);
+  }
+}
+
+} // namespace
+
+enum class GpxStreamReader::Element : unsigned char
+{
+  Gpx,
+  Metadata,
+  MetadataName,
+  Track,
+  TrackName,
+  // A <trk> excluded by the track filters. Its children are skipped.
+  SkippedTrack,
+  Segment,
+  Point,
+  Elevation,
+  Time,
+  Other,
+};
+
+void GpxStreamReader::FileCloser::operator()(FILE* file) const noexcept
+{
+  std::fclose(file);
+}
+
+GpxStreamReader::GpxStreamReader(const std::filesystem::path& path, const ParseOptions& options)
+    : file_(open_file(path)), options_(options)
+{
+  if (!file_)
+  {
+    const auto message = std::format("Failed to load GPX file: File was not found - {}",
+                                     path.string());
+    throw parse_error(message);
+  }
+  scanner_ = std::make_unique<XmlScanner>(file_.get());
+  open_elements_.reserve(16);
+}
+
+GpxStreamReader::GpxStreamReader(std::string_view data, const ParseOptions& options)
+    : scanner_(std::make_unique<XmlScanner>(data)), options_(options)
+{
+  open_elements_.reserve(16);
+}
+
+GpxStreamReader::GpxStreamReader(std::function<size_t(char* buffer, size_t size)> read,
+                                 const ParseOptions& options)
+    : scanner_(std::make_unique<XmlScanner>(std::move(read))), options_(options)
+{
+  open_elements_.reserve(16);
+}
+
+GpxStreamReader::~GpxStreamReader() = default;
+
+void GpxStreamReader::Reset(std::string_view data, const ParseOptions& options)
+{
+  file_.reset();
+  *scanner_ = XmlScanner(data);
+  options_ = options;
+
+  open_elements_.clear();
+  open_names_.clear();
+  partial_ = false;
+  seen_root_ = false;
+  seen_metadata_ = false;
+  seen_name_ = false;
+  seen_elevation_ = false;
+  seen_time_ = false;
+  seen_track_name_ = false;
+  track_pending_ = false;
+  track_count_ = 0;
+  segment_count_ = 0;
+
+  point_ = LatLong{};
+  time_.clear();
+  name_.clear();
+  track_name_.clear();
+
+  pending_.clear();
+  pending_index_ = 0;
+}
+
+void GpxStreamReader::Continue(std::string_view data)
+{
+  assert(!file_ && pending_index_ == pending_.size());
+  scanner_->Continue(data);
+  partial_ = true;
+}
+
+std::optional<GpxEvent> GpxStreamReader::Next()
+{
+  XmlToken token;
+  while (pending_index_ == pending_.size())
+  {
+    pending_.clear();
+    pending_index_ = 0;
+
+    if (!open_elements_.empty() && open_elements_.back().first == Element::Segment &&
+        TryScanPoint())
+    {
+      break;
+    }
+    if (!scanner_->Next(token))
+    {
+      if (partial_)
+      {
+        return std::nullopt;
+      }
+      if (!open_elements_.empty())
+      {
+        throw parse_error("Failed to parse GPX data: Unexpected end of data");
+      }
+      if (!seen_root_)
+      {
+        throw parse_error("Failed to parse GPX data: No document element found");
+      }
+      return std::nullopt;
+    }
+
+    switch (token.type)
+    {
+    case XmlTokenType::StartElement:
+      HandleStart(token);
+      break;
+    case XmlTokenType::EmptyElement:
+      HandleStart(token);
+      HandleEnd(token.name);
+      break;
+    case XmlTokenType::EndElement:
+      HandleEnd(token.name);
+      break;
+    case XmlTokenType::Text:
+      HandleText(token);
+      break;
+    }
+  }
+  return pending_[pending_index_++];
+}
+
+void GpxStreamReader::HandleStart(const XmlToken& token)
+{
+  const auto& name = token.name;
+  Element element = Element::Other;
+
+  if (open_elements_.empty())
+  {
+    if (seen_root_)
+    {
+      throw parse_error("Failed to parse GPX data: Multiple document elements");
+    }
+    seen_root_ = true;
+    if (name == "gpx")
+    {
+      element = Element::Gpx;
+    }
+  }
+  else
+  {
+    switch (open_elements_.back().first)
+    {
+    case Element::Gpx:
+      if (name == "trk")
+      {
+        if (options_.track_index.has_value() && *options_.track_index != track_count_)
+        {
+          element = Element::SkippedTrack;
+          break;
+        }
+        element = Element::Track;
+        segment_count_ = 0;
+        seen_track_name_ = false;
+        track_name_.clear();
+        track_pending_ = options_.track_name.has_value();
+        if (!track_pending_)
+        {
+          Emit(GpxEventType::TrackBegin);
+        }
+      }
+      else if (name == "metadata" && !seen_metadata_ && options_.metadata)
+      {
+        element = Element::Metadata;
+        seen_metadata_ = true;
+      }
+      break;
+    case Element::Metadata:
+      if (name == "name" && !seen_name_)
+      {
+        element = Element::MetadataName;
+        seen_name_ = true;
+        name_.clear();
+      }
+      break;
+    case Element::Track:
+      if (name == "name" && !seen_track_name_ && (options_.metadata || track_pending_))
+      {
+        element = Element::TrackName;
+        seen_track_name_ = true;
+      }
+      else if (name == "trkseg")
+      {
+        if (track_pending_)
+        {
+          // The GPX schema puts <name> before the <trkseg> elements, so this
+          // track has no name to match the filter.
+          SkipTrack();
+          break;
+        }
+        element = Element::Segment;
+        Emit(GpxEventType::SegmentBegin);
+      }
+      break;
+    case Element::Segment:
+      if (name == "trkpt")
+      {
+        element = Element::Point;
+        point_ = LatLong{};
+        if (const auto lat = FindAttribute(token.attributes, "lat"))
+        {
+          point_.latitude = ParseXmlDouble(*lat);
+        }
+        if (const auto lon = FindAttribute(token.attributes, "lon"))
+        {
+          point_.longitude = ParseXmlDouble(*lon);
+        }
+        time_.clear();
+        seen_elevation_ = false;
+        seen_time_ = false;
+      }
+      break;
+    case Element::Point:
+      if (name == "ele" && !seen_elevation_ && options_.elevation)
+      {
+        element = Element::Elevation;
+        seen_elevation_ = true;
+      }
+      else if (name == "time" && !seen_time_ && options_.time)
+      {
+        element = Element::Time;
+        seen_time_ = true;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  open_elements_.emplace_back(element, open_names_.size());
+  open_names_.append(name);
+}
+
+void GpxStreamReader::HandleEnd(std::string_view name)
+{
+  if (open_elements_.empty())
+  {
+    throw parse_error(std::format("Failed to parse GPX data: Unexpected end tag: {}", name));
+  }
+
+  const auto [element, name_offset] = open_elements_.back();
+  if (std::string_view(open_names_).substr(name_offset) != name)
+  {
+    throw parse_error(std::format("Failed to parse GPX data: Start-end tags mismatch: {}", name));
+  }
+  open_elements_.pop_back();
+  open_names_.resize(name_offset);
+
+  switch (element)
+  {
+  case Element::MetadataName:
+    Emit(GpxEventType::Name);
+    break;
+  case Element::TrackName:
+    if (track_pending_)
+    {
+      track_pending_ = false;
+      if (track_name_ != *options_.track_name)
+      {
+        SkipTrack();
+        break;
+      }
+      Emit(GpxEventType::TrackBegin);
+    }
+    if (options_.metadata)
+    {
+      Emit(GpxEventType::TrackName);
+    }
+    break;
+  case Element::Track:
+    if (track_pending_)
+    {
+      // Track without a name nor segments.
+      track_pending_ = false;
+    }
+    else
+    {
+      Emit(GpxEventType::TrackEnd);
+    }
+    track_count_++;
+    break;
+  case Element::SkippedTrack:
+    track_count_++;
+    break;
+  case Element::Segment:
+    Emit(GpxEventType::SegmentEnd);
+    segment_count_++;
+    break;
+  case Element::Point:
+    Emit(GpxEventType::Point);
+    break;
+  default:
+    break;
+  }
+}
+
+void GpxStreamReader::HandleText(const XmlToken& token)
+{
+  // Like pugixml, ignore whitespace-only character data.
+  if (open_elements_.empty() || (!token.cdata && IsWhitespace(token.text)))
+  {
+    return;
+  }
+
+  switch (open_elements_.back().first)
+  {
+  case Element::Elevation:
+    point_.elevation = ParseXmlDouble(token.text);
+    break;
+  case Element::Time:
+    if (token.cdata)
+    {
+      time_.append(token.text);
+    }
+    else
+    {
+      AppendDecodedText(time_, token.text);
+    }
+    break;
+  case Element::MetadataName:
+    if (token.cdata)
+    {
+      name_.append(token.text);
+    }
+    else
+    {
+      AppendDecodedText(name_, token.text);
+    }
+    break;
+  case Element::TrackName:
+    if (token.cdata)
+    {
+      track_name_.append(token.text);
+    }
+    else
+    {
+      AppendDecodedText(track_name_, token.text);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void GpxStreamReader::Emit(const GpxEventType type)
+{
+  auto& event = pending_.emplace_back();
+  event.type = type;
+  event.track_index = track_count_;
+  event.segment_index = segment_count_;
+  if (type == GpxEventType::Point)
+  {
+    event.point = point_;
+    event.time = time_;
+  }
+  else if (type == GpxEventType::Name)
+  {
+    event.text = name_;
+  }
+  else if (type == GpxEventType::TrackName)
+  {
+    event.text = track_name_;
+  }
+}
+
+// Reads the next <trkpt> of the current segment with the fast path, if it has the
+// common shape. Otherwise nothing is consumed and the general path takes over.
+bool GpxStreamReader::TryScanPoint()
+{
+  const auto data = scanner_->Peek(kMaxFastTrkptSize);
+  const size_t whitespace = simd::CountWhitespace(data);
+  TrkptData point;
+  const size_t length = ScanTrkpt(data.substr(whitespace), options_, point);
+  if (length == 0)
+  {
+    return false;
+  }
+  point_ = LatLong{point.latitude, point.longitude, point.elevation};
+  time_.assign(point.time);
+  Emit(GpxEventType::Point);
+  scanner_->Skip(whitespace + length);
+  return true;
+}
+
+std::optional<size_t> GpxStreamReader::PointOffset() const
+{
+  if (pending_index_ != pending_.size() || open_elements_.empty() ||
+      open_elements_.back().first != Element::Segment)
+  {
+    return std::nullopt;
+  }
+  return scanner_->offset();
+}
+
+void GpxStreamReader::SkipPoints(const size_t count)
+{
+  assert(PointOffset().has_value());
+  [[maybe_unused]] const auto data = scanner_->Peek(count);
+  assert(data.size() >= count);
+  scanner_->Skip(count);
+}
+
+// Marks the innermost open <trk> as excluded, skipping the rest of its children.
+void GpxStreamReader::SkipTrack()
+{
+  assert(!open_elements_.empty() && open_elements_.back().first == Element::Track);
+  open_elements_.back().first = Element::SkippedTrack;
+  track_pending_ = false;
+}
+
+Gpx ReadGpxStream(GpxStreamReader& reader, std::pmr::memory_resource* resource)
+{
+  Gpx gpx(resource);
+  while (const auto event = reader.Next())
+  {
+    AddEvent(gpx, *event, resource);
+  }
+  return gpx;
+}
+
+Gpx ReadGpxStreamParallel(std::string_view data, const ParseOptions& options,
+                          const size_t threads, std::pmr::memory_resource* resource)
+{
+  GpxStreamReader reader(data, options);
+  const size_t workers = ResolveThreadCount(threads);
+  if (workers <= 1 || data.size() < kMinParallelSize)
+  {
+    return ReadGpxStream(reader, resource);
+  }
+
+  // More chunks than workers, to balance documents where the points are not
+  // evenly spread.
+  const size_t chunk_count = std::min(workers * 4, data.size() / kMinParallelChunkSize);
+  std::vector<PointChunk> chunks(chunk_count);
+  ParallelFor(chunk_count, workers, [&](const size_t index) {
+    const size_t begin = data.size() * index / chunk_count;
+    const size_t end = data.size() * (index + 1) / chunk_count;
+    ScanPointRuns(data, begin, end, options, chunks[index]);
+  });
+
+  // The reader only moves forward, as does the run to match.
+  size_t chunk_index = 0;
+  size_t run_index = 0;
+  // Finds the run with a point starting at `offset`, and the index of the point.
+  const auto find_point = [&](const size_t offset) -> std::optional<size_t> {
+    for (; chunk_index < chunks.size(); chunk_index++, run_index = 0)
+    {
+      const auto& chunk = chunks[chunk_index];
+      while (run_index < chunk.runs.size() && chunk.runs[run_index].end <= offset)
+      {
+        run_index++;
+      }
+      if (run_index == chunk.runs.size())
+      {
+        continue;
+      }
+      const auto& run = chunk.runs[run_index];
+      const auto begin = chunk.offsets.begin() + static_cast<std::ptrdiff_t>(run.first);
+      const auto end = begin + static_cast<std::ptrdiff_t>(run.count);
+      const auto it = std::lower_bound(begin, end, offset);
+      if (it == end || *it != offset)
+      {
+        return std::nullopt;
+      }
+      return static_cast<size_t>(it - chunk.offsets.begin());
+    }
+    return std::nullopt;
+  };
+
+  Gpx gpx(resource);
+  while (true)
+  {
+    if (const auto offset = reader.PointOffset())
+    {
+      const size_t begin = *offset + simd::CountWhitespace(data.substr(*offset));
+      if (const auto first = find_point(begin))
+      {
+        const auto& chunk = chunks[chunk_index];
+        const auto& run = chunk.runs[run_index];
+        auto& segment = gpx.tracks.back().segments.back();
+        segment.columns.append(chunk.columns, *first, run.first + run.count - *first);
+        reader.SkipPoints(run.end - *offset);
+        continue;
+      }
+    }
+    const auto event = reader.Next();
+    if (!event)
+    {
+      break;
+    }
+    AddEvent(gpx, *event, resource);
+  }
+  return gpx;
+}
+
+// GpxTailReader
+
+GpxTailReader::GpxTailReader(const ParseOptions& options)
+    : options_(options), reader_(std::string_view(), options)
+{
+}
+
+GpxTailReader::GpxTailReader(std::filesystem::path path, const ParseOptions& options)
+    : path_(std::move(path)), options_(options), reader_(std::string_view(), options)
+{
+}
+
+GpxTailReader::~GpxTailReader() = default;
+
+size_t GpxTailReader::Poll()
+{
+  assert(path_.has_value());
+  const std::unique_ptr<FILE, decltype(&std::fclose)> file(open_file(*path_), &std::fclose);
+  if (!file)
+  {
+    return 0;
+  }
+
+  std::error_code error;
+  const auto size = std::filesystem::file_size(*path_, error);
+  if (error)
+  {
+    throw parse_error(std::format("Failed to read GPX file: {} - {}", error.message(),
+                                  path_->string()));
+  }
+  const auto seek = [&](const size_t offset) {
+#ifdef _WIN32
+    const int result = _fseeki64(file.get(), static_cast<__int64>(offset), SEEK_SET);
+#else
+    const int result = fseeko(file.get(), static_cast<off_t>(offset), SEEK_SET);
+#endif
+    if (result != 0)
+    {
+      throw parse_error(std::format("Failed to read GPX file: {}", path_->string()));
+    }
+  };
+
+  // A new recording may replace the file in place, at the same or a larger
+  // size. The bytes read last then no longer match.
+  const size_t read_offset = offset_ + buffer_.size();
+  if (size < read_offset)
+  {
+    Restart();
+  }
+  else if (!tail_.empty())
+  {
+    seek(read_offset - tail_.size());
+    std::string tail(tail_.size(), '\0');
+    if (std::fread(tail.data(), 1, tail.size(), file.get()) != tail.size() || tail != tail_)
+    {
+      Restart();
+    }
+  }
+  seek(offset_ + buffer_.size());
+  const size_t previous_size = buffer_.size();
+
+  // Read up to the current end of the file. The logger may append more while
+  // reading, which is parsed by the next poll if it is cut off.
+  constexpr size_t kChunkSize = 64 * 1024;
+  for (;;)
+  {
+    const size_t buffered = buffer_.size();
+    buffer_.resize(buffered + kChunkSize);
+    const size_t read = std::fread(buffer_.data() + buffered, 1, kChunkSize, file.get());
+    buffer_.resize(buffered + read);
+    if (read < kChunkSize)
+    {
+      break;
+    }
+  }
+  if (std::ferror(file.get()))
+  {
+    throw parse_error(std::format("Failed to read GPX file: {}", path_->string()));
+  }
+
+  tail_.append(buffer_, previous_size);
+  if (tail_.size() > kTailSize)
+  {
+    tail_.erase(0, tail_.size() - kTailSize);
+  }
+  return Parse();
+}
+
+size_t GpxTailReader::Append(std::string_view data)
+{
+  buffer_.append(data);
+  return Parse();
+}
+
+size_t GpxTailReader::Parse()
+{
+  const size_t complete = CompleteXmlPrefix(buffer_);
+  if (complete == 0)
+  {
+    return 0;
+  }
+
+  // The segment open at the end of the previous data receives the first points,
+  // followed by the segments and tracks started by the new data.
+  const size_t first_track = gpx_.tracks.empty() ? 0 : gpx_.tracks.size() - 1;
+  size_t first_segment = 0;
+  size_t first_point = 0;
+  if (!gpx_.tracks.empty() && !gpx_.tracks.back().segments.empty())
+  {
+    const auto& segments = gpx_.tracks.back().segments;
+    first_segment = segments.size() - 1;
+    first_point = segments.back().columns.size();
+  }
+
+  size_t points = 0;
+  try
+  {
+    reader_.Continue(std::string_view(buffer_).substr(0, complete));
+    while (const auto event = reader_.Next())
+    {
+      AddEvent(gpx_, *event, gpx_.tracks.get_allocator().resource());
+      if (event->type == GpxEventType::Point)
+      {
+        points++;
+      }
+    }
+  }
+  catch (...)
+  {
+    Restart();
+    throw;
+  }
+  buffer_.erase(0, complete);
+  offset_ += complete;
+
+  for (size_t track_index = first_track; track_index < gpx_.tracks.size(); ++track_index)
+  {
+    auto& track = gpx_.tracks[track_index];
+    const bool first = track_index == first_track;
+    for (size_t segment_index = first ? first_segment : 0; segment_index < track.segments.size();
+         ++segment_index)
+    {
+      const bool open = first && segment_index == first_segment;
+      track.segments[segment_index].UpdateMetrics(open ? first_point : 0);
+    }
+    track.ResetMetrics();
+  }
+  gpx_.ResetMetrics();
+  return points;
+}
+
+void GpxTailReader::Restart()
+{
+  reader_.Reset(std::string_view(), options_);
+  gpx_ = Gpx();
+  buffer_.clear();
+  offset_ = 0;
+  tail_.clear();
+}
+
+void StreamGpx(GpxStreamReader& reader, GpxVisitor& visitor)
+{
+  while (const auto event = reader.Next())
+  {
+    switch (event->type)
+    {
+    case GpxEventType::Name:
+      visitor.OnName(event->text);
+      break;
+    case GpxEventType::TrackBegin:
+      visitor.OnTrackBegin();
+      break;
+    case GpxEventType::TrackEnd:
+      visitor.OnTrackEnd();
+      break;
+    case GpxEventType::TrackName:
+      visitor.OnTrackName(event->text);
+      break;
+    case GpxEventType::SegmentBegin:
+      visitor.OnSegmentBegin();
+      break;
+    case GpxEventType::SegmentEnd:
+      visitor.OnSegmentEnd();
+      break;
+    case GpxEventType::Point:
+      visitor.OnPoint(event->point, event->time);
+      break;
+    }
+  }
+}
+
+void StreamGpx(const std::filesystem::path& path, GpxVisitor& visitor,
+               const ParseOptions& options)
+{
+  GpxStreamReader reader(path, options);
+  StreamGpx(reader, visitor);
+}
+
+void StreamGpxData(std::string_view data, GpxVisitor& visitor, const ParseOptions& options)
+{
+  GpxStreamReader reader(data, options);
+  StreamGpx(reader, visitor);
+}
+
+} // namespace fastgpx
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+class XmlScanner;
+struct XmlToken;
+
+enum class GpxEventType
+{
+  Name,         // <metadata><name>
+  TrackBegin,   // <trk>
+  TrackEnd,     // </trk>
+  TrackName,    // <trk><name>
+  SegmentBegin, // <trkseg>
+  SegmentEnd,   // </trkseg>
+  Point,        // <trkpt>
+};
+
+struct GpxEvent
+{
+  GpxEventType type = GpxEventType::Point;
+  // Index of the current <trk> and <trkseg> within the document and track.
+  size_t track_index = 0;
+  size_t segment_index = 0;
+  // GpxEventType::Point: The <trkpt> location.
+  LatLong point;
+  // GpxEventType::Point: The raw <time> string, empty if the point has no time.
+  std::string_view time;
+  // GpxEventType::Name, GpxEventType::TrackName: The decoded text of the <name>.
+  std::string_view text;
+};
+
+/**
+ * @brief Forward-only reader emitting GPX events without building a DOM.
+ *
+ * Memory use is constant with respect to the size of the file, making it
+ * suitable for very large recordings. The data extracted matches `LoadGpx`.
+ *
+ * Elements excluded by the `ParseOptions` are skipped without being decoded.
+ * Events are not emitted for tracks excluded by the track filters, but the
+ * `track_index` of the events still refers to the index in the document.
+ *
+ * @note The string views in the returned events are only valid until the next
+ *   call to `Next`.
+ */
+class GpxStreamReader
+{
+public:
+  /**
+   * @brief Reads the GPX file in chunks.
+   *
+   * @throws parse_error if the file cannot be opened.
+   */
+  explicit GpxStreamReader(const std::filesystem::path& path, const ParseOptions& options = {});
+
+  /**
+   * @brief Reads in-memory GPX data. The data is not copied and must outlive the reader.
+   */
+  explicit GpxStreamReader(std::string_view data, const ParseOptions& options = {});
+
+  /**
+   * @brief Reads GPX data produced in chunks by `read`, such as decompressed data.
+   *
+   * @param read Reads up to `size` bytes into `buffer` and returns the number of
+   *   bytes read. Fewer bytes are returned only at the end of the data.
+   * @param options
+   */
+  explicit GpxStreamReader(std::function<size_t(char* buffer, size_t size)> read,
+                           const ParseOptions& options = {});
+
+  GpxStreamReader(const GpxStreamReader&) = delete;
+  GpxStreamReader& operator=(const GpxStreamReader&) = delete;
+  ~GpxStreamReader();
+
+  /**
+   * @brief Restarts the reader on new in-memory GPX data.
+   *
+   * The internal buffers keep their capacity, so reusing a reader avoids the
+   * allocations of constructing a new one.
+   *
+   * @param data Must outlive the reader, or the next reset.
+   * @param options
+   */
+  void Reset(std::string_view data, const ParseOptions& options = {});
+
+  /**
+   * @brief Continues in-memory GPX data with the data following it, keeping
+   *   the open elements.
+   *
+   * From then on, `Next` returns std::nullopt at the end of the data instead
+   * of throwing for the elements still open, as more data may follow.
+   *
+   * @param data Must outlive the reader, or the next call. Must not end within
+   *   a token, see `CompleteXmlPrefix`.
+   */
+  void Continue(std::string_view data);
+
+  /**
+   * @brief True once the end tag of the document element has been read.
+   */
+  bool finished() const noexcept { return seen_root_ && open_elements_.empty(); }
+
+  /**
+   * @brief Advances to the next event.
+   *
+   * @throws parse_error if the GPX data is malformed.
+   * @return std::nullopt at the end of the document.
+   */
+  std::optional<GpxEvent> Next();
+
+  /**
+   * @brief Input offset of the next `<trkpt>` of the current segment, where
+   *   points parsed separately can be skipped with `SkipPoints`.
+   *
+   * @return std::nullopt unless the reader is between the children of an
+   *   included `<trkseg>`, with no events pending.
+   */
+  std::optional<size_t> PointOffset() const;
+
+  /**
+   * @brief Advances past whole `<trkpt>` elements without emitting their events.
+   *
+   * @param count Number of bytes from `PointOffset()`, which must have a value.
+   *   The bytes must consist of `<trkpt>` elements and whitespace only.
+   */
+  void SkipPoints(size_t count);
+
+private:
+  enum class Element : unsigned char;
+
+  void HandleStart(const XmlToken& token);
+  void HandleEnd(std::string_view name);
+  void HandleText(const XmlToken& token);
+  bool TryScanPoint();
+  void Emit(GpxEventType type);
+  void SkipTrack();
+
+  struct FileCloser
+  {
+    void operator()(FILE* file) const noexcept;
+  };
+
+  std::unique_ptr<FILE, FileCloser> file_;
+  std::unique_ptr<XmlScanner> scanner_;
+  ParseOptions options_;
+
+  // Stack of open elements, with their names concatenated in `open_names_`.
+  std::vector<std::pair<Element, size_t>> open_elements_;
+  std::string open_names_;
+
+  // Set by `Continue`. The end of the data is not the end of the document.
+  bool partial_ = false;
+  bool seen_root_ = false;
+  bool seen_metadata_ = false;
+  bool seen_name_ = false;
+  bool seen_elevation_ = false;
+  bool seen_time_ = false;
+  bool seen_track_name_ = false;
+  // The track name filter is pending until the track's <name> has been read,
+  // or its first <trkseg> is reached without one.
+  bool track_pending_ = false;
+  size_t track_count_ = 0;
+  size_t segment_count_ = 0;
+
+  LatLong point_;
+  std::string time_;
+  std::string name_;
+  std::string track_name_;
+
+  // Events ready to be returned. At most two are produced per token.
+  std::vector<GpxEvent> pending_;
+  size_t pending_index_ = 0;
+};
+
+/**
+ * @brief Incrementally parses a GPX file while it is being written, such as by
+ *   a logger appending points to an open recording.
+ *
+ * Each poll parses only the data appended since the previous one. The reader
+ * keeps its offset in the file and the elements left open, so the document may
+ * end anywhere, typically without its closing tags until the recording ends.
+ * Markup truncated at the end of the data is kept until the rest of it is
+ * appended.
+ *
+ * The metrics already computed for the segments receiving points are updated
+ * from the new points only. Those of the tracks and the document are computed
+ * again from the metrics of their segments on next use.
+ *
+ * @note Not thread-safe. The document must not be read during `Poll` or
+ *   `Append`.
+ */
+class GpxTailReader
+{
+public:
+  /**
+   * @brief Follows data passed to `Append`.
+   */
+  explicit GpxTailReader(const ParseOptions& options = {});
+
+  /**
+   * @brief Follows a file, read by `Poll`. The file does not need to exist yet.
+   */
+  explicit GpxTailReader(std::filesystem::path path, const ParseOptions& options = {});
+
+  GpxTailReader(const GpxTailReader&) = delete;
+  GpxTailReader& operator=(const GpxTailReader&) = delete;
+  ~GpxTailReader();
+
+  /**
+   * @brief Parses the data appended to the file since the previous poll.
+   *
+   * If the file became shorter than the data read so far, or the last bytes
+   * read changed, such as when a new recording replaced it, the document is
+   * read again from the start.
+   *
+   * @throws parse_error if the file cannot be read or the GPX data is
+   *   malformed. The document is then read again from the start on the next
+   *   poll.
+   * @return size_t Number of points added.
+   */
+  size_t Poll();
+
+  /**
+   * @brief Parses data following the data appended so far.
+   *
+   * @throws parse_error if the GPX data is malformed. The next data then starts
+   *   a new document.
+   * @param data
+   * @return size_t Number of points added.
+   */
+  size_t Append(std::string_view data);
+
+  // The document parsed so far. Points are added to the last segment of the
+  // last track while it is open.
+  const Gpx& gpx() const noexcept { return gpx_; }
+
+  // Number of bytes parsed, not counting markup truncated at the end.
+  size_t offset() const noexcept { return offset_; }
+
+  // True once the end tag of the document element has been read.
+  bool finished() const noexcept { return reader_.finished(); }
+
+private:
+  size_t Parse();
+  void Restart();
+
+  std::optional<std::filesystem::path> path_;
+  ParseOptions options_;
+  GpxStreamReader reader_;
+  Gpx gpx_;
+  // Data read after `offset_` that is not parsed yet.
+  std::string buffer_;
+  size_t offset_ = 0;
+  // Last bytes read by `Poll`, compared with the file on the next poll.
+  std::string tail_;
+};
+
+/**
+ * @brief Receives events from `StreamGpx`. Override the events of interest.
+ */
+class GpxVisitor
+{
+public:
+  virtual ~GpxVisitor() = default;
+
+  virtual void OnName(std::string_view /*name*/) {}
+  virtual void OnTrackBegin() {}
+  virtual void OnTrackEnd() {}
+  virtual void OnTrackName(std::string_view /*name*/) {}
+  virtual void OnSegmentBegin() {}
+  virtual void OnSegmentEnd() {}
+  virtual void OnPoint(const LatLong& /*point*/, std::string_view /*time*/) {}
+};
+
+/**
+ * @brief Builds a `Gpx` from the remaining events of a reader.
+ *
+ * @param reader
+ * @param resource Memory resource of the tracks, segments and points.
+ */
+Gpx ReadGpxStream(GpxStreamReader& reader,
+                  std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+/**
+ * @brief Builds a `Gpx` from in-memory data, parsing the `<trkpt>` elements of
+ *   large documents on multiple threads.
+ *
+ * The data is split into chunks, in which runs of consecutive `<trkpt>`
+ * elements are parsed concurrently. A `GpxStreamReader` then reads the
+ * document structure on the calling thread, appending each run to its segment
+ * as it reaches it. Runs found outside of segments, such as in comments, are
+ * never reached and are discarded. The result matches `ReadGpxStream`.
+ *
+ * @throws parse_error if the GPX data is malformed.
+ * @param data
+ * @param options
+ * @param threads Number of threads, or 0 for one per hardware thread. Documents
+ *   under 1 MiB are parsed on the calling thread.
+ * @param resource Memory resource of the tracks, segments and points.
+ */
+Gpx ReadGpxStreamParallel(std::string_view data, const ParseOptions& options, size_t threads = 0,
+                          std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+/**
+ * @brief Streams the remaining events of a reader to a visitor.
+ *
+ * @param reader
+ * @param visitor
+ */
+void StreamGpx(GpxStreamReader& reader, GpxVisitor& visitor);
+
+/**
+ * @brief Streams the events of a GPX file to a visitor without building a DOM.
+ *
+ * @param path
+ * @param visitor
+ * @param options
+ */
+void StreamGpx(const std::filesystem::path& path, GpxVisitor& visitor,
+               const ParseOptions& options = {});
+
+/**
+ * @brief Streams the events of in-memory GPX data to a visitor without building a DOM.
+ *
+ * @param data
+ * @param visitor
+ * @param options
+ */
+void StreamGpxData(std::string_view data, GpxVisitor& visitor, const ParseOptions& options = {});
+
+} // namespace fastgpx
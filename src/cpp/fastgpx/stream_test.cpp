@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "fastgpx/errors.hpp"
+#include "fastgpx/fastgpx.hpp"
+#include "fastgpx/geom.hpp"
+#include "fastgpx/stream.hpp"
+#include "fastgpx/test_data.hpp"
+
+using Catch::Generators::as;
+using Catch::Generators::from_range;
+using Catch::Matchers::WithinAbs;
+
+using namespace fastgpx;
+
+// Sufficient tolerance for comparing meters.
+constexpr double kMETERS_TOL = 1e-4;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+namespace {
+
+// Collects segment lengths computed from the streamed points.
+class LengthVisitor : public GpxVisitor
+{
+public:
+  std::vector<std::vector<double>> tracks;
+  std::vector<std::string> times;
+  std::string name;
+
+  void OnName(std::string_view value) override { name = value; }
+  void OnTrackBegin() override { tracks.emplace_back(); }
+  void OnSegmentBegin() override
+  {
+    tracks.back().push_back(0.0);
+    has_previous_ = false;
+  }
+  void OnPoint(const LatLong& point, std::string_view time) override
+  {
+    if (has_previous_)
+    {
+      tracks.back().back() += distance2d(previous_, point);
+    }
+    previous_ = point;
+    has_previous_ = true;
+    times.emplace_back(time);
+  }
+
+private:
+  LatLong previous_;
+  bool has_previous_ = false;
+};
+
+// A recording large enough to be parsed in parallel, with the points of its
+// segments in various shapes.
+std::string MakeLargeGpxData()
+{
+  std::string data = R"(<?xml version="1.0" encoding="UTF-8"?>
+<gpx version="1.1"><metadata><name>Multi-day</name></metadata>)";
+  for (int track = 0; track < 3; ++track)
+  {
+    data += std::format("<trk><name>Day {}</name>\n", track);
+    for (int segment = 0; segment < 4; ++segment)
+    {
+      data += "<trkseg>\n";
+      for (int i = 0; i < 5000; ++i)
+      {
+        const double lat = 60.0 + track + i * 1e-5;
+        const double lon = 10.0 + segment + i * 1e-5;
+        const int seconds = i % 60;
+        if (i % 997 == 0)
+        {
+          // Other child elements take the general path.
+          data += std::format(R"(<trkpt lat="{}" lon="{}"><ele>{}</ele><extensions><hr>90</hr>)"
+                              R"(</extensions></trkpt>)",
+                              lat, lon, i);
+        }
+        else if (i % 1499 == 0)
+        {
+          // Points in comments are not part of the segment.
+          data += R"(<!-- <trkpt lat="1" lon="2"></trkpt> -->)";
+        }
+        else
+        {
+          data += std::format(R"(  <trkpt lat="{}" lon="{}"><ele>{}</ele>)"
+                              R"(<time>2024-05-18T07:{:02}:{:02}Z</time></trkpt>)",
+                              lat, lon, i * 0.5, i / 60 % 60, seconds);
+        }
+        data += i % 7 == 0 ? "\r\n" : "\n";
+      }
+      data += "</trkseg>\n";
+    }
+    data += "</trk>\n";
+  }
+  data += "</gpx>\n";
+  return data;
+}
+
+void CheckSameGpx(const Gpx& actual, const Gpx& expected)
+{
+  CHECK(actual.name == expected.name);
+  REQUIRE(actual.tracks.size() == expected.tracks.size());
+  for (size_t track_index = 0; track_index < actual.tracks.size(); ++track_index)
+  {
+    const auto& track = actual.tracks[track_index];
+    const auto& expected_track = expected.tracks[track_index];
+    CHECK(track.name == expected_track.name);
+    REQUIRE(track.segments.size() == expected_track.segments.size());
+    for (size_t segment_index = 0; segment_index < track.segments.size(); ++segment_index)
+    {
+      CHECK(track.segments[segment_index].columns ==
+            expected_track.segments[segment_index].columns);
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Stream events of GPX data", "[stream]")
+{
+  const std::string_view data = R"(<?xml version="1.0"?>
+<gpx version="1.1">
+  <metadata><name>Ride &amp; Coffee</name></metadata>
+  <trk>
+    <trkseg>
+      <trkpt lat="63.1" lon="10.2"><ele>12.5</ele><time>2024-05-18T07:50:00Z</time></trkpt>
+      <trkpt lat="63.2" lon="10.3"/>
+    </trkseg>
+    <trkseg/>
+  </trk>
+</gpx>)";
+
+  GpxStreamReader reader(data);
+  std::vector<GpxEvent> events;
+  std::vector<std::string> times;
+  while (const auto event = reader.Next())
+  {
+    events.push_back(*event);
+    times.emplace_back(event->time);
+  }
+
+  REQUIRE(events.size() == 9);
+  CHECK(events[0].type == GpxEventType::Name);
+  CHECK(events[1].type == GpxEventType::TrackBegin);
+  CHECK(events[2].type == GpxEventType::SegmentBegin);
+  CHECK(events[3].type == GpxEventType::Point);
+  CHECK_THAT(events[3].point.latitude, WithinAbs(63.1, 1e-9));
+  CHECK_THAT(events[3].point.longitude, WithinAbs(10.2, 1e-9));
+  CHECK_THAT(events[3].point.elevation, WithinAbs(12.5, 1e-9));
+  CHECK(times[3] == "2024-05-18T07:50:00Z");
+  CHECK(events[4].type == GpxEventType::Point);
+  CHECK_THAT(events[4].point.elevation, WithinAbs(0.0, 1e-9));
+  CHECK(times[4].empty());
+  CHECK(events[5].type == GpxEventType::SegmentEnd);
+  CHECK(events[6].type == GpxEventType::SegmentBegin);
+  CHECK(events[6].segment_index == 1);
+  CHECK(events[7].type == GpxEventType::SegmentEnd);
+  CHECK(events[8].type == GpxEventType::TrackEnd);
+
+  LengthVisitor visitor;
+  StreamGpxData(data, visitor);
+  CHECK(visitor.name == "Ride & Coffee");
+  REQUIRE(visitor.tracks.size() == 1);
+  CHECK(visitor.tracks[0].size() == 2);
+}
+
+TEST_CASE("Stream malformed GPX data", "[stream]")
+{
+  LengthVisitor visitor;
+  CHECK_THROWS_AS(StreamGpxData("", visitor), parse_error);
+  CHECK_THROWS_AS(StreamGpxData("<gpx><trk></gpx>", visitor), parse_error);
+  CHECK_THROWS_AS(StreamGpxData("<gpx><trk>", visitor), parse_error);
+}
+
+TEST_CASE("Stream non-existing file path", "[stream]")
+{
+  const auto path = project_path / "gpx/not-a-real-path/fake.gpx";
+  LengthVisitor visitor;
+  REQUIRE_THROWS_AS(StreamGpx(path, visitor), parse_error);
+}
+
+TEST_CASE("Stream real world GPX files", "[stream][real_world]")
+{
+  const auto json_path = project_path / "src/cpp/expected_gpx_data.json";
+  const auto expected_data = LoadExpectedGpxData(json_path);
+
+  const auto expected_gpx = GENERATE_REF(from_range(expected_data));
+  CAPTURE(expected_gpx.path);
+
+  LengthVisitor visitor;
+  StreamGpx(project_path / expected_gpx.path, visitor);
+
+  REQUIRE(visitor.tracks.size() == expected_gpx.tracks.size());
+  for (size_t track_index = 0; track_index < visitor.tracks.size(); track_index++)
+  {
+    const auto& segments = visitor.tracks[track_index];
+    const auto& expected_track = expected_gpx.tracks[track_index];
+    REQUIRE(segments.size() == expected_track.segments.size());
+    for (size_t segment_index = 0; segment_index < segments.size(); segment_index++)
+    {
+      CHECK_THAT(segments[segment_index],
+                 WithinAbs(expected_track.segments[segment_index].length2d, kMETERS_TOL));
+    }
+  }
+}
+
+TEST_CASE("Read large GPX data in parallel", "[stream]")
+{
+  const std::string buffer = MakeLargeGpxData();
+  const std::string_view data = buffer;
+  REQUIRE(data.size() > 1024 * 1024);
+
+  ParseOptions options;
+  SECTION("All data") {}
+  SECTION("Without time")
+  {
+    options.time = false;
+  }
+  SECTION("Track filter")
+  {
+    options.track_index = 1;
+  }
+
+  GpxStreamReader reader(data, options);
+  const Gpx expected = ReadGpxStream(reader);
+  const size_t threads = GENERATE(as<size_t>{}, 0, 1, 3, 16);
+  CAPTURE(threads);
+
+  const Gpx gpx = ReadGpxStreamParallel(data, options, threads);
+  CheckSameGpx(gpx, expected);
+}
+
+TEST_CASE("Read small GPX data in parallel", "[stream]")
+{
+  const std::string_view data = R"(<gpx><trk><trkseg>
+    <trkpt lat="63.1" lon="10.2"><time>2024-05-18T07:50:00Z</time></trkpt>
+  </trkseg></trk></gpx>)";
+  const Gpx gpx = ReadGpxStreamParallel(data, {}, 4);
+  REQUIRE(gpx.tracks.size() == 1);
+  REQUIRE(gpx.tracks[0].segments.size() == 1);
+  CHECK(gpx.tracks[0].segments[0].columns.size() == 1);
+}
+
+TEST_CASE("Read malformed large GPX data in parallel", "[stream]")
+{
+  auto data = MakeLargeGpxData();
+  // Truncated in the middle of the points.
+  data.resize(data.size() / 2);
+  CHECK_THROWS_AS(ReadGpxStreamParallel(data, {}, 4), parse_error);
+}
+
+TEST_CASE("Load GPX file in parallel", "[stream]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  const Gpx expected = LoadGpx(path);
+  const Gpx gpx = LoadGpx(path, {.threads = 0});
+  CheckSameGpx(gpx, expected);
+  CHECK_THAT(gpx.GetLength2D(), WithinAbs(expected.GetLength2D(), kMETERS_TOL));
+}
+
+TEST_CASE("Follow GPX data appended in pieces", "[stream][tail]")
+{
+  const std::string data = R"(<?xml version="1.0" encoding="UTF-8"?>
+<gpx version="1.1"><metadata><name>Ride &amp; run</name></metadata>
+<trk><name>Morning</name>
+<trkseg>
+<trkpt lat="60.0" lon="10.0"><ele>10.5</ele><time>2024-05-18T07:00:00Z</time></trkpt>
+<trkpt lat="60.001" lon="10.002"><ele>11.5</ele><time>2024-05-18T07:00:05Z</time></trkpt>
+<!-- Paused -->
+<trkpt lat="60.002" lon="10.001"><ele>12.5</ele><extensions><hr>90</hr></extensions></trkpt>
+</trkseg>
+<trkseg>
+<trkpt lat="60.003" lon="10.003"><ele>9.5</ele><time>2024-05-18T07:10:00Z</time></trkpt>
+<trkpt lat="60.004" lon="10.005"><ele>8.5</ele><time>2024-05-18T07:10:05Z</time></trkpt>
+</trkseg>
+</trk>
+<trk><name>Evening</name><trkseg>
+<trkpt lat="61.0" lon="11.0"><ele>1.0</ele><time>2024-05-18T19:00:00Z</time></trkpt>
+<trkpt lat="61.001" lon="11.001"><time>2024-05-18T19:00:05Z</time></trkpt>
+</trkseg></trk>
+</gpx>
+)";
+  const Gpx expected = ParseGpx(data);
+  const size_t piece_size = GENERATE(as<size_t>{}, 1, 7, 64, 4096);
+  CAPTURE(piece_size);
+
+  GpxTailReader reader;
+  size_t points = 0;
+  for (size_t offset = 0; offset < data.size(); offset += piece_size)
+  {
+    points += reader.Append(std::string_view(data).substr(offset, piece_size));
+    CHECK(reader.offset() <= offset + piece_size);
+    // The metrics computed between the pieces are then updated incrementally.
+    const auto& gpx = reader.gpx();
+    gpx.GetLength2D();
+    gpx.GetLength3D();
+    gpx.GetBounds();
+    gpx.GetTimeBounds();
+  }
+
+  CHECK(reader.finished());
+  // The whitespace after the end tag could be followed by more of it.
+  CHECK(reader.offset() == data.size() - 1);
+  CHECK(points == 7);
+  const auto& gpx = reader.gpx();
+  CheckSameGpx(gpx, expected);
+  CHECK_THAT(gpx.GetLength2D(), WithinAbs(expected.GetLength2D(), kMETERS_TOL));
+  CHECK_THAT(gpx.GetLength3D(), WithinAbs(expected.GetLength3D(), kMETERS_TOL));
+  CHECK(gpx.GetBounds() == expected.GetBounds());
+  CHECK(gpx.GetTimeBounds() == expected.GetTimeBounds());
+  for (size_t track_index = 0; track_index < gpx.tracks.size(); ++track_index)
+  {
+    const auto& track = gpx.tracks[track_index];
+    const auto& expected_track = expected.tracks[track_index];
+    CHECK_THAT(track.GetLength2D(), WithinAbs(expected_track.GetLength2D(), kMETERS_TOL));
+    CHECK(track.GetBounds() == expected_track.GetBounds());
+    CHECK(track.GetTimeBounds() == expected_track.GetTimeBounds());
+  }
+}
+
+TEST_CASE("Follow large GPX data appended in pieces", "[stream][tail]")
+{
+  const auto data = MakeLargeGpxData();
+  const Gpx expected = ParseGpx(data);
+
+  GpxTailReader reader;
+  for (size_t offset = 0; offset < data.size(); offset += 4000)
+  {
+    reader.Append(std::string_view(data).substr(offset, 4000));
+    reader.gpx().GetLength2D();
+  }
+  CHECK(reader.finished());
+  CheckSameGpx(reader.gpx(), expected);
+  CHECK_THAT(reader.gpx().GetLength2D(), WithinAbs(expected.GetLength2D(), kMETERS_TOL));
+}
+
+TEST_CASE("Follow GPX data without closing tags", "[stream][tail]")
+{
+  GpxTailReader reader;
+  CHECK(reader.Append(R"(<gpx><trk><trkseg><trkpt lat="60.0" lon="10.0"></trkpt>)"
+                      R"(<trkpt lat="60.001" lon="10.0"><ele>1)") == 1);
+  CHECK_FALSE(reader.finished());
+  REQUIRE(reader.gpx().tracks.size() == 1);
+  REQUIRE(reader.gpx().tracks[0].segments.size() == 1);
+  CHECK(reader.gpx().tracks[0].segments[0].columns.size() == 1);
+  CHECK(reader.gpx().GetLength2D() == 0.0);
+
+  // The elevation text is only complete once its end tag is appended.
+  CHECK(reader.Append(R"(2.5</ele></trkpt>)") == 1);
+  const auto& segment = reader.gpx().tracks[0].segments[0];
+  REQUIRE(segment.columns.size() == 2);
+  CHECK(segment.columns.elevation[1] == 12.5);
+  CHECK_THAT(reader.gpx().GetLength2D(),
+             WithinAbs(distance2d(segment.columns[0], segment.columns[1]), kMETERS_TOL));
+  CHECK_FALSE(reader.finished());
+}
+
+TEST_CASE("Follow malformed GPX data", "[stream][tail]")
+{
+  GpxTailReader reader;
+  reader.Append(R"(<gpx><trk><trkseg><trkpt lat="60.0" lon="10.0"></trkpt>)");
+  CHECK_THROWS_AS(reader.Append("</trk>"), parse_error);
+
+  // The reader starts over with a new document.
+  CHECK(reader.gpx().tracks.empty());
+  CHECK(reader.Append(R"(<gpx><trk><trkseg><trkpt lat="1" lon="2"/></trkseg></trk></gpx>)") == 1);
+  CHECK(reader.finished());
+}
+
+TEST_CASE("Follow GPX file while it is written", "[stream][tail]")
+{
+  const auto path = std::filesystem::temp_directory_path() / "fastgpx_tail_test.gpx";
+  std::filesystem::remove(path);
+
+  GpxTailReader reader(path);
+  CHECK(reader.Poll() == 0);
+
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << R"(<gpx><trk><trkseg><trkpt lat="60.0" lon="10.0"></trkpt><trkpt lat="60.001")";
+  }
+  CHECK(reader.Poll() == 1);
+  CHECK(reader.Poll() == 0);
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    file << R"( lon="10.0"></trkpt></trkseg>)";
+  }
+  CHECK(reader.Poll() == 1);
+  CHECK(reader.gpx().tracks[0].segments[0].columns.size() == 2);
+  CHECK_FALSE(reader.finished());
+
+  // A new recording replacing the file is read from the start.
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << R"(<gpx><trk><trkseg><trkpt lat="1" lon="2"></trkpt></trkseg></trk></gpx>)";
+  }
+  CHECK(reader.Poll() == 1);
+  CHECK(reader.finished());
+  REQUIRE(reader.gpx().tracks.size() == 1);
+  REQUIRE(reader.gpx().tracks[0].segments[0].columns.size() == 1);
+  CHECK(reader.gpx().tracks[0].segments[0].columns.latitude[0] == 1.0);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Follow GPX file rewritten to a larger size", "[stream][tail]")
+{
+  const auto path = std::filesystem::temp_directory_path() / "fastgpx_tail_rewrite_test.gpx";
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << R"(<gpx><trk><trkseg><trkpt lat="60.0" lon="10.0"></trkpt>)";
+  }
+
+  GpxTailReader reader(path);
+  CHECK(reader.Poll() == 1);
+
+  // Truncated and written again by a logger, past the offset read so far.
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << R"(<gpx><trk><trkseg><trkpt lat="1.0" lon="2.0"></trkpt><trkpt lat="3.0" lon="4.0">)"
+         << R"(</trkpt></trkseg></trk></gpx>)";
+  }
+  CHECK(reader.Poll() == 2);
+  CHECK(reader.finished());
+  REQUIRE(reader.gpx().tracks.size() == 1);
+  const auto& columns = reader.gpx().tracks[0].segments[0].columns;
+  REQUIRE(columns.size() == 2);
+  CHECK(columns.latitude[0] == 1.0);
+  CHECK(columns.latitude[1] == 3.0);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Follow GPX file with unicode path", "[stream][tail][unicode]")
+{
+  // "テスト.gpx", escaped to keep the source encoding out of it.
+  const auto name = std::filesystem::path(u8"\u30C6\u30B9\u30C8.gpx");
+  const auto path = std::filesystem::temp_directory_path() / "fastgpx_tail_test" / name;
+  std::filesystem::create_directories(path.parent_path());
+  std::filesystem::copy_file(project_path / "gpx/test" / name, path,
+                             std::filesystem::copy_options::overwrite_existing);
+
+  GpxTailReader reader(path);
+  CHECK(reader.Poll() > 0);
+  CHECK(reader.finished());
+  CHECK_THAT(reader.gpx().GetLength2D(), WithinAbs(17809.2701, kMETERS_TOL));
+
+  std::filesystem::remove_all(path.parent_path());
+}
+
+TEST_CASE("Benchmark GPX Streaming", "[!benchmark][stream]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  BENCHMARK("Connected_20240518_094959_.gpx")
+  {
+    LengthVisitor visitor;
+    StreamGpx(path, visitor);
+    return visitor.tracks.size();
+  };
+}
+
+TEST_CASE("Benchmark parallel GPX parsing", "[!benchmark][stream]")
+{
+  const std::string buffer = MakeLargeGpxData();
+  const std::string_view data = buffer;
+  BENCHMARK("One thread")
+  {
+    GpxStreamReader reader(data);
+    return ReadGpxStream(reader).tracks.size();
+  };
+  BENCHMARK("All threads")
+  {
+    return ReadGpxStreamParallel(data, {}, 0).tracks.size();
+  };
+}
@@ -0,0 +1,135 @@
+#include "fastgpx/summary.hpp"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "fastgpx/datetime.hpp"
+#include "fastgpx/errors.hpp"
+#include "fastgpx/geom.hpp"
+#include "fastgpx/stream.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+// Accumulates the metrics point by point, in the same order as `Segment`,
+// `Track` and `Gpx` compute them, such that the results are identical.
+class SummaryVisitor : public GpxVisitor
+{
+public:
+  GpxSummary summary;
+
+  void OnName(std::string_view name) override { summary.name.emplace(name); }
+
+  void OnTrackBegin() override { summary.tracks.emplace_back(); }
+
+  void OnTrackEnd() override
+  {
+    const auto& track = summary.tracks.back();
+    summary.length2d += track.length2d;
+    summary.length3d += track.length3d;
+    summary.bounds.Add(track.bounds);
+    summary.time_bounds.Add(track.time_bounds);
+  }
+
+  void OnTrackName(std::string_view name) override { summary.tracks.back().name.emplace(name); }
+
+  void OnSegmentBegin() override
+  {
+    summary.tracks.back().segments.emplace_back();
+    has_previous_ = false;
+  }
+
+  void OnSegmentEnd() override
+  {
+    auto& track = summary.tracks.back();
+    const auto& segment = track.segments.back();
+    track.length2d += segment.length2d;
+    track.length3d += segment.length3d;
+    track.bounds.Add(segment.bounds);
+    track.time_bounds.Add(segment.time_bounds);
+  }
+
+  void OnPoint(const LatLong& point, std::string_view time) override
+  {
+    auto& segment = summary.tracks.back().segments.back();
+    segment.point_count++;
+    if (has_previous_)
+    {
+      segment.length2d += distance2d(previous_, point);
+      segment.length3d += distance3d(previous_, point);
+    }
+    segment.bounds.Add(point);
+    if (!time.empty())
+    {
+      segment.time_bounds.Add(parse_gpx_time(time));
+    }
+    previous_ = point;
+    has_previous_ = true;
+  }
+
+private:
+  LatLong previous_;
+  bool has_previous_ = false;
+};
+
+} // namespace
+
+GpxSummary SummarizeGpx(const std::filesystem::path& path, const ParseOptions& options)
+{
+  try
+  {
+    SummaryVisitor visitor;
+    StreamGpx(path, visitor, options);
+    return std::move(visitor.summary);
+  }
+  catch (const parse_error&)
+  {
+    // Let pugixml deal with what the stream reader doesn't support. This also
+    // produces the canonical error for malformed documents.
+  }
+  return SummarizeGpx(LoadGpx(path, {.memory_map = false, .parse = options}));
+}
+
+GpxSummary SummarizeGpxData(std::string_view data, const ParseOptions& options)
+{
+  SummaryVisitor visitor;
+  StreamGpxData(data, visitor, options);
+  return std::move(visitor.summary);
+}
+
+GpxSummary SummarizeGpx(const Gpx& gpx)
+{
+  GpxSummary summary;
+  summary.name = gpx.name;
+  summary.tracks.reserve(gpx.tracks.size());
+  for (const auto& track : gpx.tracks)
+  {
+    auto& track_summary = summary.tracks.emplace_back();
+    track_summary.name = track.name;
+    track_summary.segments.reserve(track.segments.size());
+    for (const auto& segment : track.segments)
+    {
+      track_summary.segments.push_back({
+          .point_count = segment.columns.size(),
+          .length2d = segment.GetLength2D(),
+          .length3d = segment.GetLength3D(),
+          .bounds = segment.GetBounds(),
+          .time_bounds = segment.GetTimeBounds(),
+      });
+    }
+    track_summary.length2d = track.GetLength2D();
+    track_summary.length3d = track.GetLength3D();
+    track_summary.bounds = track.GetBounds();
+    track_summary.time_bounds = track.GetTimeBounds();
+  }
+  summary.length2d = gpx.GetLength2D();
+  summary.length3d = gpx.GetLength3D();
+  summary.bounds = gpx.GetBounds();
+  summary.time_bounds = gpx.GetTimeBounds();
+  return summary;
+}
+
+} // namespace fastgpx
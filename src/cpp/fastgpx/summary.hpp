@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+// Metrics of a <trkseg>, matching those computed by `Segment`.
+struct SegmentSummary
+{
+  size_t point_count = 0;
+  double length2d = 0.0; // Meters
+  double length3d = 0.0; // Meters
+  Bounds bounds = {};
+  TimeBounds time_bounds = {};
+};
+
+// Metrics of a <trk>, matching those computed by `Track`.
+struct TrackSummary
+{
+  std::optional<std::string> name = std::nullopt;
+  std::vector<SegmentSummary> segments = {};
+  double length2d = 0.0; // Meters
+  double length3d = 0.0; // Meters
+  Bounds bounds = {};
+  TimeBounds time_bounds = {};
+};
+
+// Metrics of a GPX document, matching those computed by `Gpx`.
+struct GpxSummary
+{
+  std::optional<std::string> name = std::nullopt;
+  std::vector<TrackSummary> tracks = {};
+  double length2d = 0.0; // Meters
+  double length3d = 0.0; // Meters
+  Bounds bounds = {};
+  TimeBounds time_bounds = {};
+};
+
+/**
+ * @brief Computes the metrics of a GPX file without keeping its points in memory.
+ *
+ * The metrics are accumulated while streaming through the file, so peak memory
+ * use depends only on the number of tracks and segments. Files the streaming
+ * reader can't handle, such as non-UTF-8 encodings, are loaded in full instead.
+ *
+ * @note The `Bounds` only hold the latitude, longitude and elevation of points.
+ *
+ * @throws parse_error if the file cannot be loaded.
+ * @param path
+ * @param options
+ */
+GpxSummary SummarizeGpx(const std::filesystem::path& path, const ParseOptions& options = {});
+
+/**
+ * @brief Computes the metrics of in-memory GPX data without materializing its points.
+ *
+ * @throws parse_error if the data is malformed.
+ * @param data
+ * @param options
+ */
+GpxSummary SummarizeGpxData(std::string_view data, const ParseOptions& options = {});
+
+/**
+ * @brief Computes the metrics of already loaded GPX data.
+ *
+ * @param gpx
+ */
+GpxSummary SummarizeGpx(const Gpx& gpx);
+
+} // namespace fastgpx
@@ -0,0 +1,150 @@
+#include <filesystem>
+#include <string_view>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "fastgpx/errors.hpp"
+#include "fastgpx/fastgpx.hpp"
+#include "fastgpx/summary.hpp"
+#include "fastgpx/test_data.hpp"
+
+using Catch::Generators::from_range;
+using Catch::Matchers::WithinAbs;
+
+using namespace fastgpx;
+
+// Sufficient tolerance for comparing meters.
+constexpr double kMETERS_TOL = 1e-4;
+
+const auto project_path = std::filesystem::path(FASTGPX_PROJECT_DIR);
+
+namespace {
+
+void CheckBounds(const Bounds& actual, const Bounds& expected)
+{
+  REQUIRE(actual.IsEmpty() == expected.IsEmpty());
+  if (!expected.IsEmpty())
+  {
+    CHECK(actual.min->latitude == expected.min->latitude);
+    CHECK(actual.min->longitude == expected.min->longitude);
+    CHECK(actual.max->latitude == expected.max->latitude);
+    CHECK(actual.max->longitude == expected.max->longitude);
+  }
+}
+
+} // namespace
+
+TEST_CASE("Summarize GPX data", "[summary]")
+{
+  const std::string_view data = R"(<?xml version="1.0"?>
+<gpx version="1.1">
+  <metadata><name>Ride</name></metadata>
+  <trk>
+    <name>Morning</name>
+    <trkseg>
+      <trkpt lat="59.9" lon="10.7"><ele>10</ele><time>2024-05-18T07:50:00Z</time></trkpt>
+      <trkpt lat="60.0" lon="10.8"><ele>20</ele><time>2024-05-18T08:50:00Z</time></trkpt>
+    </trkseg>
+    <trkseg/>
+  </trk>
+</gpx>)";
+
+  const auto summary = SummarizeGpxData(data);
+  const auto gpx = ParseGpx(data);
+
+  CHECK(summary.name == "Ride");
+  REQUIRE(summary.tracks.size() == 1);
+  CHECK(summary.tracks[0].name == "Morning");
+  REQUIRE(summary.tracks[0].segments.size() == 2);
+  CHECK(summary.tracks[0].segments[0].point_count == 2);
+  CHECK(summary.tracks[0].segments[1].point_count == 0);
+  CHECK(summary.tracks[0].segments[1].bounds.IsEmpty());
+  CHECK(summary.length2d == gpx.GetLength2D());
+  CHECK(summary.length3d == gpx.GetLength3D());
+  CHECK(summary.time_bounds == gpx.GetTimeBounds());
+  CheckBounds(summary.bounds, gpx.GetBounds());
+}
+
+TEST_CASE("Summarize malformed GPX data", "[summary]")
+{
+  CHECK_THROWS_AS(SummarizeGpxData("<gpx><trk></gpx>"), parse_error);
+}
+
+TEST_CASE("Summarize non-existing file path", "[summary]")
+{
+  const auto path = project_path / "gpx/not-a-real-path/fake.gpx";
+  REQUIRE_THROWS_AS(SummarizeGpx(path), parse_error);
+}
+
+TEST_CASE("Summarize real world GPX files", "[summary][real_world]")
+{
+  const auto json_path = project_path / "src/cpp/expected_gpx_data.json";
+  const auto expected_data = LoadExpectedGpxData(json_path);
+
+  const auto expected_gpx = GENERATE_REF(from_range(expected_data));
+  CAPTURE(expected_gpx.path);
+
+  const auto path = project_path / expected_gpx.path;
+  const auto summary = SummarizeGpx(path);
+  const auto gpx = LoadGpx(path);
+
+  CHECK_THAT(summary.length2d, WithinAbs(expected_gpx.length2d, kMETERS_TOL));
+  CHECK_THAT(summary.length3d, WithinAbs(expected_gpx.length3d, kMETERS_TOL));
+  CHECK(summary.time_bounds == expected_gpx.time_bounds);
+  CheckBounds(summary.bounds, gpx.GetBounds());
+
+  REQUIRE(summary.tracks.size() == gpx.tracks.size());
+  for (size_t track_index = 0; track_index < summary.tracks.size(); track_index++)
+  {
+    const auto& track_summary = summary.tracks[track_index];
+    const auto& track = gpx.tracks[track_index];
+    CHECK(track_summary.name == track.name);
+    CHECK(track_summary.length2d == track.GetLength2D());
+    CHECK(track_summary.time_bounds == track.GetTimeBounds());
+
+    REQUIRE(track_summary.segments.size() == track.segments.size());
+    for (size_t segment_index = 0; segment_index < track.segments.size(); segment_index++)
+    {
+      const auto& segment_summary = track_summary.segments[segment_index];
+      const auto& segment = track.segments[segment_index];
+      CHECK(segment_summary.point_count == segment.columns.size());
+      CHECK(segment_summary.length2d == segment.GetLength2D());
+      CHECK(segment_summary.length3d == segment.GetLength3D());
+      CheckBounds(segment_summary.bounds, segment.GetBounds());
+    }
+  }
+}
+
+TEST_CASE("Summarize loaded GPX data", "[summary]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  const auto streamed = SummarizeGpx(path);
+  const auto loaded = SummarizeGpx(LoadGpx(path));
+
+  CHECK(loaded.length2d == streamed.length2d);
+  CHECK(loaded.length3d == streamed.length3d);
+  CHECK(loaded.bounds == streamed.bounds);
+  CHECK(loaded.time_bounds == streamed.time_bounds);
+}
+
+TEST_CASE("Benchmark GPX Summary", "[!benchmark][summary]")
+{
+  const auto path = project_path / "gpx/2024 TopCamp/Connected_20240518_094959_.gpx";
+  BENCHMARK("Summarize")
+  {
+    return SummarizeGpx(path);
+  };
+
+  BENCHMARK("Load and compute")
+  {
+    const auto gpx = LoadGpx(path);
+    gpx.GetLength3D();
+    gpx.GetBounds();
+    gpx.GetTimeBounds();
+    return gpx.GetLength2D();
+  };
+}
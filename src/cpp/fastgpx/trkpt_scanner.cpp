@@ -0,0 +1,176 @@
+#include "fastgpx/trkpt_scanner.hpp"
+
+#include <string_view>
+
+#include "fastgpx/simd.hpp"
+#include "fastgpx/xml_scanner.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+constexpr auto npos = std::string_view::npos;
+
+// Character data the fast path can't pass through verbatim.
+bool NeedsDecoding(std::string_view text)
+{
+  return simd::FindAnyOf(text, '&', '<', '<') != npos;
+}
+
+// Reads `<name>text</name>` at `pos`, advancing past it.
+bool ScanTextElement(std::string_view data, size_t& pos, std::string_view start_tag,
+                     std::string_view end_tag, std::string_view& text)
+{
+  const size_t text_begin = pos + start_tag.size();
+  const size_t text_length = simd::FindChar(data.substr(text_begin), '<');
+  if (text_length == npos)
+  {
+    return false;
+  }
+  const size_t text_end = text_begin + text_length;
+  if (!data.substr(text_end).starts_with(end_tag))
+  {
+    // No end tag within the data, or a nested construct such as CDATA or a comment.
+    return false;
+  }
+  text = data.substr(text_begin, text_end - text_begin);
+  if (text.find('&') != npos)
+  {
+    return false;
+  }
+  pos = text_end + end_tag.size();
+  return true;
+}
+
+} // namespace
+
+size_t ScanTrkpt(std::string_view data, const ParseOptions& options, TrkptData& point)
+{
+  constexpr std::string_view kStartTag = "<trkpt";
+  if (!data.starts_with(kStartTag))
+  {
+    return 0;
+  }
+
+  point = TrkptData{};
+  bool seen_lat = false;
+  bool seen_lon = false;
+
+  // <trkpt lat=".." lon="..">
+  size_t pos = kStartTag.size();
+  for (;;)
+  {
+    const size_t whitespace = simd::CountWhitespace(data.substr(pos));
+    pos += whitespace;
+    if (pos >= data.size())
+    {
+      return 0;
+    }
+    if (data[pos] == '>')
+    {
+      pos++;
+      break;
+    }
+    if (data[pos] == '/')
+    {
+      // <trkpt lat=".." lon=".."/>
+      return data.substr(pos).starts_with("/>") ? pos + 2 : 0;
+    }
+    if (whitespace == 0)
+    {
+      return 0;
+    }
+
+    const size_t equals = simd::FindAnyOf(data.substr(pos), '=', '>', '/');
+    if (equals == npos || data[pos + equals] != '=' || pos + equals + 1 >= data.size())
+    {
+      return 0;
+    }
+    const auto name = data.substr(pos, equals);
+    const char quote = data[pos + equals + 1];
+    if (quote != '"' && quote != '\'')
+    {
+      return 0;
+    }
+    const size_t value_begin = pos + equals + 2;
+    const size_t value_length = simd::FindChar(data.substr(value_begin), quote);
+    if (value_length == npos)
+    {
+      return 0;
+    }
+    const auto value = data.substr(value_begin, value_length);
+    if (NeedsDecoding(value))
+    {
+      return 0;
+    }
+    if (name == "lat")
+    {
+      if (seen_lat)
+      {
+        return 0;
+      }
+      seen_lat = true;
+      point.latitude = ParseXmlDouble(value);
+    }
+    else if (name == "lon")
+    {
+      if (seen_lon)
+      {
+        return 0;
+      }
+      seen_lon = true;
+      point.longitude = ParseXmlDouble(value);
+    }
+    else if (name.empty() || name.find_first_of(" \t\r\n") != npos)
+    {
+      return 0;
+    }
+    pos = value_begin + value_length + 1;
+  }
+
+  // <ele>..</ele><time>..</time></trkpt>
+  bool seen_elevation = false;
+  bool seen_time = false;
+  for (;;)
+  {
+    pos += simd::CountWhitespace(data.substr(pos));
+    const auto rest = data.substr(pos);
+    if (rest.starts_with("</trkpt>"))
+    {
+      return pos + 8;
+    }
+
+    std::string_view text;
+    if (rest.starts_with("<ele>") && !seen_elevation)
+    {
+      seen_elevation = true;
+      if (!ScanTextElement(data, pos, "<ele>", "</ele>", text))
+      {
+        return 0;
+      }
+      if (options.elevation)
+      {
+        point.elevation = ParseXmlDouble(text);
+      }
+    }
+    else if (rest.starts_with("<time>") && !seen_time)
+    {
+      seen_time = true;
+      if (!ScanTextElement(data, pos, "<time>", "</time>", text))
+      {
+        return 0;
+      }
+      // Like pugixml, whitespace-only character data is ignored.
+      if (options.time && simd::CountWhitespace(text) < text.size())
+      {
+        point.time = text;
+      }
+    }
+    else
+    {
+      return 0;
+    }
+  }
+}
+
+} // namespace fastgpx
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "fastgpx/fastgpx.hpp"
+
+namespace fastgpx {
+
+struct TrkptData
+{
+  double latitude = 0.0;
+  double longitude = 0.0;
+  double elevation = 0.0;
+  // Raw <time> text. Empty if the point has no time or it was not requested.
+  std::string_view time;
+};
+
+/**
+ * @brief Fast path for the `<trkpt>` shape that makes up the bulk of GPX files:
+ *
+ *   <trkpt lat=".." lon=".."><ele>..</ele><time>..</time></trkpt>
+ *
+ * Any whitespace between the elements is accepted, and `<ele>` and `<time>` are
+ * optional. The result matches what `GpxStreamReader` extracts from the same
+ * element.
+ *
+ * Anything else, such as other child elements, comments, entities or an element
+ * truncated by the end of `data`, is rejected so the caller can fall back to
+ * the general parser. Rejected input is never partially consumed.
+ *
+ * @param data Input starting with `<trkpt`.
+ * @param options Skipped fields are left at their defaults.
+ * @param point Receives the parsed point. The time refers into `data`.
+ * @return size_t Length of the element, or 0 if the input was rejected.
+ */
+size_t ScanTrkpt(std::string_view data, const ParseOptions& options, TrkptData& point);
+
+} // namespace fastgpx
@@ -0,0 +1,138 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "fastgpx/fastgpx.hpp"
+#include "fastgpx/stream.hpp"
+#include "fastgpx/trkpt_scanner.hpp"
+
+using namespace fastgpx;
+
+namespace {
+
+std::vector<GpxEvent> PointEvents(std::string_view data, std::vector<std::string>& times)
+{
+  std::vector<GpxEvent> points;
+  GpxStreamReader reader(data);
+  while (const auto event = reader.Next())
+  {
+    if (event->type == GpxEventType::Point)
+    {
+      points.push_back(*event);
+      times.emplace_back(event->time);
+    }
+  }
+  return points;
+}
+
+} // namespace
+
+TEST_CASE("Scan common trkpt shape", "[trkpt]")
+{
+  const std::string_view data = R"(<trkpt lat="59.3293" lon='18.0686'>
+      <ele>28.5</ele>
+      <time>2024-05-18T09:49:59Z</time>
+    </trkpt><trkpt lat="1" lon="2"/>)";
+  TrkptData point;
+  const size_t length = ScanTrkpt(data, {}, point);
+
+  CHECK(length == data.find("<trkpt", 1));
+  CHECK(point.latitude == 59.3293);
+  CHECK(point.longitude == 18.0686);
+  CHECK(point.elevation == 28.5);
+  CHECK(point.time == "2024-05-18T09:49:59Z");
+}
+
+TEST_CASE("Scan trkpt variations", "[trkpt]")
+{
+  TrkptData point;
+
+  SECTION("Empty element")
+  {
+    const std::string_view data = R"(<trkpt lon="2.5" lat="1.5" />)";
+    CHECK(ScanTrkpt(data, {}, point) == data.size());
+    CHECK(point.latitude == 1.5);
+    CHECK(point.longitude == 2.5);
+    CHECK(point.time.empty());
+  }
+
+  SECTION("Other attributes")
+  {
+    const std::string_view data = R"(<trkpt id="7" lat="1.5" lon="2.5"></trkpt>)";
+    CHECK(ScanTrkpt(data, {}, point) == data.size());
+    CHECK(point.latitude == 1.5);
+  }
+
+  SECTION("Only time")
+  {
+    const std::string_view data = R"(<trkpt lat="1" lon="2"><time>x</time></trkpt>)";
+    CHECK(ScanTrkpt(data, {}, point) == data.size());
+    CHECK(point.elevation == 0.0);
+    CHECK(point.time == "x");
+  }
+
+  SECTION("Whitespace-only time")
+  {
+    const std::string_view data = R"(<trkpt lat="1" lon="2"><time> </time></trkpt>)";
+    CHECK(ScanTrkpt(data, {}, point) == data.size());
+    CHECK(point.time.empty());
+  }
+
+  SECTION("Excluded fields")
+  {
+    const std::string_view data =
+        R"(<trkpt lat="1" lon="2"><ele>10</ele><time>x</time></trkpt>)";
+    CHECK(ScanTrkpt(data, {.elevation = false, .time = false}, point) == data.size());
+    CHECK(point.elevation == 0.0);
+    CHECK(point.time.empty());
+  }
+}
+
+TEST_CASE("Reject unexpected trkpt constructs", "[trkpt]")
+{
+  const std::string_view data = GENERATE(
+      R"(<trkpt lat="1" lon="2"><ele>10</ele><extensions/></trkpt>)",
+      R"(<trkpt lat="1" lon="2"><ele>10</ele><!-- comment --></trkpt>)",
+      R"(<trkpt lat="1" lon="2"><ele><![CDATA[10]]></ele></trkpt>)",
+      R"(<trkpt lat="1" lon="2"><time>2024&#45;05</time></trkpt>)",
+      R"(<trkpt lat="1" lon="2"><ele>1</ele><ele>2</ele></trkpt>)",
+      R"(<trkpt lat="1" lat="2" lon="3"></trkpt>)",
+      R"(<trkpt lat = "1" lon="2"></trkpt>)",
+      R"(<trkpt lat="&#49;" lon="2"></trkpt>)",
+      R"(<trkpt lat="1"lon="2"></trkpt>)",
+      R"(<trkpts lat="1" lon="2"></trkpts>)",
+      R"(<trkpt lat="1" lon="2"><ele>10</ele></trk)",
+      R"(<trkpt lat="1" lon="2"><ele>10)",
+      R"(<trkpt lat="1" lon="2)");
+  CAPTURE(data);
+
+  TrkptData point;
+  CHECK(ScanTrkpt(data, {}, point) == 0);
+}
+
+TEST_CASE("Stream mixed trkpt shapes", "[trkpt][stream]")
+{
+  // Points the fast path rejects are read by the general path with the same result.
+  const std::string_view data = R"(<gpx><trk><trkseg>
+    <trkpt lat="1" lon="2"><ele>10</ele><time>2024-01-01T00:00:00Z</time></trkpt>
+    <trkpt lat="3" lon="4"><ele>20</ele><extensions><speed>5</speed></extensions></trkpt>
+    <trkpt lat="5" lon="6"><!-- c --><time><![CDATA[2024-01-01T00:00:02Z]]></time></trkpt>
+    <trkpt lat="7" lon="8"><time>2024-01-01T00:00:03&#90;</time></trkpt>
+    <trkpt lat="9" lon="10"/>
+  </trkseg></trk></gpx>)";
+  std::vector<std::string> times;
+  const auto points = PointEvents(data, times);
+
+  REQUIRE(points.size() == 5);
+  CHECK(points[0].point.latitude == 1.0);
+  CHECK(points[0].point.elevation == 10.0);
+  CHECK(points[1].point.longitude == 4.0);
+  CHECK(points[1].point.elevation == 20.0);
+  CHECK(points[2].point.latitude == 5.0);
+  CHECK(points[4].point.longitude == 10.0);
+  CHECK(times == std::vector<std::string>{"2024-01-01T00:00:00Z", "", "2024-01-01T00:00:02Z",
+                                          "2024-01-01T00:00:03Z", ""});
+}
@@ -0,0 +1,621 @@
+#include "fastgpx/xml_scanner.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "fastgpx/errors.hpp"
+#include "fastgpx/numeric.hpp"
+#include "fastgpx/simd.hpp"
+
+namespace fastgpx {
+
+namespace {
+
+constexpr auto npos = std::string_view::npos;
+
+bool IsWhitespace(const char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+  return std::ranges::equal(a, b, [](char x, char y) {
+    const auto lower = [](char c) {
+      return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c;
+    };
+    return lower(x) == lower(y);
+  });
+}
+
+void AppendUtf8(std::string& output, uint32_t code_point)
+{
+  if (code_point < 0x80)
+  {
+    output += static_cast<char>(code_point);
+  }
+  else if (code_point < 0x800)
+  {
+    output += static_cast<char>(0xC0 | (code_point >> 6));
+    output += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+  else if (code_point < 0x10000)
+  {
+    output += static_cast<char>(0xE0 | (code_point >> 12));
+    output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    output += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+  else
+  {
+    output += static_cast<char>(0xF0 | (code_point >> 18));
+    output += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    output += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+}
+
+std::optional<uint32_t> ParseCharacterReference(std::string_view entity)
+{
+  // entity is the part between '&#' and ';'.
+  int base = 10;
+  if (!entity.empty() && (entity.front() == 'x' || entity.front() == 'X'))
+  {
+    base = 16;
+    entity.remove_prefix(1);
+  }
+  uint32_t code_point = 0;
+  const auto end = entity.data() + entity.size();
+  const auto [ptr, ec] = std::from_chars(entity.data(), end, code_point, base);
+  if (ec != std::errc() || ptr != end || entity.empty() || code_point > 0x10FFFF)
+  {
+    return std::nullopt;
+  }
+  return code_point;
+}
+
+[[noreturn]] void ThrowUnexpectedEnd(std::string_view construct)
+{
+  throw parse_error(std::format("Unexpected end of XML data in {}", construct));
+}
+
+} // namespace
+
+XmlScanner::XmlScanner(std::string_view data) : data_(data), eof_(true) {}
+
+XmlScanner::XmlScanner(FILE* file, size_t chunk_size)
+    : file_(file), chunk_size_(std::max<size_t>(chunk_size, 16))
+{
+  assert(file_ != nullptr);
+}
+
+XmlScanner::XmlScanner(ReadFunction read, size_t chunk_size)
+    : read_(std::move(read)), chunk_size_(std::max<size_t>(chunk_size, 16))
+{
+  assert(read_);
+}
+
+void XmlScanner::Start()
+{
+  started_ = true;
+
+  if (LookingAt("\xEF\xBB\xBF")) // UTF-8 BOM
+  {
+    pos_ += 3;
+  }
+  else if (LookingAt("\xFF\xFE") || LookingAt("\xFE\xFF"))
+  {
+    throw parse_error("Unsupported XML encoding: UTF-16");
+  }
+  else if (Ensure(2) && data_[pos_ + 1] == '\0')
+  {
+    throw parse_error("Unsupported XML encoding: UTF-16");
+  }
+
+  // <?xml version="1.0" encoding="UTF-8"?>
+  if (LookingAt("<?xml") && Ensure(6) && IsWhitespace(data_[pos_ + 5]))
+  {
+    const size_t end = Find("?>", 5);
+    if (end == npos)
+    {
+      ThrowUnexpectedEnd("XML declaration");
+    }
+    const auto declaration = data_.substr(pos_ + 5, end - 5);
+    const auto encoding = FindAttribute(declaration, "encoding");
+    if (encoding.has_value() && !EqualsIgnoreCase(*encoding, "UTF-8") &&
+        !EqualsIgnoreCase(*encoding, "UTF8") && !EqualsIgnoreCase(*encoding, "US-ASCII") &&
+        !EqualsIgnoreCase(*encoding, "ASCII"))
+    {
+      throw parse_error(std::format("Unsupported XML encoding: {}", *encoding));
+    }
+  }
+}
+
+bool XmlScanner::Fill()
+{
+  if (eof_)
+  {
+    return false;
+  }
+
+  // Discard the consumed bytes, keeping the partial token at the front.
+  if (pos_ > 0)
+  {
+    buffer_.erase(0, pos_);
+    consumed_ += pos_;
+    pos_ = 0;
+  }
+
+  const size_t size = buffer_.size();
+  buffer_.resize(size + chunk_size_);
+  const size_t read = file_ ? std::fread(buffer_.data() + size, 1, chunk_size_, file_)
+                            : read_(buffer_.data() + size, chunk_size_);
+  buffer_.resize(size + read);
+  data_ = buffer_;
+
+  if (read < chunk_size_)
+  {
+    if (file_ && std::ferror(file_))
+    {
+      throw parse_error("Failed to read XML data");
+    }
+    eof_ = true;
+  }
+  return read > 0;
+}
+
+bool XmlScanner::Ensure(const size_t count)
+{
+  while (data_.size() - pos_ < count)
+  {
+    if (!Fill())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string_view XmlScanner::Peek(const size_t count)
+{
+  assert(started_);
+  Ensure(count);
+  return data_.substr(pos_);
+}
+
+void XmlScanner::Skip(const size_t count) noexcept
+{
+  assert(count <= data_.size() - pos_);
+  pos_ += count;
+}
+
+void XmlScanner::Continue(std::string_view data) noexcept
+{
+  assert(file_ == nullptr && !read_);
+  assert(pos_ == data_.size());
+  consumed_ += pos_;
+  data_ = data;
+  pos_ = 0;
+}
+
+bool XmlScanner::LookingAt(std::string_view prefix)
+{
+  return Ensure(prefix.size()) && data_.substr(pos_, prefix.size()) == prefix;
+}
+
+// The Find* functions return offsets relative to `pos_`, which remain valid
+// when `Fill` moves the window.
+
+size_t XmlScanner::Find(const char c, size_t from)
+{
+  for (;;)
+  {
+    const auto window = data_.substr(pos_);
+    if (from < window.size())
+    {
+      const size_t found = simd::FindChar(window.substr(from), c);
+      if (found != npos)
+      {
+        return from + found;
+      }
+      from = window.size();
+    }
+    if (!Fill())
+    {
+      return npos;
+    }
+  }
+}
+
+size_t XmlScanner::Find(std::string_view needle, size_t from)
+{
+  for (;;)
+  {
+    const auto window = data_.substr(pos_);
+    const auto found = window.find(needle, from);
+    if (found != npos)
+    {
+      return found;
+    }
+    // The needle might straddle the end of the current window.
+    if (window.size() >= needle.size())
+    {
+      from = std::max(from, window.size() - needle.size() + 1);
+    }
+    if (!Fill())
+    {
+      return npos;
+    }
+  }
+}
+
+size_t XmlScanner::FindAnyOf(const char a, const char b, const char c, size_t from)
+{
+  for (;;)
+  {
+    const auto window = data_.substr(pos_);
+    if (from < window.size())
+    {
+      const size_t found = simd::FindAnyOf(window.substr(from), a, b, c);
+      if (found != npos)
+      {
+        return from + found;
+      }
+    }
+    from = std::max(from, window.size());
+    if (!Fill())
+    {
+      return npos;
+    }
+  }
+}
+
+size_t XmlScanner::FindTagEnd(size_t from)
+{
+  // Attribute values may legally contain '>', so quotes must be skipped.
+  for (;;)
+  {
+    const size_t found = FindAnyOf('>', '"', '\'', from);
+    if (found == npos)
+    {
+      ThrowUnexpectedEnd("element tag");
+    }
+    const char c = data_[pos_ + found];
+    if (c == '>')
+    {
+      return found;
+    }
+    const size_t close = Find(c, found + 1);
+    if (close == npos)
+    {
+      ThrowUnexpectedEnd("attribute value");
+    }
+    from = close + 1;
+  }
+}
+
+size_t XmlScanner::FindDeclarationEnd(size_t from)
+{
+  // <!DOCTYPE gpx [ <!ENTITY ...> ]>
+  const size_t found = FindAnyOf('[', '>', '>', from);
+  if (found == npos)
+  {
+    ThrowUnexpectedEnd("declaration");
+  }
+  if (data_[pos_ + found] == '>')
+  {
+    return found;
+  }
+  const size_t subset_end = Find(']', found + 1);
+  if (subset_end == npos)
+  {
+    ThrowUnexpectedEnd("declaration");
+  }
+  const size_t end = Find('>', subset_end + 1);
+  if (end == npos)
+  {
+    ThrowUnexpectedEnd("declaration");
+  }
+  return end;
+}
+
+bool XmlScanner::Next(XmlToken& token)
+{
+  if (!started_)
+  {
+    Start();
+  }
+
+  for (;;)
+  {
+    if (!Ensure(1))
+    {
+      return false;
+    }
+
+    if (data_[pos_] != '<')
+    {
+      size_t end = Find('<', 1);
+      if (end == npos)
+      {
+        end = data_.size() - pos_;
+      }
+      token = XmlToken{XmlTokenType::Text, {}, {}, data_.substr(pos_, end), false};
+      pos_ += end;
+      return true;
+    }
+
+    if (!Ensure(2))
+    {
+      ThrowUnexpectedEnd("element tag");
+    }
+
+    const char marker = data_[pos_ + 1];
+    if (marker == '/') // </name>
+    {
+      const size_t end = Find('>', 2);
+      if (end == npos)
+      {
+        ThrowUnexpectedEnd("end tag");
+      }
+      auto name = data_.substr(pos_ + 2, end - 2);
+      while (!name.empty() && IsWhitespace(name.back()))
+      {
+        name.remove_suffix(1);
+      }
+      token = XmlToken{XmlTokenType::EndElement, name, {}, {}, false};
+      pos_ += end + 1;
+      return true;
+    }
+
+    if (marker == '?') // <?target ... ?>
+    {
+      const size_t end = Find("?>", 2);
+      if (end == npos)
+      {
+        ThrowUnexpectedEnd("processing instruction");
+      }
+      pos_ += end + 2;
+      continue;
+    }
+
+    if (marker == '!')
+    {
+      if (LookingAt("<!--"))
+      {
+        const size_t end = Find("-->", 4);
+        if (end == npos)
+        {
+          ThrowUnexpectedEnd("comment");
+        }
+        pos_ += end + 3;
+        continue;
+      }
+      if (LookingAt("<![CDATA["))
+      {
+        const size_t end = Find("]]>", 9);
+        if (end == npos)
+        {
+          ThrowUnexpectedEnd("CDATA section");
+        }
+        token = XmlToken{XmlTokenType::Text, {}, {}, data_.substr(pos_ + 9, end - 9), true};
+        pos_ += end + 3;
+        return true;
+      }
+      pos_ += FindDeclarationEnd(2) + 1;
+      continue;
+    }
+
+    // <name attr="value"> or <name attr="value"/>
+    const size_t end = FindTagEnd(1);
+    auto tag = data_.substr(pos_ + 1, end - 1);
+    const bool empty = !tag.empty() && tag.back() == '/';
+    if (empty)
+    {
+      tag.remove_suffix(1);
+    }
+    size_t name_end = 0;
+    while (name_end < tag.size() && !IsWhitespace(tag[name_end]))
+    {
+      ++name_end;
+    }
+    if (name_end == 0)
+    {
+      throw parse_error("Invalid XML element name");
+    }
+    token = XmlToken{empty ? XmlTokenType::EmptyElement : XmlTokenType::StartElement,
+                     tag.substr(0, name_end), tag.substr(name_end), {}, false};
+    pos_ += end + 1;
+    return true;
+  }
+}
+
+std::optional<std::string_view> FindAttribute(std::string_view attributes, std::string_view name)
+{
+  size_t i = 0;
+  const auto skip_whitespace = [&] {
+    while (i < attributes.size() && IsWhitespace(attributes[i]))
+    {
+      ++i;
+    }
+  };
+
+  for (;;)
+  {
+    skip_whitespace();
+    if (i == attributes.size())
+    {
+      return std::nullopt;
+    }
+
+    const size_t name_begin = i;
+    while (i < attributes.size() && attributes[i] != '=' && !IsWhitespace(attributes[i]))
+    {
+      ++i;
+    }
+    const auto attribute_name = attributes.substr(name_begin, i - name_begin);
+
+    skip_whitespace();
+    if (i == attributes.size() || attributes[i] != '=')
+    {
+      throw parse_error(std::format("Invalid XML attribute: {}", attribute_name));
+    }
+    ++i;
+    skip_whitespace();
+    if (i == attributes.size() || (attributes[i] != '"' && attributes[i] != '\''))
+    {
+      throw parse_error(std::format("Invalid XML attribute: {}", attribute_name));
+    }
+
+    const char quote = attributes[i];
+    const size_t value_end = attributes.find(quote, i + 1);
+    if (value_end == npos)
+    {
+      throw parse_error(std::format("Invalid XML attribute: {}", attribute_name));
+    }
+    if (attribute_name == name)
+    {
+      return attributes.substr(i + 1, value_end - i - 1);
+    }
+    i = value_end + 1;
+  }
+}
+
+double ParseXmlDouble(std::string_view text) noexcept
+{
+  text.remove_prefix(simd::CountWhitespace(text));
+  return ParseDouble(text);
+}
+
+void AppendDecodedText(std::string& output, std::string_view text)
+{
+  for (;;)
+  {
+    const size_t amp = text.find('&');
+    output.append(text.substr(0, amp));
+    if (amp == npos)
+    {
+      return;
+    }
+    text.remove_prefix(amp);
+
+    const size_t semicolon = text.find(';');
+    if (semicolon == npos)
+    {
+      output.append(text);
+      return;
+    }
+
+    const auto entity = text.substr(1, semicolon - 1);
+    if (entity == "lt")
+    {
+      output += '<';
+    }
+    else if (entity == "gt")
+    {
+      output += '>';
+    }
+    else if (entity == "amp")
+    {
+      output += '&';
+    }
+    else if (entity == "quot")
+    {
+      output += '"';
+    }
+    else if (entity == "apos")
+    {
+      output += '\'';
+    }
+    else if (entity.starts_with('#'))
+    {
+      const auto code_point = ParseCharacterReference(entity.substr(1));
+      if (code_point.has_value())
+      {
+        AppendUtf8(output, *code_point);
+      }
+      else
+      {
+        output.append(text.substr(0, semicolon + 1));
+      }
+    }
+    else
+    {
+      output.append(text.substr(0, semicolon + 1));
+    }
+    text.remove_prefix(semicolon + 1);
+  }
+}
+
+size_t CompleteXmlPrefix(std::string_view data) noexcept
+{
+  // Offset past `terminator` searched from `from`, or npos.
+  const auto end_of = [&](std::string_view terminator, size_t from) {
+    const size_t found = data.find(terminator, from);
+    return found == npos ? npos : found + terminator.size();
+  };
+
+  size_t complete = 0;
+  size_t pos = 0;
+  while ((pos = data.find('<', pos)) != npos)
+  {
+    const auto markup = data.substr(pos);
+    size_t end = npos;
+    if (markup.starts_with("<!--"))
+    {
+      end = end_of("-->", pos + 4);
+    }
+    else if (markup.starts_with("<![CDATA["))
+    {
+      end = end_of("]]>", pos + 9);
+    }
+    else if (markup.starts_with("<?"))
+    {
+      end = end_of("?>", pos + 2);
+    }
+    else if (markup.starts_with("<!"))
+    {
+      // <!DOCTYPE gpx [ <!ENTITY ...> ]>
+      const size_t found = data.find_first_of("[>", pos + 2);
+      if (found != npos && data[found] == '[')
+      {
+        const size_t subset_end = data.find(']', found + 1);
+        end = subset_end == npos ? npos : end_of(">", subset_end + 1);
+      }
+      else
+      {
+        end = found == npos ? npos : found + 1;
+      }
+    }
+    else
+    {
+      // Attribute values may legally contain '>', so quotes must be skipped.
+      size_t from = pos + 1;
+      while (from != npos)
+      {
+        const size_t found = data.find_first_of(">\"'", from);
+        if (found == npos || data[found] == '>')
+        {
+          end = found == npos ? npos : found + 1;
+          break;
+        }
+        const size_t close = data.find(data[found], found + 1);
+        from = close == npos ? npos : close + 1;
+      }
+    }
+    if (end == npos)
+    {
+      break;
+    }
+    complete = end;
+    pos = end;
+  }
+  return complete;
+}
+
+} // namespace fastgpx
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fastgpx {
+
+enum class XmlTokenType
+{
+  StartElement, // <name attr="value">
+  EmptyElement, // <name attr="value"/>
+  EndElement,   // </name>
+  Text,         // Character data, including CDATA sections.
+};
+
+struct XmlToken
+{
+  XmlTokenType type = XmlTokenType::Text;
+  // Element name. Empty for text tokens.
+  std::string_view name;
+  // Raw attribute string of start elements. Use `FindAttribute` to extract values.
+  std::string_view attributes;
+  // Raw character data of text tokens. Entities are not decoded.
+  std::string_view text;
+  // True if the text came from a `<![CDATA[...]]>` section.
+  bool cdata = false;
+};
+
+/**
+ * @brief Forward-only XML tokenizer for the subset of XML used by GPX files.
+ *
+ * Unlike pugixml this does not build a document tree. Comments, processing
+ * instructions and `<!DOCTYPE>` declarations are skipped. Only UTF-8 (or ASCII)
+ * input is supported, a `parse_error` is thrown for other encodings.
+ *
+ * @note The views in the returned tokens are only valid until the next call to
+ *   `Next`.
+ */
+class XmlScanner
+{
+public:
+  static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+  // Reads up to `size` bytes into `buffer`, returning the number of bytes read.
+  // Fewer bytes are returned only at the end of the input.
+  using ReadFunction = std::function<size_t(char* buffer, size_t size)>;
+
+  /**
+   * @brief Scans an in-memory XML document. The data is not copied.
+   *
+   * @param data Must outlive the scanner.
+   */
+  explicit XmlScanner(std::string_view data);
+
+  /**
+   * @brief Scans an XML document from a file in chunks, using memory bounded by
+   *   the chunk size and the largest token in the file.
+   *
+   * @param file Open file handle, not owned by the scanner.
+   * @param chunk_size Number of bytes read per chunk.
+   */
+  explicit XmlScanner(FILE* file, size_t chunk_size = kDefaultChunkSize);
+
+  /**
+   * @brief Scans an XML document produced in chunks by `read`, such as
+   *   decompressed data.
+   *
+   * @param read
+   * @param chunk_size Number of bytes read per chunk.
+   */
+  explicit XmlScanner(ReadFunction read, size_t chunk_size = kDefaultChunkSize);
+
+  /**
+   * @brief Advances to the next token.
+   *
+   * @param token Receives the next token.
+   * @return false when the end of the input is reached.
+   */
+  bool Next(XmlToken& token);
+
+  /**
+   * @brief Returns the unconsumed input without advancing, buffering up to
+   *   `count` bytes of it.
+   *
+   * Fewer bytes are returned at the end of the input. The view is valid until
+   * the next call to `Next` or `Peek`.
+   *
+   * @param count
+   */
+  std::string_view Peek(size_t count);
+
+  /**
+   * @brief Advances past input previously returned by `Peek`.
+   *
+   * @param count Must not exceed the size of the view returned by `Peek`.
+   */
+  void Skip(size_t count) noexcept;
+
+  /**
+   * @brief Continues an in-memory document with the data following the input,
+   *   such as data appended to a file still being written.
+   *
+   * The offsets keep counting from the start of the document.
+   *
+   * @param data Must outlive the scanner, or the next call. Must not end within
+   *   a token, see `CompleteXmlPrefix`.
+   */
+  void Continue(std::string_view data) noexcept;
+
+  /**
+   * @brief Number of bytes of the input consumed so far.
+   */
+  size_t offset() const noexcept { return consumed_ + pos_; }
+
+private:
+  void Start();
+  bool Fill();
+  bool Ensure(size_t count);
+  bool LookingAt(std::string_view prefix);
+  size_t Find(char c, size_t from);
+  size_t Find(std::string_view needle, size_t from);
+  size_t FindAnyOf(char a, char b, char c, size_t from);
+  size_t FindTagEnd(size_t from);
+  size_t FindDeclarationEnd(size_t from);
+
+  FILE* file_ = nullptr;
+  ReadFunction read_;
+  size_t chunk_size_ = kDefaultChunkSize;
+  std::string buffer_;
+  // Current window of the input. Either the in-memory data or `buffer_`.
+  std::string_view data_;
+  // Position in `data_` of the next token.
+  size_t pos_ = 0;
+  // Bytes discarded from the front of `buffer_`, or of the data replaced by
+  // `Continue`.
+  size_t consumed_ = 0;
+  bool eof_ = false;
+  bool started_ = false;
+};
+
+/**
+ * @brief Finds the raw value of an attribute in `XmlToken::attributes`.
+ *
+ * @param attributes
+ * @param name
+ * @return std::nullopt if the attribute is not present.
+ */
+std::optional<std::string_view> FindAttribute(std::string_view attributes, std::string_view name);
+
+/**
+ * @brief Parses a numeric XML value the way pugixml's `as_double` does.
+ *
+ * Leading whitespace and trailing garbage are ignored, and invalid numbers
+ * yield 0.0.
+ *
+ * @param text
+ */
+double ParseXmlDouble(std::string_view text) noexcept;
+
+/**
+ * @brief Appends XML character data to `output`, decoding the predefined entities
+ *   and numeric character references.
+ *
+ * Unknown entities are appended verbatim.
+ *
+ * @param output
+ * @param text
+ */
+void AppendDecodedText(std::string& output, std::string_view text);
+
+/**
+ * @brief Finds the end of the last complete markup in a truncated document,
+ *   such as a file still being written.
+ *
+ * Text is only complete once the markup following it starts, as more of it may
+ * follow. The returned prefix can be passed to `XmlScanner::Continue`, and the
+ * rest kept until more data is appended.
+ *
+ * @param data
+ * @return size_t Length of the prefix ending with the last complete tag,
+ *   comment, CDATA section, processing instruction or declaration.
+ */
+size_t CompleteXmlPrefix(std::string_view data) noexcept;
+
+} // namespace fastgpx
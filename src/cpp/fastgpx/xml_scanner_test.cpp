@@ -0,0 +1,145 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "fastgpx/errors.hpp"
+#include "fastgpx/xml_scanner.hpp"
+
+using namespace fastgpx;
+
+namespace {
+
+std::vector<XmlToken> ScanAll(XmlScanner& scanner)
+{
+  std::vector<XmlToken> tokens;
+  XmlToken token;
+  while (scanner.Next(token))
+  {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+
+} // namespace
+
+TEST_CASE("Scan elements, attributes and text", "[xml]")
+{
+  const std::string_view data = R"(<?xml version="1.0" encoding="UTF-8"?>)"
+                                R"(<trkpt lat="63.4" lon='10.4'><ele>152.0</ele><br/></trkpt>)";
+  XmlScanner scanner(data);
+  const auto tokens = ScanAll(scanner);
+
+  REQUIRE(tokens.size() == 6);
+  CHECK(tokens[0].type == XmlTokenType::StartElement);
+  CHECK(tokens[0].name == "trkpt");
+  CHECK(FindAttribute(tokens[0].attributes, "lat") == "63.4");
+  CHECK(FindAttribute(tokens[0].attributes, "lon") == "10.4");
+  CHECK_FALSE(FindAttribute(tokens[0].attributes, "ele").has_value());
+  CHECK(tokens[1].type == XmlTokenType::StartElement);
+  CHECK(tokens[1].name == "ele");
+  CHECK(tokens[2].type == XmlTokenType::Text);
+  CHECK(tokens[2].text == "152.0");
+  CHECK(tokens[3].type == XmlTokenType::EndElement);
+  CHECK(tokens[3].name == "ele");
+  CHECK(tokens[4].type == XmlTokenType::EmptyElement);
+  CHECK(tokens[4].name == "br");
+  CHECK(tokens[5].type == XmlTokenType::EndElement);
+  CHECK(tokens[5].name == "trkpt");
+}
+
+TEST_CASE("Scan skips comments, processing instructions and declarations", "[xml]")
+{
+  const std::string_view data = "\xEF\xBB\xBF<!DOCTYPE gpx [ <!ENTITY x \"y\"> ]>"
+                                "<!-- <trkpt> --><?pi data?><name><![CDATA[<a>]]></name>";
+  XmlScanner scanner(data);
+  const auto tokens = ScanAll(scanner);
+
+  REQUIRE(tokens.size() == 3);
+  CHECK(tokens[0].name == "name");
+  CHECK(tokens[1].type == XmlTokenType::Text);
+  CHECK(tokens[1].cdata);
+  CHECK(tokens[1].text == "<a>");
+  CHECK(tokens[2].type == XmlTokenType::EndElement);
+}
+
+TEST_CASE("Scan attribute values containing tag delimiters", "[xml]")
+{
+  XmlScanner scanner(R"(<a title="x > y" other='"'/>)");
+  const auto tokens = ScanAll(scanner);
+
+  REQUIRE(tokens.size() == 1);
+  CHECK(tokens[0].type == XmlTokenType::EmptyElement);
+  CHECK(FindAttribute(tokens[0].attributes, "title") == "x > y");
+  CHECK(FindAttribute(tokens[0].attributes, "other") == "\"");
+}
+
+TEST_CASE("Scan truncated XML", "[xml]")
+{
+  XmlScanner scanner("<gpx><trkpt lat=\"1");
+  XmlToken token;
+  REQUIRE(scanner.Next(token));
+  REQUIRE_THROWS_AS(scanner.Next(token), parse_error);
+}
+
+TEST_CASE("Find complete prefix of truncated XML", "[xml]")
+{
+  CHECK(CompleteXmlPrefix("") == 0);
+  CHECK(CompleteXmlPrefix("text") == 0);
+  CHECK(CompleteXmlPrefix("<gpx>") == 5);
+  CHECK(CompleteXmlPrefix("<gpx><trk") == 5);
+  CHECK(CompleteXmlPrefix("<gpx>text") == 5);
+  CHECK(CompleteXmlPrefix("<gpx>text<") == 5);
+  CHECK(CompleteXmlPrefix("<gpx><a title=\"x > y\"") == 5);
+  CHECK(CompleteXmlPrefix("<gpx><a title=\"x > y\"/>") == 23);
+  CHECK(CompleteXmlPrefix("<gpx><!-- <a> -") == 5);
+  CHECK(CompleteXmlPrefix("<gpx><!-- <a> -->") == 17);
+  CHECK(CompleteXmlPrefix("<gpx><![CDATA[<a>]]") == 5);
+  CHECK(CompleteXmlPrefix("<gpx><![CDATA[<a>]]>") == 20);
+  CHECK(CompleteXmlPrefix("<?xml version=\"1.0\"?") == 0);
+  CHECK(CompleteXmlPrefix("<!DOCTYPE gpx [ <!ENTITY x \"y\"> ") == 0);
+  CHECK(CompleteXmlPrefix("<!DOCTYPE gpx [ <!ENTITY x \"y\"> ]>") == 34);
+}
+
+TEST_CASE("Scan XML continued with appended data", "[xml]")
+{
+  const std::string_view data = "<gpx><name>Ride</name><trk>";
+  const size_t split = CompleteXmlPrefix(data.substr(0, 14));
+  REQUIRE(split == 11);
+
+  XmlScanner scanner(data.substr(0, split));
+  auto tokens = ScanAll(scanner);
+  REQUIRE(tokens.size() == 2);
+  CHECK(scanner.offset() == split);
+
+  scanner.Continue(data.substr(split));
+  tokens = ScanAll(scanner);
+  REQUIRE(tokens.size() == 3);
+  CHECK(tokens[0].text == "Ride");
+  CHECK(tokens[1].type == XmlTokenType::EndElement);
+  CHECK(tokens[2].name == "trk");
+  CHECK(scanner.offset() == data.size());
+}
+
+TEST_CASE("Scan rejects unsupported encodings", "[xml]")
+{
+  XmlToken token;
+
+  XmlScanner latin1(R"(<?xml version="1.0" encoding="ISO-8859-1"?><gpx/>)");
+  CHECK_THROWS_AS(latin1.Next(token), parse_error);
+
+  XmlScanner utf16(std::string_view("\xFF\xFE<\0g\0", 6));
+  CHECK_THROWS_AS(utf16.Next(token), parse_error);
+}
+
+TEST_CASE("Decode XML entities", "[xml]")
+{
+  std::string output;
+  AppendDecodedText(output, "a &lt;&gt;&amp;&quot;&apos; &#65;&#x42; &unknown; &");
+  CHECK(output == "a <>&\"' AB &unknown; &");
+
+  output.clear();
+  AppendDecodedText(output, "&#xE6;");
+  CHECK(output == "\xC3\xA6");
+}
@@ -1,21 +1,41 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <exception>
 #include <filesystem>
 #include <format>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 
 #include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
 #include <nanobind/operators.h>
 // #include <nanobind/stl/chrono.h>
 #include <nanobind/stl/filesystem.h>
 #include <nanobind/stl/optional.h>
+#include <nanobind/stl/pair.h>
 #include <nanobind/stl/string.h>
 #include <nanobind/stl/string_view.h>
 #include <nanobind/stl/tuple.h>
 #include <nanobind/stl/vector.h>
 
+#include "fastgpx/batch.hpp"
+#include "fastgpx/catalog.hpp"
 #include "fastgpx/fastgpx.hpp"
 #include "fastgpx/geom.hpp"
+#include "fastgpx/geotag.hpp"
+#include "fastgpx/parallel.hpp"
 #include "fastgpx/polyline.hpp"
+#include "fastgpx/spatial.hpp"
+#include "fastgpx/stream.hpp"
+#include "fastgpx/summary.hpp"
 
 #include "python_utc_chrono_nanobind.hpp"
 
@@ -44,6 +64,32 @@ polyline::Precision IntToPrecision(const int value)
   return precision;
 }
 
+// Read-only view of an object supporting the buffer protocol.
+class BufferView
+{
+public:
+  explicit BufferView(nb::handle object)
+  {
+    if (PyObject_GetBuffer(object.ptr(), &buffer_, PyBUF_SIMPLE) != 0)
+    {
+      throw nb::python_error();
+    }
+  }
+
+  BufferView(const BufferView&) = delete;
+  BufferView& operator=(const BufferView&) = delete;
+
+  ~BufferView() { PyBuffer_Release(&buffer_); }
+
+  std::string_view data() const
+  {
+    return {static_cast<const char*>(buffer_.buf), static_cast<size_t>(buffer_.len)};
+  }
+
+private:
+  Py_buffer buffer_{};
+};
+
 std::string FormatLatLongAsTuples(const LatLong& ll)
 {
   return std::format("({}, {}, {})", ll.latitude, ll.longitude, ll.elevation);
@@ -102,10 +148,395 @@ void SetBoundsMember(Bounds& self, std::optional<LatLong> Bounds::* field, doubl
   (self.*field).value().*Member = value;
 }
 
+// Events of a GPX file from the stream reader, or the document loaded with
+// pugixml when the stream reader rejects the file, such as for encodings other
+// than UTF-8.
+class GpxFileIterator
+{
+public:
+  explicit GpxFileIterator(std::filesystem::path path)
+      : path_(std::move(path)), reader_(std::make_unique<GpxStreamReader>(path_))
+  {
+  }
+
+protected:
+  // Next event of the stream reader, or empty at the end of the stream or after
+  // falling back to `document_`.
+  std::optional<GpxEvent> NextEvent()
+  {
+    if (!reader_)
+    {
+      return std::nullopt;
+    }
+    if (started_)
+    {
+      return reader_->Next();
+    }
+    try
+    {
+      auto event = reader_->Next();
+      started_ = true;
+      return event;
+    }
+    catch (const parse_error&)
+    {
+      // Throws the canonical error if pugixml fails too.
+      document_ = LoadGpx(path_);
+      reader_.reset();
+      return std::nullopt;
+    }
+  }
+
+  std::filesystem::path path_;
+  std::unique_ptr<GpxStreamReader> reader_;
+  std::optional<Gpx> document_;
+  bool started_ = false;
+  // Position in `document_`.
+  size_t track_ = 0;
+  size_t segment_ = 0;
+};
+
+// Python iterator over the <trkpt> of a GPX file without loading the whole file.
+class PointIterator : public GpxFileIterator
+{
+public:
+  using GpxFileIterator::GpxFileIterator;
+
+  std::tuple<size_t, size_t, LatLong> Next()
+  {
+    while (const auto event = NextEvent())
+    {
+      if (event->type == GpxEventType::Point)
+      {
+        return {event->track_index, event->segment_index, event->point};
+      }
+    }
+    while (document_ && track_ < document_->tracks.size())
+    {
+      const auto& segments = document_->tracks[track_].segments;
+      if (segment_ < segments.size() && point_ < segments[segment_].columns.size())
+      {
+        return {track_, segment_, segments[segment_].columns[point_++]};
+      }
+      point_ = 0;
+      if (segment_ < segments.size())
+      {
+        ++segment_;
+        continue;
+      }
+      segment_ = 0;
+      ++track_;
+    }
+    throw nb::stop_iteration();
+  }
+
+private:
+  size_t point_ = 0;
+};
+
+// Python iterator over the <trkseg> of a GPX file, holding one segment in memory at a time.
+class SegmentIterator : public GpxFileIterator
+{
+public:
+  using GpxFileIterator::GpxFileIterator;
+
+  std::tuple<size_t, size_t, Segment> Next()
+  {
+    Segment segment;
+    while (const auto event = NextEvent())
+    {
+      if (event->type == GpxEventType::SegmentBegin)
+      {
+        segment = Segment();
+      }
+      else if (event->type == GpxEventType::Point)
+      {
+        segment.columns.push_back(event->point, event->time);
+      }
+      else if (event->type == GpxEventType::SegmentEnd)
+      {
+        return {event->track_index, event->segment_index, std::move(segment)};
+      }
+    }
+    while (document_ && track_ < document_->tracks.size())
+    {
+      auto& segments = document_->tracks[track_].segments;
+      if (segment_ < segments.size())
+      {
+        const size_t index = segment_++;
+        return {track_, index, std::move(segments[index])};
+      }
+      segment_ = 0;
+      ++track_;
+    }
+    throw nb::stop_iteration();
+  }
+};
+
+// Python catalog, whose calls run with the GIL released. Serializes them, as
+// `Catalog` is not thread-safe.
+class PyCatalog
+{
+public:
+  explicit PyCatalog(std::filesystem::path index_path) : catalog_(std::move(index_path)) {}
+
+  template <typename Func>
+  auto With(Func&& func)
+  {
+    // Released before locking, such that a thread waiting for the lock doesn't
+    // hold the GIL the thread in the catalog may need.
+    nb::gil_scoped_release release;
+    std::lock_guard lock(mutex_);
+    return std::forward<Func>(func)(catalog_);
+  }
+
+private:
+  std::mutex mutex_;
+  Catalog catalog_;
+};
+
+// Workers of `load_async` and `load_many_async`, created on first use. Shut
+// down at interpreter exit, while the pending tasks can still complete their
+// futures.
+std::mutex async_pool_mutex;
+std::unique_ptr<ThreadPool> async_pool;
+
+ThreadPool& GetAsyncPool()
+{
+  const std::lock_guard lock(async_pool_mutex);
+  if (!async_pool)
+  {
+    async_pool = std::make_unique<ThreadPool>();
+  }
+  return *async_pool;
+}
+
+void ShutdownAsyncPool()
+{
+  std::unique_ptr<ThreadPool> pool;
+  {
+    const std::lock_guard lock(async_pool_mutex);
+    pool = std::move(async_pool);
+  }
+  // The tasks need the GIL to complete their futures.
+  nb::gil_scoped_release release;
+  pool.reset();
+}
+
+// asyncio future completed from a native worker thread. The references to the
+// future and its event loop are released with the GIL held when the result is
+// set, or when the task owning them is dropped without setting it.
+class AsyncResult
+{
+public:
+  // Creates a future on the running event loop. Requires the GIL.
+  AsyncResult()
+      : loop_(nb::module_::import_("asyncio").attr("get_running_loop")()),
+        future_(loop_.attr("create_future")())
+  {
+  }
+
+  AsyncResult(const AsyncResult&) = delete;
+  AsyncResult& operator=(const AsyncResult&) = delete;
+
+  // Acquires the GIL if the result was never set.
+  ~AsyncResult()
+  {
+    if (future_.is_valid())
+    {
+      nb::gil_scoped_acquire acquire;
+      [[maybe_unused]] const nb::object loop = std::move(loop_);
+      [[maybe_unused]] const nb::object future = std::move(future_);
+    }
+  }
+
+  // Requires the GIL.
+  nb::object future() const { return future_; }
+
+  // Acquires the GIL.
+  template<typename T>
+  void SetResult(T&& value)
+  {
+    nb::gil_scoped_acquire acquire;
+    Schedule("set_result", nb::cast(std::forward<T>(value)));
+  }
+
+  // Acquires the GIL. The error is rethrown through a bound function, such
+  // that nanobind translates it to the same Python exception as for a
+  // synchronous call.
+  void SetException(const std::exception_ptr& error)
+  {
+    nb::gil_scoped_acquire acquire;
+    const nb::object rethrow = nb::cpp_function([error] { std::rethrow_exception(error); });
+    try
+    {
+      rethrow();
+    }
+    catch (const nb::python_error& python_error)
+    {
+      Schedule("set_exception", nb::borrow(python_error.value()));
+    }
+  }
+
+private:
+  // Calls `future.<method>(value)` on the event loop thread, unless the future
+  // was cancelled in the meantime.
+  void Schedule(const char* method, nb::object value)
+  {
+    const nb::object loop = std::move(loop_);
+    const nb::object future = std::move(future_);
+    const nb::object complete = nb::cpp_function([method](nb::handle future, nb::handle value) {
+      if (!nb::cast<bool>(future.attr("done")()))
+      {
+        future.attr(method)(value);
+      }
+    });
+    try
+    {
+      loop.attr("call_soon_threadsafe")(complete, future, value);
+    }
+    catch (const nb::python_error&)
+    {
+      // The event loop is closed, nothing can await the future anymore.
+    }
+  }
+
+  nb::object loop_;
+  nb::object future_;
+};
+
+nb::object LoadGpxAsync(const std::filesystem::path& path, const LoadOptions& options)
+{
+  auto result = std::make_unique<AsyncResult>();
+  nb::object future = result->future();
+  GetAsyncPool().Submit([result = std::move(result), path, options] {
+    try
+    {
+      result->SetResult(LoadGpx(path, options));
+    }
+    catch (...)
+    {
+      result->SetException(std::current_exception());
+    }
+  });
+  return future;
+}
+
+nb::object LoadGpxFilesAsync(const std::vector<std::filesystem::path>& paths,
+                             const LoadOptions& options)
+{
+  // Shared by the tasks loading each file. The last to finish sets the result.
+  struct Batch
+  {
+    explicit Batch(size_t count) : gpx(count), errors(count), remaining(count) {}
+
+    AsyncResult result;
+    std::vector<Gpx> gpx;
+    std::vector<std::exception_ptr> errors;
+    std::atomic<size_t> remaining;
+  };
+
+  auto batch = std::make_shared<Batch>(paths.size());
+  nb::object future = batch->result.future();
+  if (paths.empty())
+  {
+    batch->result.SetResult(std::vector<Gpx>());
+    return future;
+  }
+
+  auto& pool = GetAsyncPool();
+  for (size_t index = 0; index < paths.size(); ++index)
+  {
+    pool.Submit([batch, index, path = paths[index], options] {
+      try
+      {
+        batch->gpx[index] = LoadGpx(path, options);
+      }
+      catch (...)
+      {
+        batch->errors[index] = std::current_exception();
+      }
+      if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      {
+        return;
+      }
+      // Like `load_many`, report the first file in order that failed.
+      for (const auto& error : batch->errors)
+      {
+        if (error)
+        {
+          batch->result.SetException(error);
+          return;
+        }
+      }
+      batch->result.SetResult(std::move(batch->gpx));
+    });
+  }
+  return future;
+}
+
+// Read-only NumPy view of a column of a `GeotagResult`, kept alive by the result.
+template<typename T>
+nb::ndarray<nb::numpy, const T, nb::ndim<1>> ColumnArray(const std::vector<T>& column)
+{
+  return nb::ndarray<nb::numpy, const T, nb::ndim<1>>(column.data(), {column.size()});
+}
+
+using Timestamps = nb::ndarray<const double, nb::ndim<1>, nb::device::cpu>;
+
+// Geotags POSIX timestamps in seconds. Timestamps that are NaN or beyond the
+// range of the clock are not matched.
+GeotagResult GeotagTimestamps(const Timestamps& timestamps,
+                              const std::vector<const Gpx*>& documents,
+                              const GeotagOptions& options)
+{
+  const auto view = timestamps.view();
+  const size_t count = timestamps.shape(0);
+  const double limit = std::chrono::duration<double>(chrono_timepoint::duration::max()).count() / 2;
+  std::vector<chrono_timepoint> times;
+  std::vector<size_t> positions;
+  times.reserve(count);
+  positions.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    const double seconds = view(i);
+    if (std::isfinite(seconds) && std::abs(seconds) < limit)
+    {
+      times.emplace_back(std::chrono::duration_cast<chrono_timepoint::duration>(
+          std::chrono::duration<double>(seconds)));
+      positions.push_back(i);
+    }
+  }
+
+  auto matched = Geotag(times, documents, options);
+  if (positions.size() == count)
+  {
+    return matched;
+  }
+  GeotagResult result(count);
+  for (size_t i = 0; i < positions.size(); ++i)
+  {
+    const size_t position = positions[i];
+    result.latitude[position] = matched.latitude[i];
+    result.longitude[position] = matched.longitude[i];
+    result.elevation[position] = matched.elevation[i];
+    result.document[position] = matched.document[i];
+    result.track[position] = matched.track[i];
+    result.segment[position] = matched.segment[i];
+  }
+  return result;
+}
+
 } // namespace
 
 NB_MODULE(fastgpx, m)
 {
+  // The metrics are computed without holding the GIL, such that Python threads
+  // can measure GPX data in parallel. Their lazy caches are thread-safe.
+  const auto release_gil = nb::call_guard<nb::gil_scoped_release>();
+
+  nb::module_::import_("atexit").attr("register")(nb::cpp_function(&ShutdownAsyncPool));
+
   nb::class_<TimeBounds>(m, "TimeBounds")
       .def(nb::init<>())
       .def(nb::init<std::optional<chrono_timepoint>, std::optional<chrono_timepoint>>(),
@@ -245,24 +676,58 @@ NB_MODULE(fastgpx, m)
         return std::format("Bounds(min={}, max={})", min, max);
       });
 
+  nb::enum_<Interpolation>(m, "Interpolation")
+      .value("Linear", Interpolation::Linear,
+             "Linear in latitude, longitude and elevation. Accurate for points close together.")
+      .value("GreatCircle", Interpolation::GreatCircle,
+             "Along the great circle between the points, with linear elevation.")
+      .doc() = "How a location between two points is estimated.";
+
   nb::class_<Segment>(m, "Segment")
       .def(nb::init<>()) // Default constructor
-      .def_rw("points", &Segment::points)
-      .def("bounds", &Segment::GetBounds)
-      .def("get_bounds", &Segment::GetBounds,
+      .def_prop_rw(
+          "points",
+          [](const Segment& self) {
+            const auto points = self.points();
+            return std::vector<LatLong>(points.begin(), points.end());
+          },
+          [](Segment& self, const std::vector<LatLong>& points) {
+            self.columns.clear();
+            self.columns.reserve(points.size());
+            for (const auto& point : points)
+            {
+              self.columns.push_back(point, std::nullopt);
+            }
+            self.ResetMetrics();
+          })
+      .def("bounds", &Segment::GetBounds, release_gil)
+      .def("get_bounds", &Segment::GetBounds, release_gil,
            ".. warning::\n\n"
            "   Compatibility with ``gpxpy.GPXTrackSegment.get_bounds``.\n"
            "   Prefer :func:`bounds` instead.\n") // gpxpy compatiblity
-      .def("time_bounds", &Segment::GetTimeBounds)
-      .def("get_time_bounds", &Segment::GetTimeBounds,
+      .def("time_bounds", &Segment::GetTimeBounds, release_gil)
+      .def("get_time_bounds", &Segment::GetTimeBounds, release_gil,
            ".. warning::\n\n"
            "   Compatibility with ``gpxpy.GPXTrackSegment.get_time_bounds``.\n"
            "   Prefer :func:`time_bounds` instead.\n") // gpxpy compatiblity
-      .def("length_2d", &Segment::GetLength2D, "Distance in meters.")
-      .def("length_3d", &Segment::GetLength3D, "Distance in meters.")
+      .def("length_2d", &Segment::GetLength2D, release_gil, "Distance in meters.")
+      .def("length_3d", &Segment::GetLength3D, release_gil, "Distance in meters.")
+      .def("location_at", &Segment::GetLocationAt, "time"_a,
+           "interpolation"_a = Interpolation::Linear, release_gil,
+           "Location at ``time``, interpolated between the points recorded right before and "
+           "after it. ``None`` if ``time`` is outside of the time bounds of the segment.")
+      .def(
+          "locations_at",
+          [](const Segment& self, const std::vector<chrono_timepoint>& times,
+             const Interpolation interpolation) {
+            return self.GetLocationsAt(times, interpolation);
+          },
+          "times"_a, "interpolation"_a = Interpolation::Linear, release_gil,
+          "Like :func:`location_at` for many sorted times at once, in a single pass.\n\n"
+          ":raises ValueError: If ``times`` is not sorted.")
       .def("__repr__",
            [](const Segment& s) {
-             return std::format("<fastgpx.Segment(points: {})>", s.points.size());
+             return std::format("<fastgpx.Segment(points: {})>", s.columns.size());
            })
       .doc() = "Represent ``<trkseg>`` data in GPX files.";
 
@@ -274,18 +739,18 @@ NB_MODULE(fastgpx, m)
       .def_rw("number", &Track::number)
       .def_rw("type", &Track::type)
       .def_rw("segments", &Track::segments)
-      .def("bounds", &Track::GetBounds)
-      .def("get_bounds", &Track::GetBounds,
+      .def("bounds", &Track::GetBounds, release_gil)
+      .def("get_bounds", &Track::GetBounds, release_gil,
            ".. warning::\n\n"
            "   Compatibility with ``gpxpy.GPXTrack.get_bounds``.\n"
            "   Prefer :func:`bounds` instead.\n") // gpxpy compatiblity
-      .def("time_bounds", &Track::GetTimeBounds)
-      .def("get_time_bounds", &Track::GetTimeBounds,
+      .def("time_bounds", &Track::GetTimeBounds, release_gil)
+      .def("get_time_bounds", &Track::GetTimeBounds, release_gil,
            ".. warning::\n\n"
            "   Compatibility with ``gpxpy.GPXTrack.get_time_bounds``.\n"
            "   Prefer :func:`time_bounds` instead.\n") // gpxpy compatiblity
-      .def("length_2d", &Track::GetLength2D, "Distance in meters.")
-      .def("length_3d", &Track::GetLength3D, "Distance in meters.")
+      .def("length_2d", &Track::GetLength2D, release_gil, "Distance in meters.")
+      .def("length_3d", &Track::GetLength3D, release_gil, "Distance in meters.")
       .def("__repr__",
            [](const Track& t) {
              return std::format("<fastgpx.Track(segments: {})>", t.segments.size());
@@ -296,18 +761,18 @@ NB_MODULE(fastgpx, m)
       .def(nb::init<>()) // Default constructor
       .def_rw("tracks", &Gpx::tracks)
       .def_rw("name", &Gpx::name)
-      .def("bounds", &Gpx::GetBounds)
-      .def("get_bounds", &Gpx::GetBounds,
+      .def("bounds", &Gpx::GetBounds, release_gil)
+      .def("get_bounds", &Gpx::GetBounds, release_gil,
            ".. warning::\n\n"
            "   Compatibility with ``gpxpy.GPX.get_bounds``.\n"
            "   Prefer :func:`bounds` instead.\n") // gpxpy compatiblity
-      .def("time_bounds", &Gpx::GetTimeBounds)
-      .def("get_time_bounds", &Gpx::GetTimeBounds,
+      .def("time_bounds", &Gpx::GetTimeBounds, release_gil)
+      .def("get_time_bounds", &Gpx::GetTimeBounds, release_gil,
            ".. warning::\n\n"
            "   Compatibility with ``gpxpy.GPX.get_time_bounds``.\n"
            "   Prefer :func:`time_bounds` instead.\n") // gpxpy compatiblity
-      .def("length_2d", &Gpx::GetLength2D, "Distance in meters.")
-      .def("length_3d", &Gpx::GetLength3D, "Distance in meters.")
+      .def("length_2d", &Gpx::GetLength2D, release_gil, "Distance in meters.")
+      .def("length_3d", &Gpx::GetLength3D, release_gil, "Distance in meters.")
       .def("__repr__",
            [](const Gpx& g) {
              if (g.name.has_value())
@@ -319,14 +784,461 @@ NB_MODULE(fastgpx, m)
            })
       .doc() = "Represent ``<gpx>`` data in GPX files.";
 
-  m.def("load", &LoadGpx, "path"_a);
-  m.def("parse", &ParseGpx, "data"_a);
+  nb::class_<SegmentSummary>(m, "SegmentSummary")
+      .def_ro("point_count", &SegmentSummary::point_count)
+      .def("bounds", [](const SegmentSummary& s) { return s.bounds; })
+      .def("time_bounds", [](const SegmentSummary& s) { return s.time_bounds; })
+      .def("length_2d", [](const SegmentSummary& s) { return s.length2d; }, "Distance in meters.")
+      .def("length_3d", [](const SegmentSummary& s) { return s.length3d; }, "Distance in meters.")
+      .def("__repr__",
+           [](const SegmentSummary& s) {
+             return std::format("<fastgpx.SegmentSummary(points: {})>", s.point_count);
+           })
+      .doc() = "Metrics of a ``<trkseg>``, matching those computed by :class:`Segment`.";
+
+  nb::class_<TrackSummary>(m, "TrackSummary")
+      .def_ro("name", &TrackSummary::name)
+      .def_ro("segments", &TrackSummary::segments)
+      .def("bounds", [](const TrackSummary& t) { return t.bounds; })
+      .def("time_bounds", [](const TrackSummary& t) { return t.time_bounds; })
+      .def("length_2d", [](const TrackSummary& t) { return t.length2d; }, "Distance in meters.")
+      .def("length_3d", [](const TrackSummary& t) { return t.length3d; }, "Distance in meters.")
+      .def("__repr__",
+           [](const TrackSummary& t) {
+             return std::format("<fastgpx.TrackSummary(segments: {})>", t.segments.size());
+           })
+      .doc() = "Metrics of a ``<trk>``, matching those computed by :class:`Track`.";
+
+  nb::class_<GpxSummary>(m, "GpxSummary")
+      .def_ro("name", &GpxSummary::name)
+      .def_ro("tracks", &GpxSummary::tracks)
+      .def("bounds", [](const GpxSummary& g) { return g.bounds; })
+      .def("time_bounds", [](const GpxSummary& g) { return g.time_bounds; })
+      .def("length_2d", [](const GpxSummary& g) { return g.length2d; }, "Distance in meters.")
+      .def("length_3d", [](const GpxSummary& g) { return g.length3d; }, "Distance in meters.")
+      .def("__repr__",
+           [](const GpxSummary& g) {
+             return std::format("<fastgpx.GpxSummary(tracks: {})>", g.tracks.size());
+           })
+      .doc() = "Metrics of GPX data, matching those computed by :class:`Gpx`.";
+
+  nb::class_<PointIterator>(m, "PointIterator")
+      .def("__iter__", [](PointIterator& self) -> PointIterator& { return self; },
+           nb::rv_policy::reference)
+      // Serializes threads sharing the iterator on free-threaded Python.
+      .def("__next__", &PointIterator::Next, nb::lock_self())
+      .doc() = "Iterator yielding ``(track_index, segment_index, point)`` for each ``<trkpt>``.";
+
+  nb::class_<SegmentIterator>(m, "SegmentIterator")
+      .def("__iter__", [](SegmentIterator& self) -> SegmentIterator& { return self; },
+           nb::rv_policy::reference)
+      .def("__next__", &SegmentIterator::Next, nb::lock_self())
+      .doc() = "Iterator yielding ``(track_index, segment_index, segment)`` for each ``<trkseg>``.";
+
+  nb::class_<ParseOptions>(m, "ParseOptions")
+      .def(
+          "__init__",
+          [](ParseOptions* self, bool elevation, bool time, bool metadata,
+             std::optional<size_t> track_index, std::optional<std::string> track_name) {
+            new (self) ParseOptions{
+                .elevation = elevation,
+                .time = time,
+                .metadata = metadata,
+                .track_index = track_index,
+                .track_name = std::move(track_name),
+            };
+          },
+          nb::kw_only(), "elevation"_a = true, "time"_a = true, "metadata"_a = true,
+          "track_index"_a.none() = nb::none(), "track_name"_a.none() = nb::none())
+      .def_rw("elevation", &ParseOptions::elevation, "Parse ``<trkpt><ele>``.")
+      .def_rw("time", &ParseOptions::time, "Parse ``<trkpt><time>``.")
+      .def_rw("metadata", &ParseOptions::metadata,
+              "Parse ``<metadata><name>`` and ``<trk><name>``.")
+      .def_rw("track_index", &ParseOptions::track_index, "track_index"_a.none(),
+              "Only parse the ``<trk>`` with this index in the document.")
+      .def_rw("track_name", &ParseOptions::track_name, "track_name"_a.none(),
+              "Only parse the ``<trk>`` elements with this ``<name>``.")
+      .def("__repr__",
+           [](const ParseOptions& o) {
+             const auto track_name =
+                 o.track_name.has_value() ? nb::repr(nb::cast(*o.track_name)) : nb::str("None");
+             return std::format(
+                 "fastgpx.ParseOptions(elevation={}, time={}, metadata={}, track_index={}, "
+                 "track_name={})",
+                 o.elevation ? "True" : "False", o.time ? "True" : "False",
+                 o.metadata ? "True" : "False",
+                 o.track_index.has_value() ? std::to_string(*o.track_index) : "None",
+                 track_name.c_str());
+           })
+      .doc() = "Selects which parts of the GPX data to extract. Skipped fields are left at "
+               "their default values.";
+
+  nb::class_<LoadOptions>(m, "LoadOptions")
+      .def(
+          "__init__",
+          [](LoadOptions* self, bool memory_map, const ParseOptions& parse, size_t threads,
+             std::optional<std::filesystem::path> cache_dir) {
+            new (self) LoadOptions{.memory_map = memory_map,
+                                   .parse = parse,
+                                   .threads = threads,
+                                   .cache_dir = std::move(cache_dir)};
+          },
+          nb::kw_only(), "memory_map"_a = false,
+          "parse"_a.sig("ParseOptions()") = ParseOptions(), "threads"_a = 1,
+          "cache_dir"_a.none() = nb::none())
+      .def_rw("memory_map", &LoadOptions::memory_map,
+              "Memory-map the file and parse it in place instead of reading it into a heap "
+              "buffer.")
+      .def_rw("parse", &LoadOptions::parse, "Selects which parts of the GPX data to extract.")
+      .def_rw("threads", &LoadOptions::threads,
+              "Parse the points of large files on this many threads, or 0 for one per CPU "
+              "core. Implies ``memory_map``.")
+      .def_rw("cache_dir", &LoadOptions::cache_dir,
+              "Keep a binary copy of the parsed document in this directory, read instead of the "
+              "GPX file while the size and modification time of the file match.")
+      .def("__repr__",
+           [](const LoadOptions& o) {
+             return std::format(
+                 "fastgpx.LoadOptions(memory_map={}, parse={}, threads={}, cache_dir={})",
+                 o.memory_map ? "True" : "False", nb::repr(nb::cast(o.parse)).c_str(), o.threads,
+                 nb::repr(nb::cast(o.cache_dir)).c_str());
+           })
+      .doc() = "Options for :func:`load`.";
+
+  // The polls hold the GIL and lock the reader, such that the document is not
+  // read while it is updated.
+  nb::class_<GpxTailReader>(m, "TailReader")
+      .def(nb::init<std::filesystem::path, const ParseOptions&>(), "path"_a,
+           "options"_a.sig("ParseOptions()") = ParseOptions())
+      .def("poll", &GpxTailReader::Poll, nb::lock_self(),
+           "Parse the data appended to the file since the previous poll, returning the number "
+           "of points added. A file that became shorter is read again from the start.")
+      .def_prop_ro(
+          "gpx", [](const GpxTailReader& self) -> const Gpx& { return self.gpx(); },
+          nb::rv_policy::reference_internal, nb::lock_self(),
+          "The document parsed so far. Points are added to the last segment of the last track "
+          "while it is open.")
+      .def_prop_ro("offset", &GpxTailReader::offset,
+                   "Number of bytes parsed, not counting markup truncated at the end.")
+      .def_prop_ro("finished", &GpxTailReader::finished,
+                   "True once the closing ``</gpx>`` has been read.")
+      .def("__repr__",
+           [](const GpxTailReader& self) {
+             return std::format("<fastgpx.TailReader(offset: {}, finished: {})>", self.offset(),
+                                self.finished() ? "True" : "False");
+           })
+      .doc() = "Incrementally parses a GPX file while it is being written, such as by a logger "
+               "appending points to an open recording. Each poll parses only the appended data, "
+               "and updates the metrics already computed for the open segment instead of "
+               "computing them again.";
+
+  nb::class_<CatalogEntry>(m, "CatalogEntry")
+      .def_ro("path", &CatalogEntry::path)
+      .def_ro("size", &CatalogEntry::size, "File size in bytes.")
+      .def_ro("content_hash", &CatalogEntry::content_hash, "FNV-1a hash of the file content.")
+      .def_ro("track_count", &CatalogEntry::track_count)
+      .def_ro("point_count", &CatalogEntry::point_count)
+      .def_ro("error", &CatalogEntry::error,
+              "Message of the error if the file could not be parsed, else ``None``.")
+      .def("bounds", [](const CatalogEntry& e) { return e.bounds; })
+      .def("time_bounds", [](const CatalogEntry& e) { return e.time_bounds; })
+      .def("length_2d", [](const CatalogEntry& e) { return e.length2d; }, "Distance in meters.")
+      .def("length_3d", [](const CatalogEntry& e) { return e.length3d; }, "Distance in meters.")
+      .def("__repr__",
+           [](const CatalogEntry& e) {
+             return std::format("<fastgpx.CatalogEntry({}, points: {})>",
+                                nb::repr(nb::cast(e.path)).c_str(), e.point_count);
+           })
+      .doc() = "Summary of one GPX file in a :class:`Catalog`.";
+
+  nb::class_<CatalogUpdate>(m, "CatalogUpdate")
+      .def_ro("added", &CatalogUpdate::added)
+      .def_ro("updated", &CatalogUpdate::updated)
+      .def_ro("removed", &CatalogUpdate::removed)
+      .def_ro("unchanged", &CatalogUpdate::unchanged)
+      .def("__repr__",
+           [](const CatalogUpdate& u) {
+             return std::format(
+                 "fastgpx.CatalogUpdate(added={}, updated={}, removed={}, unchanged={})", u.added,
+                 u.updated, u.removed, u.unchanged);
+           })
+      .doc() = "Counts of the entries changed by :meth:`Catalog.update`.";
+
+  const auto make_query = [](std::optional<Bounds> bounds, std::optional<chrono_timepoint> start,
+                             std::optional<chrono_timepoint> end) {
+    return CatalogQuery{.bounds = std::move(bounds), .start_time = start, .end_time = end};
+  };
+  nb::class_<PyCatalog>(m, "Catalog")
+      .def(nb::init<std::filesystem::path>(), "index_path"_a,
+           "Open the index file, or start an empty catalog if it doesn't exist yet or cannot "
+           "be read.")
+      .def(
+          "update",
+          [](PyCatalog& self, const std::filesystem::path& root, std::string_view pattern,
+             bool recursive, size_t threads) {
+            return self.With([&](Catalog& catalog) {
+              return catalog.Update(root, pattern, recursive, threads);
+            });
+          },
+          "root"_a, "pattern"_a = "*.gpx", "recursive"_a = true, "threads"_a = 0,
+          "Scan a directory tree and bring the entries of its files up to date. Only new and "
+          "changed files are parsed, and the entries of removed files are dropped. "
+          "``threads=0`` uses one thread per CPU core.")
+      .def_prop_ro(
+          "entries",
+          [](PyCatalog& self) {
+            return self.With([](Catalog& catalog) {
+              const auto entries = catalog.entries();
+              return std::vector<CatalogEntry>(entries.begin(), entries.end());
+            });
+          },
+          "Entries sorted by path.")
+      .def(
+          "find",
+          [](PyCatalog& self, const std::filesystem::path& path) {
+            return self.With([&](Catalog& catalog) -> std::optional<CatalogEntry> {
+              const CatalogEntry* entry = catalog.Find(path);
+              return entry != nullptr ? std::optional(*entry) : std::nullopt;
+            });
+          },
+          "path"_a, "Entry of the file at ``path``, or ``None``.")
+      .def(
+          "query",
+          [make_query](PyCatalog& self, std::optional<Bounds> bounds,
+                       std::optional<chrono_timepoint> start_time,
+                       std::optional<chrono_timepoint> end_time) {
+            const auto query = make_query(std::move(bounds), start_time, end_time);
+            return self.With([&](Catalog& catalog) { return catalog.Query(query); });
+          },
+          nb::kw_only(), "bounds"_a.none() = nb::none(), "start_time"_a.none() = nb::none(),
+          "end_time"_a.none() = nb::none(),
+          "Entries whose bounds overlap ``bounds`` and whose time bounds overlap "
+          "``[start_time, end_time)``, sorted by path. Files without times are excluded when "
+          "filtering by time.")
+      .def(
+          "total_length_2d",
+          [make_query](PyCatalog& self, std::optional<Bounds> bounds,
+                       std::optional<chrono_timepoint> start_time,
+                       std::optional<chrono_timepoint> end_time) {
+            const auto query = make_query(std::move(bounds), start_time, end_time);
+            return self.With([&](Catalog& catalog) { return catalog.TotalLength2D(query); });
+          },
+          nb::kw_only(), "bounds"_a.none() = nb::none(), "start_time"_a.none() = nb::none(),
+          "end_time"_a.none() = nb::none(),
+          "Sum of the 2D lengths in meters of the entries matching the filters of "
+          ":meth:`query`.")
+      .def(
+          "compact",
+          [](PyCatalog& self) { self.With([](Catalog& catalog) { catalog.Compact(); }); },
+          "Rewrite the index file with only the current entries.")
+      .def("__len__",
+           [](PyCatalog& self) {
+             return self.With([](Catalog& catalog) { return catalog.entries().size(); });
+           })
+      .doc() = "Persistent index of per-file summaries of a corpus of GPX files. Updates "
+               "append the entries of new and changed files to the index file, such that "
+               "queries over a large corpus don't read the GPX files again.";
+
+  nb::class_<SpatialMatch>(m, "SpatialMatch")
+      .def_ro("document", &SpatialMatch::document,
+              "Index of the document in the documents the index was built from.")
+      .def_ro("track", &SpatialMatch::track)
+      .def_ro("segment", &SpatialMatch::segment)
+      .def_ro("first_point", &SpatialMatch::first_point)
+      .def_ro("end_point", &SpatialMatch::end_point, "One past the last point of the range.")
+      .def(nb::self == nb::self, nb::sig("def __eq__(self, arg: object, /) -> bool"))
+      .def("__repr__",
+           [](const SpatialMatch& match) {
+             return std::format("fastgpx.SpatialMatch(document={}, track={}, segment={}, "
+                                "first_point={}, end_point={})",
+                                match.document, match.track, match.segment, match.first_point,
+                                match.end_point);
+           })
+      .doc() = "Range of points of a segment found by a :class:`SpatialIndex` query.";
+
+  // Immutable once built, so the queries run without the GIL.
+  nb::class_<SpatialIndex>(m, "SpatialIndex")
+      .def(
+          "__init__",
+          [](SpatialIndex* self, const std::vector<const Gpx*>& documents, size_t chunk_size) {
+            new (self) SpatialIndex(documents, chunk_size);
+          },
+          "documents"_a, "chunk_size"_a = SpatialIndex::kDefaultChunkSize, release_gil,
+          nb::sig("def __init__(self, documents: Sequence[Gpx], chunk_size: int = 32) -> None"),
+          "Build the index over the segments of ``documents``, split into chunks of up to "
+          "``chunk_size`` points.")
+      .def("query", &SpatialIndex::Query, "bounds"_a, release_gil,
+           "Ranges of the points whose chunks overlap ``bounds``, sorted by document, track, "
+           "segment and point. The ranges are candidates: a chunk can overlap while none of "
+           "its points do.")
+      .def("query_radius", &SpatialIndex::QueryRadius, "center"_a, "radius"_a, release_gil,
+           "Ranges of the points whose chunks come within ``radius`` meters of ``center``.")
+      .def("bounds", &SpatialIndex::GetBounds, "Bounds of all indexed points.")
+      .def_prop_ro("chunk_size", &SpatialIndex::chunk_size)
+      .def("__len__", &SpatialIndex::size, "Number of chunks.")
+      .def("save", &SpatialIndex::Save, "path"_a, release_gil,
+           "Write the index to a binary file.")
+      .def_static("load", &SpatialIndex::Load, "path"_a, release_gil,
+                  "Read an index written by :meth:`save`.")
+      .def("__repr__",
+           [](const SpatialIndex& index) {
+             return std::format("<fastgpx.SpatialIndex(chunks: {}, chunk_size: {})>",
+                                index.size(), index.chunk_size());
+           })
+      .doc() = "R-tree over the bounding boxes of chunks of the segments of many documents, "
+               "for finding which of them pass through an area.";
+
+  nb::class_<GeotagResult>(m, "GeotagResult")
+      .def_prop_ro(
+          "latitude", [](const GeotagResult& self) { return ColumnArray(self.latitude); },
+          nb::rv_policy::reference_internal, "Degrees, NaN for the times without a match.")
+      .def_prop_ro(
+          "longitude", [](const GeotagResult& self) { return ColumnArray(self.longitude); },
+          nb::rv_policy::reference_internal, "Degrees, NaN for the times without a match.")
+      .def_prop_ro(
+          "elevation", [](const GeotagResult& self) { return ColumnArray(self.elevation); },
+          nb::rv_policy::reference_internal, "Meters, NaN for the times without a match.")
+      .def_prop_ro(
+          "document", [](const GeotagResult& self) { return ColumnArray(self.document); },
+          nb::rv_policy::reference_internal,
+          "Index of the matched document, -1 for the times without a match.")
+      .def_prop_ro(
+          "track", [](const GeotagResult& self) { return ColumnArray(self.track); },
+          nb::rv_policy::reference_internal,
+          "Index of the matched track, -1 for the times without a match.")
+      .def_prop_ro(
+          "segment", [](const GeotagResult& self) { return ColumnArray(self.segment); },
+          nb::rv_policy::reference_internal,
+          "Index of the matched segment, -1 for the times without a match.")
+      .def("__len__", &GeotagResult::size)
+      .def("__repr__",
+           [](const GeotagResult& self) {
+             return std::format("<fastgpx.GeotagResult(times: {})>", self.size());
+           })
+      .doc() = "Locations matched to times by :func:`geotag`, as read-only NumPy arrays with "
+               "one element per time.";
+
+  m.def(
+      "geotag",
+      [](const Timestamps& timestamps, const std::vector<const Gpx*>& documents,
+         const std::optional<chrono_timepoint::duration> max_gap,
+         const Interpolation interpolation, const size_t threads) {
+        return GeotagTimestamps(timestamps, documents,
+                                {.max_gap = max_gap, .interpolation = interpolation,
+                                 .threads = threads});
+      },
+      "timestamps"_a, "documents"_a, "max_gap"_a.none() = nb::none(),
+      "interpolation"_a = Interpolation::Linear, "threads"_a = 0, release_gil,
+      "Find the location at each of ``timestamps``, POSIX times in seconds such as photo "
+      "capture times, in the segments of ``documents``. Times are interpolated between the "
+      "points before and after them, unless these are more than ``max_gap`` apart. Times "
+      "within ``max_gap`` before or after a segment take the location of its first or last "
+      "point. Where segments overlap in time, the one with the closest point wins. "
+      "``threads=0`` uses one thread per CPU core.");
+  m.def(
+      "geotag",
+      [](const std::vector<chrono_timepoint>& times, const std::vector<const Gpx*>& documents,
+         const std::optional<chrono_timepoint::duration> max_gap,
+         const Interpolation interpolation, const size_t threads) {
+        return Geotag(times, documents,
+                      {.max_gap = max_gap, .interpolation = interpolation, .threads = threads});
+      },
+      "times"_a, "documents"_a, "max_gap"_a.none() = nb::none(),
+      "interpolation"_a = Interpolation::Linear, "threads"_a = 0, release_gil,
+      "Like above for a sequence of ``datetime`` values.");
+  m.def(
+      "load",
+      [](const std::filesystem::path& path, const LoadOptions& options) {
+        return LoadGpx(path, options);
+      },
+      "path"_a, "options"_a.sig("LoadOptions()") = LoadOptions(),
+      nb::call_guard<nb::gil_scoped_release>());
+  m.def(
+      "load_many",
+      [](const std::vector<std::filesystem::path>& paths, const LoadOptions& options,
+         size_t threads) { return LoadGpxFiles(paths, options, threads); },
+      "paths"_a, "options"_a.sig("LoadOptions()") = LoadOptions(), "threads"_a = 0,
+      nb::call_guard<nb::gil_scoped_release>(),
+      "Load multiple GPX files concurrently, returned in the same order as ``paths``. "
+      "``threads=0`` uses one thread per CPU core.");
+  m.def("load_async", &LoadGpxAsync, "path"_a, "options"_a.sig("LoadOptions()") = LoadOptions(),
+        nb::sig("def load_async(path: str | os.PathLike, options: LoadOptions = LoadOptions()) "
+                "-> asyncio.Future[Gpx]"),
+        "Load a GPX file on a native worker thread, without blocking the event loop. Returns "
+        "a future of the running event loop. Cancelling it discards the result, but does "
+        "not stop the load.");
+  m.def("load_many_async", &LoadGpxFilesAsync, "paths"_a,
+        "options"_a.sig("LoadOptions()") = LoadOptions(),
+        nb::sig("def load_many_async(paths: Sequence[str | os.PathLike], options: LoadOptions = "
+                "LoadOptions()) -> asyncio.Future[list[Gpx]]"),
+        "Load multiple GPX files concurrently on native worker threads, without blocking the "
+        "event loop. The future resolves to the files in the same order as ``paths``.");
+  m.def(
+      "load_directory",
+      [](const std::filesystem::path& root, std::string_view pattern, bool recursive,
+         const LoadOptions& options, size_t threads) {
+        return LoadGpxDirectory(root, pattern, recursive, options, threads);
+      },
+      "root"_a, "pattern"_a = "*.gpx", "recursive"_a = true,
+      "options"_a.sig("LoadOptions()") = LoadOptions(), "threads"_a = 0,
+      nb::call_guard<nb::gil_scoped_release>(),
+      "Load the GPX files in a directory concurrently, largest files first. Returns "
+      "``(path, gpx)`` pairs sorted by path.");
+  m.def(
+      "load_archive",
+      [](const std::filesystem::path& path, const ParseOptions& options, size_t threads) {
+        return LoadGpxArchive(path, options, threads);
+      },
+      "path"_a, "options"_a.sig("ParseOptions()") = ParseOptions(), "threads"_a = 0,
+      nb::call_guard<nb::gil_scoped_release>(),
+      "Load the GPX files in a ZIP archive concurrently, decompressing them in memory. "
+      "Returns ``(path, gpx)`` pairs in archive order, with paths relative to the archive.");
+  // The string is immutable and kept alive by the call, so it can be parsed
+  // without the GIL.
+  m.def(
+      "parse",
+      [](std::string_view data, const ParseOptions& options) { return ParseGpx(data, options); },
+      "data"_a, "options"_a.sig("ParseOptions()") = ParseOptions(),
+      nb::call_guard<nb::gil_scoped_release>());
+  m.def(
+      "parse_buffer",
+      [](nb::handle data, const ParseOptions& options) {
+        const BufferView buffer(data);
+        nb::gil_scoped_release release;
+        return ParseGpx(buffer.data(), options);
+      },
+      "data"_a, "options"_a = ParseOptions(),
+      nb::sig("def parse_buffer(data: collections.abc.Buffer, options: ParseOptions = "
+              "ParseOptions()) -> Gpx"),
+      "Parse GPX data from a bytes-like object, such as ``bytes``, ``memoryview`` or "
+      "``mmap``, without copying it.");
+  m.def(
+      "summarize",
+      [](const std::filesystem::path& path, const ParseOptions& options) {
+        return SummarizeGpx(path, options);
+      },
+      "path"_a, "options"_a.sig("ParseOptions()") = ParseOptions(),
+      nb::call_guard<nb::gil_scoped_release>(),
+      "Compute the lengths, bounds and time bounds of a GPX file without keeping its points "
+      "in memory.");
+
+  m.def(
+      "iter_points", [](const std::filesystem::path& path) { return PointIterator(path); },
+      "path"_a,
+      "Stream the points of a GPX file without loading the whole file into memory. Files the "
+      "stream reader doesn't handle, such as in other encodings than UTF-8, are loaded whole.");
+  m.def(
+      "iter_segments", [](const std::filesystem::path& path) { return SegmentIterator(path); },
+      "path"_a,
+      "Stream the segments of a GPX file, holding only one segment in memory at a time. Files "
+      "the stream reader doesn't handle, such as in other encodings than UTF-8, are loaded whole.");
 
   // fastgpx geo
 
   nb::module_ geo_mod = m.def_submodule("geo");
 
-  geo_mod.def("haversine", &haversine, "latlong1"_a, "latlong2"_a,
+  geo_mod.def("haversine", nb::overload_cast<const LatLong&, const LatLong&>(&haversine),
+              "latlong1"_a, "latlong2"_a,
               "Haversine distance returned in meters using ``osmium`` logic.");
 
   // Signature compatibility with gpxpy.geo.haversine_distance
@@ -362,22 +1274,22 @@ NB_MODULE(fastgpx, m)
       [](const std::vector<LatLong>& points, polyline::Precision precision) {
         return polyline::encode(points, precision);
       },
-      "locations"_a, "precision"_a = polyline::Precision::Five);
+      "locations"_a, "precision"_a = polyline::Precision::Five, release_gil);
 
   polyline_mod.def(
       "encode",
       [](const std::vector<LatLong>& points, int precision) {
         return polyline::encode(points, IntToPrecision(precision));
       },
-      "locations"_a, "precision"_a = 5);
+      "locations"_a, "precision"_a = 5, release_gil);
 
   polyline_mod.def("decode", &polyline::decode, "encoded"_a,
-                   "precision"_a = polyline::Precision::Five);
+                   "precision"_a = polyline::Precision::Five, release_gil);
 
   polyline_mod.def(
       "decode",
       [](const std::string_view encoded, int precision) {
         return polyline::decode(encoded, IntToPrecision(precision));
       },
-      "locations"_a, "precision"_a = 5);
+      "locations"_a, "precision"_a = 5, release_gil);
 }
@@ -1,7 +1,14 @@
+import asyncio
+import collections.abc
 from collections.abc import Sequence
 import datetime
+import enum
 import os
-from typing import overload
+import pathlib
+from typing import Annotated, overload
+
+import numpy
+from numpy.typing import ArrayLike, NDArray
 
 from . import geo as geo, polyline as polyline
 
@@ -166,6 +173,17 @@ class Bounds:
 
     def __str__(self) -> str: ...
 
+class Interpolation(enum.Enum):
+    """How a location between two points is estimated."""
+
+    Linear = 0
+    """
+    Linear in latitude, longitude and elevation. Accurate for points close together.
+    """
+
+    GreatCircle = 1
+    """Along the great circle between the points, with linear elevation."""
+
 class Segment:
     """Represent ``<trkseg>`` data in GPX files."""
 
@@ -203,6 +221,18 @@ class Segment:
     def length_3d(self) -> float:
         """Distance in meters."""
 
+    def location_at(self, time: datetime.datetime | datetime.date | datetime.time, interpolation: Interpolation = Interpolation.Linear) -> LatLong | None:
+        """
+        Location at ``time``, interpolated between the points recorded right before and after it. ``None`` if ``time`` is outside of the time bounds of the segment.
+        """
+
+    def locations_at(self, times: Sequence[datetime.datetime | datetime.date | datetime.time], interpolation: Interpolation = Interpolation.Linear) -> list[LatLong | None]:
+        """
+        Like :func:`location_at` for many sorted times at once, in a single pass.
+
+        :raises ValueError: If ``times`` is not sorted.
+        """
+
     def __repr__(self) -> str: ...
 
 class Track:
@@ -319,6 +349,427 @@ class Gpx:
 
     def __repr__(self) -> str: ...
 
-def load(path: str | os.PathLike) -> Gpx: ...
+class SegmentSummary:
+    """Metrics of a ``<trkseg>``, matching those computed by :class:`Segment`."""
+
+    @property
+    def point_count(self) -> int: ...
+
+    def bounds(self) -> Bounds: ...
+
+    def time_bounds(self) -> TimeBounds: ...
+
+    def length_2d(self) -> float:
+        """Distance in meters."""
+
+    def length_3d(self) -> float:
+        """Distance in meters."""
+
+    def __repr__(self) -> str: ...
+
+class TrackSummary:
+    """Metrics of a ``<trk>``, matching those computed by :class:`Track`."""
+
+    @property
+    def name(self) -> str | None: ...
+
+    @property
+    def segments(self) -> list[SegmentSummary]: ...
+
+    def bounds(self) -> Bounds: ...
+
+    def time_bounds(self) -> TimeBounds: ...
+
+    def length_2d(self) -> float:
+        """Distance in meters."""
+
+    def length_3d(self) -> float:
+        """Distance in meters."""
+
+    def __repr__(self) -> str: ...
+
+class GpxSummary:
+    """Metrics of GPX data, matching those computed by :class:`Gpx`."""
+
+    @property
+    def name(self) -> str | None: ...
+
+    @property
+    def tracks(self) -> list[TrackSummary]: ...
+
+    def bounds(self) -> Bounds: ...
+
+    def time_bounds(self) -> TimeBounds: ...
+
+    def length_2d(self) -> float:
+        """Distance in meters."""
+
+    def length_3d(self) -> float:
+        """Distance in meters."""
+
+    def __repr__(self) -> str: ...
+
+class PointIterator:
+    """
+    Iterator yielding ``(track_index, segment_index, point)`` for each ``<trkpt>``.
+    """
+
+    def __iter__(self) -> PointIterator: ...
+
+    def __next__(self) -> tuple[int, int, LatLong]: ...
+
+class SegmentIterator:
+    """
+    Iterator yielding ``(track_index, segment_index, segment)`` for each ``<trkseg>``.
+    """
+
+    def __iter__(self) -> SegmentIterator: ...
+
+    def __next__(self) -> tuple[int, int, Segment]: ...
+
+class ParseOptions:
+    """
+    Selects which parts of the GPX data to extract. Skipped fields are left at their default values.
+    """
+
+    def __init__(self, *, elevation: bool = True, time: bool = True, metadata: bool = True, track_index: int | None = None, track_name: str | None = None) -> None: ...
+
+    @property
+    def elevation(self) -> bool:
+        """Parse ``<trkpt><ele>``."""
+
+    @elevation.setter
+    def elevation(self, arg: bool, /) -> None: ...
+
+    @property
+    def time(self) -> bool:
+        """Parse ``<trkpt><time>``."""
+
+    @time.setter
+    def time(self, arg: bool, /) -> None: ...
+
+    @property
+    def metadata(self) -> bool:
+        """Parse ``<metadata><name>`` and ``<trk><name>``."""
+
+    @metadata.setter
+    def metadata(self, arg: bool, /) -> None: ...
+
+    @property
+    def track_index(self) -> int | None:
+        """Only parse the ``<trk>`` with this index in the document."""
+
+    @track_index.setter
+    def track_index(self, track_index: int | None) -> None: ...
+
+    @property
+    def track_name(self) -> str | None:
+        """Only parse the ``<trk>`` elements with this ``<name>``."""
+
+    @track_name.setter
+    def track_name(self, track_name: str | None) -> None: ...
+
+    def __repr__(self) -> str: ...
+
+class LoadOptions:
+    """Options for :func:`load`."""
+
+    def __init__(self, *, memory_map: bool = False, parse: ParseOptions = ParseOptions(), threads: int = 1, cache_dir: str | os.PathLike | None = None) -> None: ...
+
+    @property
+    def memory_map(self) -> bool:
+        """
+        Memory-map the file and parse it in place instead of reading it into a heap buffer.
+        """
+
+    @memory_map.setter
+    def memory_map(self, arg: bool, /) -> None: ...
+
+    @property
+    def parse(self) -> ParseOptions:
+        """Selects which parts of the GPX data to extract."""
+
+    @parse.setter
+    def parse(self, arg: ParseOptions, /) -> None: ...
+
+    @property
+    def threads(self) -> int:
+        """
+        Parse the points of large files on this many threads, or 0 for one per CPU core. Implies ``memory_map``.
+        """
+
+    @threads.setter
+    def threads(self, arg: int, /) -> None: ...
+
+    @property
+    def cache_dir(self) -> pathlib.Path | None:
+        """
+        Keep a binary copy of the parsed document in this directory, read instead of the GPX file while the size and modification time of the file match.
+        """
+
+    @cache_dir.setter
+    def cache_dir(self, arg: str | os.PathLike | None, /) -> None: ...
+
+    def __repr__(self) -> str: ...
+
+class TailReader:
+    """
+    Incrementally parses a GPX file while it is being written, such as by a logger appending points to an open recording. Each poll parses only the appended data, and updates the metrics already computed for the open segment instead of computing them again.
+    """
+
+    def __init__(self, path: str | os.PathLike, options: ParseOptions = ParseOptions()) -> None: ...
+
+    def poll(self) -> int:
+        """
+        Parse the data appended to the file since the previous poll, returning the number of points added. A file that became shorter is read again from the start.
+        """
+
+    @property
+    def gpx(self) -> Gpx:
+        """
+        The document parsed so far. Points are added to the last segment of the last track while it is open.
+        """
+
+    @property
+    def offset(self) -> int:
+        """Number of bytes parsed, not counting markup truncated at the end."""
+
+    @property
+    def finished(self) -> bool:
+        """True once the closing ``</gpx>`` has been read."""
+
+    def __repr__(self) -> str: ...
+
+class CatalogEntry:
+    """Summary of one GPX file in a :class:`Catalog`."""
+
+    @property
+    def path(self) -> pathlib.Path: ...
+
+    @property
+    def size(self) -> int:
+        """File size in bytes."""
+
+    @property
+    def content_hash(self) -> int:
+        """FNV-1a hash of the file content."""
+
+    @property
+    def track_count(self) -> int: ...
+
+    @property
+    def point_count(self) -> int: ...
+
+    @property
+    def error(self) -> str | None:
+        """Message of the error if the file could not be parsed, else ``None``."""
+
+    def bounds(self) -> Bounds: ...
+
+    def time_bounds(self) -> TimeBounds: ...
+
+    def length_2d(self) -> float:
+        """Distance in meters."""
+
+    def length_3d(self) -> float:
+        """Distance in meters."""
+
+    def __repr__(self) -> str: ...
+
+class CatalogUpdate:
+    """Counts of the entries changed by :meth:`Catalog.update`."""
+
+    @property
+    def added(self) -> int: ...
+
+    @property
+    def updated(self) -> int: ...
+
+    @property
+    def removed(self) -> int: ...
+
+    @property
+    def unchanged(self) -> int: ...
+
+    def __repr__(self) -> str: ...
+
+class Catalog:
+    """
+    Persistent index of per-file summaries of a corpus of GPX files. Updates append the entries of new and changed files to the index file, such that queries over a large corpus don't read the GPX files again.
+    """
+
+    def __init__(self, index_path: str | os.PathLike) -> None:
+        """
+        Open the index file, or start an empty catalog if it doesn't exist yet or cannot be read.
+        """
+
+    def update(self, root: str | os.PathLike, pattern: str = '*.gpx', recursive: bool = True, threads: int = 0) -> CatalogUpdate:
+        """
+        Scan a directory tree and bring the entries of its files up to date. Only new and changed files are parsed, and the entries of removed files are dropped. ``threads=0`` uses one thread per CPU core.
+        """
+
+    @property
+    def entries(self) -> list[CatalogEntry]:
+        """Entries sorted by path."""
+
+    def find(self, path: str | os.PathLike) -> CatalogEntry | None:
+        """Entry of the file at ``path``, or ``None``."""
+
+    def query(self, *, bounds: Bounds | None = None, start_time: datetime.datetime | None = None, end_time: datetime.datetime | None = None) -> list[CatalogEntry]:
+        """
+        Entries whose bounds overlap ``bounds`` and whose time bounds overlap ``[start_time, end_time)``, sorted by path. Files without times are excluded when filtering by time.
+        """
+
+    def total_length_2d(self, *, bounds: Bounds | None = None, start_time: datetime.datetime | None = None, end_time: datetime.datetime | None = None) -> float:
+        """
+        Sum of the 2D lengths in meters of the entries matching the filters of :meth:`query`.
+        """
+
+    def compact(self) -> None:
+        """Rewrite the index file with only the current entries."""
+
+    def __len__(self) -> int: ...
+
+class SpatialMatch:
+    """Range of points of a segment found by a :class:`SpatialIndex` query."""
+
+    @property
+    def document(self) -> int:
+        """Index of the document in the documents the index was built from."""
+
+    @property
+    def track(self) -> int: ...
+
+    @property
+    def segment(self) -> int: ...
+
+    @property
+    def first_point(self) -> int: ...
+
+    @property
+    def end_point(self) -> int:
+        """One past the last point of the range."""
+
+    def __eq__(self, arg: object, /) -> bool: ...
+
+    def __repr__(self) -> str: ...
+
+class SpatialIndex:
+    """
+    R-tree over the bounding boxes of chunks of the segments of many documents, for finding which of them pass through an area.
+    """
+
+    def __init__(self, documents: Sequence[Gpx], chunk_size: int = 32) -> None:
+        """
+        Build the index over the segments of ``documents``, split into chunks of up to ``chunk_size`` points.
+        """
+
+    def query(self, bounds: Bounds) -> list[SpatialMatch]:
+        """
+        Ranges of the points whose chunks overlap ``bounds``, sorted by document, track, segment and point. The ranges are candidates: a chunk can overlap while none of its points do.
+        """
+
+    def query_radius(self, center: LatLong, radius: float) -> list[SpatialMatch]:
+        """
+        Ranges of the points whose chunks come within ``radius`` meters of ``center``.
+        """
+
+    def bounds(self) -> Bounds:
+        """Bounds of all indexed points."""
+
+    @property
+    def chunk_size(self) -> int: ...
+
+    def __len__(self) -> int:
+        """Number of chunks."""
+
+    def save(self, path: str | os.PathLike) -> None:
+        """Write the index to a binary file."""
+
+    @staticmethod
+    def load(path: str | os.PathLike) -> SpatialIndex:
+        """Read an index written by :meth:`save`."""
+
+    def __repr__(self) -> str: ...
+
+class GeotagResult:
+    """
+    Locations matched to times by :func:`geotag`, as read-only NumPy arrays with one element per time.
+    """
+
+    @property
+    def latitude(self) -> Annotated[NDArray[numpy.float64], dict(shape=(None,), writable=False)]:
+        """Degrees, NaN for the times without a match."""
+
+    @property
+    def longitude(self) -> Annotated[NDArray[numpy.float64], dict(shape=(None,), writable=False)]:
+        """Degrees, NaN for the times without a match."""
+
+    @property
+    def elevation(self) -> Annotated[NDArray[numpy.float64], dict(shape=(None,), writable=False)]:
+        """Meters, NaN for the times without a match."""
+
+    @property
+    def document(self) -> Annotated[NDArray[numpy.int64], dict(shape=(None,), writable=False)]:
+        """Index of the matched document, -1 for the times without a match."""
+
+    @property
+    def track(self) -> Annotated[NDArray[numpy.int64], dict(shape=(None,), writable=False)]:
+        """Index of the matched track, -1 for the times without a match."""
+
+    @property
+    def segment(self) -> Annotated[NDArray[numpy.int64], dict(shape=(None,), writable=False)]:
+        """Index of the matched segment, -1 for the times without a match."""
+
+    def __len__(self) -> int: ...
+
+    def __repr__(self) -> str: ...
+
+@overload
+def geotag(timestamps: Annotated[ArrayLike, dict(dtype='float64', shape=(None,), device='cpu', writable=False)], documents: Sequence[Gpx], max_gap: datetime.timedelta | float | None = None, interpolation: Interpolation = Interpolation.Linear, threads: int = 0) -> GeotagResult:
+    """
+    Find the location at each of ``timestamps``, POSIX times in seconds such as photo capture times, in the segments of ``documents``. Times are interpolated between the points before and after them, unless these are more than ``max_gap`` apart. Times within ``max_gap`` before or after a segment take the location of its first or last point. Where segments overlap in time, the one with the closest point wins. ``threads=0`` uses one thread per CPU core.
+    """
+
+@overload
+def geotag(times: Sequence[datetime.datetime | datetime.date | datetime.time], documents: Sequence[Gpx], max_gap: datetime.timedelta | float | None = None, interpolation: Interpolation = Interpolation.Linear, threads: int = 0) -> GeotagResult:
+    """Like above for a sequence of ``datetime`` values."""
+
+def load(path: str | os.PathLike, options: LoadOptions = LoadOptions()) -> Gpx: ...
+
+def load_many(paths: Sequence[str | os.PathLike], options: LoadOptions = LoadOptions(), threads: int = 0) -> list[Gpx]:
+    """Load multiple GPX files concurrently, returned in the same order as ``paths``. ``threads=0`` uses one thread per CPU core."""
+
+def load_async(path: str | os.PathLike, options: LoadOptions = LoadOptions()) -> asyncio.Future[Gpx]:
+    """
+    Load a GPX file on a native worker thread, without blocking the event loop. Returns a future of the running event loop. Cancelling it discards the result, but does not stop the load.
+    """
+
+def load_many_async(paths: Sequence[str | os.PathLike], options: LoadOptions = LoadOptions()) -> asyncio.Future[list[Gpx]]:
+    """
+    Load multiple GPX files concurrently on native worker threads, without blocking the event loop. The future resolves to the files in the same order as ``paths``.
+    """
+
+def load_directory(root: str | os.PathLike, pattern: str = '*.gpx', recursive: bool = True, options: LoadOptions = LoadOptions(), threads: int = 0) -> list[tuple[pathlib.Path, Gpx]]:
+    """Load the GPX files in a directory concurrently, largest files first. Returns ``(path, gpx)`` pairs sorted by path."""
+
+def load_archive(path: str | os.PathLike, options: ParseOptions = ParseOptions(), threads: int = 0) -> list[tuple[pathlib.Path, Gpx]]:
+    """Load the GPX files in a ZIP archive concurrently, decompressing them in memory. Returns ``(path, gpx)`` pairs in archive order, with paths relative to the archive."""
+
+def parse(data: str, options: ParseOptions = ParseOptions()) -> Gpx: ...
+
+def parse_buffer(data: collections.abc.Buffer, options: ParseOptions = ParseOptions()) -> Gpx:
+    """Parse GPX data from a bytes-like object, such as ``bytes``, ``memoryview`` or ``mmap``, without copying it."""
+
+def summarize(path: str | os.PathLike, options: ParseOptions = ParseOptions()) -> GpxSummary:
+    """
+    Compute the lengths, bounds and time bounds of a GPX file without keeping its points in memory.
+    """
+
+def iter_points(path: str | os.PathLike) -> PointIterator:
+    """Stream the points of a GPX file without loading the whole file into memory. Files the
+    stream reader doesn't handle, such as in other encodings than UTF-8, are loaded whole."""
 
-def parse(data: str) -> Gpx: ...
+def iter_segments(path: str | os.PathLike) -> SegmentIterator:
+    """Stream the segments of a GPX file, holding only one segment in memory at a time. Files
+    the stream reader doesn't handle, such as in other encodings than UTF-8, are loaded whole."""
@@ -0,0 +1,76 @@
+import datetime
+from pathlib import Path
+import shutil
+
+import pytest
+
+import fastgpx
+
+
+METERS_TOL = 1e-4
+
+GPX_DIR = Path("gpx/2024 TopCamp")
+GPX_NAMES = ["Connected_20240518_094959_.gpx", "Connected_20240527_102505_Gol.gpx"]
+
+
+@pytest.fixture
+def corpus(tmp_path: Path) -> Path:
+    files = tmp_path / "files"
+    files.mkdir()
+    for name in GPX_NAMES:
+        shutil.copy(GPX_DIR / name, files / name)
+    return files
+
+
+def year(value: int) -> datetime.datetime:
+    return datetime.datetime(value, 1, 1, tzinfo=datetime.timezone.utc)
+
+
+class TestCatalog:
+
+    def test_update(self, corpus: Path, tmp_path: Path):
+        catalog = fastgpx.Catalog(tmp_path / "catalog.idx")
+        update = catalog.update(corpus)
+        assert (update.added, update.updated, update.removed, update.unchanged) == (2, 0, 0, 0)
+        assert len(catalog) == 2
+        assert [entry.path.name for entry in catalog.entries] == GPX_NAMES
+
+        entry = catalog.find(corpus / GPX_NAMES[0])
+        gpx = fastgpx.load(GPX_DIR / GPX_NAMES[0])
+        assert entry.error is None
+        assert entry.track_count == len(gpx.tracks)
+        assert entry.length_2d() == pytest.approx(gpx.length_2d(), abs=METERS_TOL)
+        assert entry.time_bounds() == gpx.time_bounds()
+        assert catalog.find(corpus / "missing.gpx") is None
+
+    def test_reopen(self, corpus: Path, tmp_path: Path):
+        fastgpx.Catalog(tmp_path / "catalog.idx").update(corpus)
+        catalog = fastgpx.Catalog(tmp_path / "catalog.idx")
+        assert len(catalog) == 2
+        update = catalog.update(corpus)
+        assert update.unchanged == 2
+
+        (corpus / GPX_NAMES[1]).unlink()
+        (corpus / "broken.gpx").write_text("<gpx><trk>")
+        update = catalog.update(corpus)
+        assert (update.added, update.removed, update.unchanged) == (1, 1, 1)
+        assert catalog.find(corpus / "broken.gpx").error is not None
+        assert len(fastgpx.Catalog(tmp_path / "catalog.idx")) == 2
+
+    def test_query(self, corpus: Path, tmp_path: Path):
+        catalog = fastgpx.Catalog(tmp_path / "catalog.idx")
+        catalog.update(corpus)
+        total = sum(entry.length_2d() for entry in catalog.entries)
+        assert catalog.total_length_2d() == pytest.approx(total, abs=METERS_TOL)
+        assert catalog.total_length_2d(start_time=year(2024), end_time=year(2025)) == \
+            pytest.approx(total, abs=METERS_TOL)
+        assert catalog.query(start_time=year(2023), end_time=year(2024)) == []
+
+        bounds = catalog.entries[0].bounds()
+        assert catalog.query(bounds=bounds)[0].path.name == GPX_NAMES[0]
+        assert catalog.query(bounds=fastgpx.Bounds((-10.0, -10.0), (-5.0, -5.0))) == []
+
+    def test_missing_directory(self, tmp_path: Path):
+        catalog = fastgpx.Catalog(tmp_path / "catalog.idx")
+        with pytest.raises(RuntimeError):
+            catalog.update(tmp_path / "not-a-real-path")
@@ -1,4 +1,7 @@
+import asyncio
+from concurrent.futures import ThreadPoolExecutor
 import datetime
+import mmap
 from pathlib import Path
 
 import gpxpy
@@ -125,6 +128,227 @@ class TestGpx:
         distance = gpx.length_2d()
         assert distance == pytest.approx(17809.2701, abs=METERS_TOL)
 
+    def test_load_memory_mapped(self, gpx_path: str):
+        options = fastgpx.LoadOptions(memory_map=True)
+        gpx = fastgpx.load(gpx_path, options)
+        distance = gpx.length_2d()
+        assert distance == pytest.approx(382952.7193, abs=METERS_TOL)
+        assert gpx.time_bounds() == fastgpx.load(gpx_path).time_bounds()
+
+    def test_load_memory_mapped_unicode(self, gpx_japanese_unicode_path: str):
+        options = fastgpx.LoadOptions(memory_map=True)
+        gpx = fastgpx.load(Path(gpx_japanese_unicode_path), options)
+        distance = gpx.length_2d()
+        assert distance == pytest.approx(17809.2701, abs=METERS_TOL)
+
+    def test_load_memory_mapped_missing_file(self):
+        options = fastgpx.LoadOptions(memory_map=True)
+        with pytest.raises(RuntimeError):
+            fastgpx.load('gpx/not-a-real-path/fake.gpx', options)
+
+    def test_load_cached(self, gpx_path: str, tmp_path: Path):
+        options = fastgpx.LoadOptions(cache_dir=tmp_path)
+        assert options.cache_dir == tmp_path
+        expected = fastgpx.load(gpx_path)
+        # The first load writes the cache file, the second reads it.
+        first = fastgpx.load(gpx_path, options)
+        assert len(list(tmp_path.iterdir())) == 1
+        second = fastgpx.load(gpx_path, options)
+        for gpx in (first, second):
+            assert gpx.length_2d() == expected.length_2d()
+            assert gpx.bounds() == expected.bounds()
+            assert gpx.time_bounds() == expected.time_bounds()
+            assert len(gpx.tracks) == len(expected.tracks)
+            assert gpx.tracks[0].segments[0].points == expected.tracks[0].segments[0].points
+
+    def test_load_cached_missing_file(self, tmp_path: Path):
+        options = fastgpx.LoadOptions(cache_dir=tmp_path)
+        with pytest.raises(RuntimeError):
+            fastgpx.load('gpx/not-a-real-path/fake.gpx', options)
+
+    # fastgpx.load_many
+
+    def test_load_many(self, gpx_path: str, gpx_unicode_path: str):
+        paths = [gpx_path, Path(gpx_unicode_path), gpx_path]
+        gpx_files = fastgpx.load_many(paths, threads=2)
+        assert len(gpx_files) == 3
+        for path, gpx in zip(paths, gpx_files):
+            expected = fastgpx.load(path)
+            assert gpx.length_2d() == pytest.approx(expected.length_2d(), abs=METERS_TOL)
+
+    def test_load_many_japanese_unicode(self, gpx_japanese_unicode_path: str):
+        # Each worker reads the files with a reused parser.
+        paths = [Path(gpx_japanese_unicode_path)] * 2
+        gpx_files = fastgpx.load_many(paths, threads=1)
+        assert [gpx.length_2d() for gpx in gpx_files] == \
+            pytest.approx([17809.2701] * 2, abs=METERS_TOL)
+
+    def test_load_many_options(self, gpx_path: str):
+        options = fastgpx.LoadOptions(memory_map=True)
+        gpx_files = fastgpx.load_many([gpx_path], options)
+        assert len(gpx_files) == 1
+        assert gpx_files[0].length_2d() == pytest.approx(382952.7193, abs=METERS_TOL)
+
+    def test_load_many_cached(self, gpx_path: str, gpx_unicode_path: str, tmp_path: Path):
+        options = fastgpx.LoadOptions(cache_dir=tmp_path)
+        gpx_files = fastgpx.load_many([gpx_path, gpx_unicode_path], options, threads=2)
+        assert len(list(tmp_path.iterdir())) == 2
+        for path, gpx in zip([gpx_path, gpx_unicode_path], gpx_files):
+            assert gpx.length_2d() == pytest.approx(fastgpx.load(path).length_2d(), abs=METERS_TOL)
+
+    def test_load_many_empty(self):
+        assert fastgpx.load_many([]) == []
+
+    def test_load_many_missing_file(self, gpx_path: str):
+        with pytest.raises(RuntimeError):
+            fastgpx.load_many([gpx_path, 'gpx/not-a-real-path/fake.gpx'])
+
+    # fastgpx.load_async
+
+    def test_load_async(self, gpx_path: str):
+        async def load():
+            return await fastgpx.load_async(gpx_path)
+
+        gpx = asyncio.run(load())
+        assert gpx.length_2d() == pytest.approx(382952.7193, abs=METERS_TOL)
+
+    def test_load_async_options(self, gpx_path: str):
+        async def load():
+            options = fastgpx.LoadOptions(memory_map=True)
+            return await fastgpx.load_async(Path(gpx_path), options)
+
+        gpx = asyncio.run(load())
+        assert gpx.length_2d() == pytest.approx(382952.7193, abs=METERS_TOL)
+
+    def test_load_async_missing_file(self):
+        async def load():
+            return await fastgpx.load_async('gpx/not-a-real-path/fake.gpx')
+
+        with pytest.raises(RuntimeError):
+            asyncio.run(load())
+
+    def test_load_async_gather(self, gpx_path: str, gpx_unicode_path: str):
+        paths = [gpx_path, gpx_unicode_path] * 4
+
+        async def load():
+            return await asyncio.gather(*(fastgpx.load_async(path) for path in paths))
+
+        gpx_files = asyncio.run(load())
+        for path, gpx in zip(paths, gpx_files):
+            assert gpx.length_2d() == pytest.approx(fastgpx.load(path).length_2d(), abs=METERS_TOL)
+
+    def test_load_async_cancelled(self, gpx_path: str):
+        async def load():
+            future = fastgpx.load_async(gpx_path)
+            future.cancel()
+            with pytest.raises(asyncio.CancelledError):
+                await future
+            # The cancelled load still completes in the background.
+            return await fastgpx.load_async(gpx_path)
+
+        assert asyncio.run(load()).length_2d() == pytest.approx(382952.7193, abs=METERS_TOL)
+
+    def test_load_async_without_event_loop(self, gpx_path: str):
+        with pytest.raises(RuntimeError):
+            fastgpx.load_async(gpx_path)
+
+    # fastgpx.load_many_async
+
+    def test_load_many_async(self, gpx_path: str, gpx_unicode_path: str):
+        paths = [gpx_path, Path(gpx_unicode_path), gpx_path]
+
+        async def load():
+            return await fastgpx.load_many_async(paths)
+
+        gpx_files = asyncio.run(load())
+        assert len(gpx_files) == 3
+        for path, gpx in zip(paths, gpx_files):
+            assert gpx.length_2d() == pytest.approx(fastgpx.load(path).length_2d(), abs=METERS_TOL)
+
+    def test_load_many_async_empty(self):
+        async def load():
+            return await fastgpx.load_many_async([])
+
+        assert asyncio.run(load()) == []
+
+    def test_load_many_async_missing_file(self, gpx_path: str):
+        async def load():
+            return await fastgpx.load_many_async([gpx_path, 'gpx/not-a-real-path/fake.gpx'])
+
+        with pytest.raises(RuntimeError):
+            asyncio.run(load())
+
+    # fastgpx.load_directory
+
+    def test_load_directory(self):
+        gpx_files = fastgpx.load_directory('gpx/test', recursive=False)
+        paths = [path for path, _ in gpx_files]
+        assert paths == sorted(Path('gpx/test').glob('*.gpx'))
+        for path, gpx in gpx_files:
+            expected = fastgpx.load(path)
+            assert gpx.length_2d() == pytest.approx(expected.length_2d(), abs=METERS_TOL)
+
+    def test_load_directory_recursive(self):
+        gpx_files = fastgpx.load_directory('gpx', pattern='Connected_*.gpx', threads=4)
+        paths = [path for path, _ in gpx_files]
+        assert paths == sorted(Path('gpx').rglob('Connected_*.gpx'))
+        assert Path('gpx/2024 TopCamp/Connected_20240518_094959_.gpx') in paths
+
+    def test_load_directory_missing(self):
+        with pytest.raises(RuntimeError):
+            fastgpx.load_directory('gpx/not-a-real-path')
+
+    # Threads
+
+    def test_load_and_measure_in_threads(self, gpx_path: str, gpx_unicode_path: str):
+        paths = [gpx_path, gpx_unicode_path] * 8
+
+        def measure(path: str) -> tuple[float, float, fastgpx.TimeBounds]:
+            gpx = fastgpx.load(path)
+            return gpx.length_2d(), gpx.length_3d(), gpx.time_bounds()
+
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(measure, paths))
+        for path, result in zip(paths, results):
+            assert result == measure(path)
+
+    def test_shared_gpx_measured_in_threads(self, gpx_path: str):
+        gpx = fastgpx.load(gpx_path)
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            lengths = list(executor.map(lambda _: gpx.length_2d(), range(16)))
+        assert lengths == [pytest.approx(382952.7193, abs=METERS_TOL)] * 16
+
+    # Compressed files
+
+    @pytest.mark.parametrize('suffix', ['.gpx.gz', '.zip'])
+    def test_load_compressed(self, suffix: str):
+        expected = fastgpx.load('gpx/test/segment.gpx')
+        for memory_map in (False, True):
+            options = fastgpx.LoadOptions(memory_map=memory_map)
+            gpx = fastgpx.load(f'gpx/test/segment{suffix}', options)
+            assert gpx.length_2d() == pytest.approx(expected.length_2d(), abs=METERS_TOL)
+            assert gpx.time_bounds() == expected.time_bounds()
+
+    def test_parse_buffer_compressed(self):
+        expected = fastgpx.load('gpx/test/segment.gpx')
+        data = Path('gpx/test/segment.gpx.gz').read_bytes()
+        gpx = fastgpx.parse_buffer(data)
+        assert gpx.length_2d() == pytest.approx(expected.length_2d(), abs=METERS_TOL)
+
+    # fastgpx.load_archive
+
+    def test_load_archive(self):
+        gpx_files = fastgpx.load_archive(
+            'gpx/third-party/github.com_gps-touring_sample-gpx/sample-gpx-master.zip', threads=4)
+        assert len(gpx_files) == 78
+        path, gpx = gpx_files[0]
+        assert path == Path('sample-gpx-master/BrittanyJura/Alt_Portsmouth.gpx')
+        assert gpx.length_2d() > 0.0
+
+    def test_load_archive_missing(self):
+        with pytest.raises(RuntimeError):
+            fastgpx.load_archive('gpx/not-a-real-path/fake.zip')
+
     # fastgpx.parse
 
     def test_parse(self, gpx_path: str):
@@ -134,6 +358,102 @@ class TestGpx:
         distance = gpx.length_2d()
         assert distance == pytest.approx(382952.7193, abs=METERS_TOL)
 
+    # fastgpx.parse_buffer
+
+    def test_parse_buffer_bytes(self, gpx_path: str):
+        gpx_data = Path(gpx_path).read_bytes()
+        gpx = fastgpx.parse_buffer(gpx_data)
+        distance = gpx.length_2d()
+        assert distance == pytest.approx(382952.7193, abs=METERS_TOL)
+
+    def test_parse_buffer_memoryview(self, gpx_path: str):
+        gpx_data = bytearray(Path(gpx_path).read_bytes())
+        gpx = fastgpx.parse_buffer(memoryview(gpx_data))
+        distance = gpx.length_2d()
+        assert distance == pytest.approx(382952.7193, abs=METERS_TOL)
+
+    def test_parse_buffer_mmap(self, gpx_path: str):
+        with open(gpx_path, 'rb') as gpx_file:
+            with mmap.mmap(gpx_file.fileno(), 0, access=mmap.ACCESS_READ) as gpx_data:
+                gpx = fastgpx.parse_buffer(gpx_data)
+        distance = gpx.length_2d()
+        assert distance == pytest.approx(382952.7193, abs=METERS_TOL)
+
+    def test_parse_buffer_invalid_type(self):
+        with pytest.raises(TypeError):
+            fastgpx.parse_buffer("<gpx/>")
+
+
+class TestParseOptions:
+
+    GPX_DATA = """<?xml version="1.0"?>
+<gpx version="1.1">
+  <metadata><name>Trip</name></metadata>
+  <trk>
+    <name>First</name>
+    <trkseg>
+      <trkpt lat="63.1" lon="10.2"><ele>12.5</ele><time>2024-05-18T07:50:00Z</time></trkpt>
+    </trkseg>
+  </trk>
+  <trk>
+    <name>Second</name>
+    <trkseg><trkpt lat="63.2" lon="10.3"/></trkseg>
+  </trk>
+</gpx>"""
+
+    def test_defaults(self):
+        options = fastgpx.ParseOptions()
+        assert options.elevation
+        assert options.time
+        assert options.metadata
+        assert options.track_index is None
+        assert options.track_name is None
+
+    def test_repr(self):
+        options = fastgpx.ParseOptions(time=False, track_name='First')
+        assert repr(options) == (
+            "fastgpx.ParseOptions(elevation=True, time=False, metadata=True, "
+            "track_index=None, track_name='First')")
+
+    def test_parse_track_names(self):
+        gpx = fastgpx.parse(self.GPX_DATA)
+        assert gpx.name == 'Trip'
+        assert [track.name for track in gpx.tracks] == ['First', 'Second']
+
+    def test_parse_skip_fields(self):
+        options = fastgpx.ParseOptions(elevation=False, time=False, metadata=False)
+        gpx = fastgpx.parse(self.GPX_DATA, options)
+        assert gpx.name is None
+        assert gpx.tracks[0].name is None
+        point = gpx.tracks[0].segments[0].points[0]
+        assert point.latitude == 63.1
+        assert point.elevation == 0.0
+        assert gpx.time_bounds().is_empty()
+
+    def test_parse_track_index(self):
+        gpx = fastgpx.parse(self.GPX_DATA, fastgpx.ParseOptions(track_index=1))
+        assert [track.name for track in gpx.tracks] == ['Second']
+
+    def test_parse_track_name(self):
+        options = fastgpx.ParseOptions(track_name='First')
+        gpx = fastgpx.parse_buffer(self.GPX_DATA.encode(), options)
+        assert [track.name for track in gpx.tracks] == ['First']
+
+    def test_load_options(self, gpx_path: str):
+        options = fastgpx.LoadOptions(parse=fastgpx.ParseOptions(time=False))
+        gpx = fastgpx.load(gpx_path, options)
+        assert gpx.time_bounds().is_empty()
+        assert gpx.length_2d() == pytest.approx(382952.7193, abs=METERS_TOL)
+
+    def test_load_threads(self, gpx_path: str):
+        expected = fastgpx.load(gpx_path)
+        for threads in (0, 2):
+            gpx = fastgpx.load(gpx_path, fastgpx.LoadOptions(threads=threads))
+            assert gpx.length_2d() == pytest.approx(expected.length_2d(), abs=METERS_TOL)
+            assert gpx.time_bounds() == expected.time_bounds()
+            assert [len(s.points) for s in gpx.tracks[0].segments] == \
+                [len(s.points) for s in expected.tracks[0].segments]
+
 
 class TestTrack:
 
@@ -185,6 +505,36 @@ class TestSegment:
         distance = segment.length_2d()
         assert distance == pytest.approx(17809.2701, abs=METERS_TOL)
 
+    # fastgpx.Segment.location_at
+
+    def test_location_at(self):
+        gpx = fastgpx.load('gpx/test/debug-segment.gpx')
+        segment = gpx.tracks[0].segments[0]
+        start = datetime.datetime(2024, 5, 18, 7, 50, 0, tzinfo=datetime.timezone.utc)
+        first, second = segment.points
+
+        assert segment.location_at(start) == first
+        location = segment.location_at(start + datetime.timedelta(milliseconds=500))
+        assert location.latitude == pytest.approx((first.latitude + second.latitude) / 2)
+        assert location.elevation == pytest.approx(151.5)
+        circle = segment.location_at(start + datetime.timedelta(milliseconds=500),
+                                     fastgpx.Interpolation.GreatCircle)
+        assert circle.longitude == pytest.approx(location.longitude)
+        assert segment.location_at(start - datetime.timedelta(seconds=1)) is None
+
+    # fastgpx.Segment.locations_at
+
+    def test_locations_at(self, gpx_path: str):
+        gpx = fastgpx.load(gpx_path)
+        segment = gpx.tracks[0].segments[0]
+        start = segment.time_bounds().start_time
+        times = [start + datetime.timedelta(seconds=5 * i) for i in range(-1, 100)]
+        locations = segment.locations_at(times)
+        assert locations[0] is None
+        assert locations == [segment.location_at(time) for time in times]
+        with pytest.raises(ValueError):
+            segment.locations_at(list(reversed(times)))
+
     # fastgpx.Segment.__repr__
 
     def test_repr(self, gpx_path: str):
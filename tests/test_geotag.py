@@ -0,0 +1,59 @@
+import datetime
+import math
+
+import pytest
+
+import fastgpx
+
+# The results are NumPy arrays. Environments synced from an older lock file
+# don't have NumPy installed.
+numpy = pytest.importorskip("numpy")
+
+
+GPX_PATHS = [
+    "gpx/2024 TopCamp/Connected_20240518_094959_.gpx",
+    "gpx/2024 TopCamp/Connected_20240527_102505_Gol.gpx",
+]
+
+
+@pytest.fixture
+def documents() -> list[fastgpx.Gpx]:
+    return fastgpx.load_many(GPX_PATHS)
+
+
+class TestGeotag:
+
+    def test_timestamps(self, documents: list[fastgpx.Gpx]):
+        segment = documents[1].tracks[0].segments[0]
+        start = segment.time_bounds().start_time
+        times = [start + datetime.timedelta(seconds=7 * i) for i in range(100)]
+        timestamps = numpy.array([time.timestamp() for time in reversed(times)] + [math.nan, 0.0])
+
+        result = fastgpx.geotag(timestamps, documents, threads=2)
+        assert len(result) == len(timestamps)
+        assert result.latitude.dtype == numpy.float64
+        assert result.document.dtype == numpy.int64
+        assert list(result.document[:100]) == [1] * 100
+        assert list(result.document[100:]) == [-1, -1]
+        assert numpy.isnan(result.latitude[100:]).all()
+
+        expected = segment.locations_at(times)
+        assert result.latitude[99] == pytest.approx(expected[0].latitude)
+        assert result.longitude[0] == pytest.approx(expected[-1].longitude)
+        with pytest.raises(ValueError):
+            result.latitude[0] = 0.0
+
+    def test_datetimes(self, documents: list[fastgpx.Gpx]):
+        start = documents[0].time_bounds().start_time
+        times = [start, start - datetime.timedelta(seconds=30)]
+        result = fastgpx.geotag(times, documents)
+        assert list(result.document) == [0, -1]
+
+        result = fastgpx.geotag(times, documents, max_gap=datetime.timedelta(minutes=1),
+                                interpolation=fastgpx.Interpolation.GreatCircle)
+        assert list(result.document) == [0, 0]
+        assert result.latitude[0] == result.latitude[1]
+
+    def test_no_documents(self):
+        result = fastgpx.geotag(numpy.array([0.0, 1.0]), [])
+        assert list(result.track) == [-1, -1]
@@ -0,0 +1,67 @@
+from pathlib import Path
+
+import pytest
+
+import fastgpx
+
+
+GPX_PATHS = [
+    "gpx/2024 TopCamp/Connected_20240518_094959_.gpx",
+    "gpx/2024 TopCamp/Connected_20240527_102505_Gol.gpx",
+]
+
+
+@pytest.fixture
+def documents() -> list[fastgpx.Gpx]:
+    return fastgpx.load_many(GPX_PATHS)
+
+
+class TestSpatialIndex:
+
+    def test_query(self, documents: list[fastgpx.Gpx]):
+        index = fastgpx.SpatialIndex(documents)
+        assert len(index) > 0
+        assert index.chunk_size == 32
+
+        start = documents[0].tracks[0].segments[0].points[0]
+        bounds = fastgpx.Bounds((start.latitude - 0.01, start.longitude - 0.01),
+                                (start.latitude + 0.01, start.longitude + 0.01))
+        matches = index.query(bounds)
+        assert matches
+        assert any(m.document == 0 and m.track == 0 and m.segment == 0 and m.first_point == 0
+                   for m in matches)
+        for match in matches:
+            segment = documents[match.document].tracks[match.track].segments[match.segment]
+            assert 0 <= match.first_point < match.end_point <= len(segment.points)
+
+        assert index.query(fastgpx.Bounds((-10.0, -10.0), (-5.0, -5.0))) == []
+
+    def test_query_radius(self, documents: list[fastgpx.Gpx]):
+        index = fastgpx.SpatialIndex(documents, chunk_size=8)
+        center = documents[1].tracks[0].segments[0].points[50]
+        matches = index.query_radius(center, 1000.0)
+        assert matches
+        assert {match.document for match in matches} == {1}
+        assert index.query_radius(fastgpx.LatLong(-45.0, -45.0), 1000.0) == []
+
+    def test_bounds(self, documents: list[fastgpx.Gpx]):
+        index = fastgpx.SpatialIndex(documents)
+        bounds = index.bounds()
+        for gpx in documents:
+            assert bounds.min_latitude <= gpx.bounds().min_latitude
+            assert bounds.max_longitude >= gpx.bounds().max_longitude
+
+    def test_save_and_load(self, documents: list[fastgpx.Gpx], tmp_path: Path):
+        index = fastgpx.SpatialIndex(documents)
+        index.save(tmp_path / "spatial.idx")
+        loaded = fastgpx.SpatialIndex.load(tmp_path / "spatial.idx")
+        assert len(loaded) == len(index)
+        center = documents[0].tracks[0].segments[0].points[0]
+        assert loaded.query_radius(center, 500.0) == index.query_radius(center, 500.0)
+
+    def test_load_invalid(self, tmp_path: Path):
+        (tmp_path / "spatial.idx").write_bytes(b"not a spatial index")
+        with pytest.raises(RuntimeError):
+            fastgpx.SpatialIndex.load(tmp_path / "spatial.idx")
+        with pytest.raises(RuntimeError):
+            fastgpx.SpatialIndex.load(tmp_path / "missing.idx")
@@ -0,0 +1,116 @@
+from pathlib import Path
+
+import pytest
+
+import fastgpx
+
+
+METERS_TOL = 1e-4
+
+
+@pytest.fixture
+def gpx_path():
+    return "gpx/2024 TopCamp/Connected_20240518_094959_.gpx"
+
+
+class TestIterPoints:
+
+    def test_iter_points(self):
+        points = list(fastgpx.iter_points('gpx/test/debug-segment.gpx'))
+        gpx = fastgpx.load('gpx/test/debug-segment.gpx')
+        expected = gpx.tracks[0].segments[0].points
+        assert len(points) == len(expected)
+        for (track_index, segment_index, point), expected_point in zip(points, expected):
+            assert track_index == 0
+            assert segment_index == 0
+            assert point == expected_point
+
+    def test_iter_points_latin1_falls_back_to_load(self):
+        path = 'gpx/third-party/topografix.com/ashland.gpx'
+        gpx = fastgpx.load(path)
+        expected = [(t, s, point)
+                    for t, track in enumerate(gpx.tracks)
+                    for s, segment in enumerate(track.segments)
+                    for point in segment.points]
+        assert len(expected) > 0
+        assert list(fastgpx.iter_points(path)) == expected
+
+    def test_iter_points_missing_file(self):
+        with pytest.raises(RuntimeError):
+            list(fastgpx.iter_points('gpx/not-a-real-path/fake.gpx'))
+
+
+class TestIterSegments:
+
+    def test_iter_segments_length2d(self, gpx_path: str):
+        gpx = fastgpx.load(gpx_path)
+        expected = [segment for track in gpx.tracks for segment in track.segments]
+        segments = list(fastgpx.iter_segments(gpx_path))
+        assert len(segments) == len(expected)
+        for (_, _, segment), expected_segment in zip(segments, expected):
+            assert segment.length_2d() == pytest.approx(expected_segment.length_2d(), abs=METERS_TOL)
+            assert segment.time_bounds() == expected_segment.time_bounds()
+
+    def test_iter_segments_indices(self, gpx_path: str):
+        indices = [(track, segment) for track, segment, _ in fastgpx.iter_segments(gpx_path)]
+        assert indices[0] == (0, 0)
+        assert all(track == 0 for track, _ in indices)
+        assert [segment for _, segment in indices] == list(range(len(indices)))
+
+    def test_iter_segments_latin1_falls_back_to_load(self):
+        path = 'gpx/third-party/topografix.com/ashland.gpx'
+        gpx = fastgpx.load(path)
+        expected = [(t, s, segment)
+                    for t, track in enumerate(gpx.tracks)
+                    for s, segment in enumerate(track.segments)]
+        segments = list(fastgpx.iter_segments(path))
+        assert [(t, s) for t, s, _ in segments] == [(t, s) for t, s, _ in expected]
+        for (_, _, segment), (_, _, expected_segment) in zip(segments, expected):
+            assert segment.points == expected_segment.points
+
+
+class TestTailReader:
+
+    def test_tail_reader_follows_appended_data(self, gpx_path: str, tmp_path):
+        data = Path(gpx_path).read_bytes()
+        expected = fastgpx.load(gpx_path)
+        path = tmp_path / 'recording.gpx'
+        path.write_bytes(b'')
+
+        reader = fastgpx.TailReader(path)
+        points = 0
+        with open(path, 'ab') as recording:
+            for offset in range(0, len(data), 64 * 1024):
+                recording.write(data[offset:offset + 64 * 1024])
+                recording.flush()
+                points += reader.poll()
+                # Computed between polls, then updated with the new points.
+                reader.gpx.length_2d()
+
+        assert reader.finished
+        assert points == sum(len(segment.points)
+                             for track in expected.tracks for segment in track.segments)
+        assert reader.gpx.length_2d() == pytest.approx(expected.length_2d(), abs=METERS_TOL)
+        assert reader.gpx.bounds() == expected.bounds()
+        assert reader.gpx.time_bounds() == expected.time_bounds()
+
+    def test_tail_reader_unicode_path(self, tmp_path):
+        path = tmp_path / 'テスト.gpx'
+        path.write_bytes(Path('gpx/test/テスト.gpx').read_bytes())
+        reader = fastgpx.TailReader(path)
+        assert reader.poll() > 0
+        assert reader.finished
+        assert reader.gpx.length_2d() == pytest.approx(17809.2701, abs=METERS_TOL)
+
+    def test_tail_reader_truncated_file(self, tmp_path):
+        path = tmp_path / 'recording.gpx'
+        path.write_text('<gpx><trk><trkseg><trkpt lat="60.0" lon="10.0"></trkpt><trkpt lat="6')
+        reader = fastgpx.TailReader(path)
+        assert reader.poll() == 1
+        assert not reader.finished
+        assert len(reader.gpx.tracks[0].segments[0].points) == 1
+
+    def test_tail_reader_missing_file(self, tmp_path):
+        reader = fastgpx.TailReader(tmp_path / 'not-yet-written.gpx')
+        assert reader.poll() == 0
+        assert reader.offset == 0
@@ -0,0 +1,44 @@
+import pytest
+
+import fastgpx
+
+
+METERS_TOL = 1e-4
+
+
+@pytest.fixture
+def gpx_path():
+    return "gpx/2024 TopCamp/Connected_20240518_094959_.gpx"
+
+
+class TestSummarize:
+
+    def test_summarize_matches_load(self, gpx_path: str):
+        summary = fastgpx.summarize(gpx_path)
+        gpx = fastgpx.load(gpx_path)
+        assert summary.length_2d() == pytest.approx(382952.7193, abs=METERS_TOL)
+        assert summary.length_2d() == gpx.length_2d()
+        assert summary.length_3d() == gpx.length_3d()
+        assert summary.time_bounds() == gpx.time_bounds()
+        assert summary.bounds().min_latitude == gpx.bounds().min_latitude
+        assert summary.bounds().max_longitude == gpx.bounds().max_longitude
+        assert len(summary.tracks) == len(gpx.tracks)
+
+    def test_summarize_segments(self, gpx_path: str):
+        summary = fastgpx.summarize(gpx_path)
+        gpx = fastgpx.load(gpx_path)
+        for track_summary, track in zip(summary.tracks, gpx.tracks):
+            assert track_summary.name == track.name
+            assert len(track_summary.segments) == len(track.segments)
+            for segment_summary, segment in zip(track_summary.segments, track.segments):
+                assert segment_summary.point_count == len(segment.points)
+                assert segment_summary.length_2d() == segment.length_2d()
+                assert segment_summary.time_bounds() == segment.time_bounds()
+
+    def test_summarize_options(self, gpx_path: str):
+        summary = fastgpx.summarize(gpx_path, fastgpx.ParseOptions(time=False))
+        assert summary.time_bounds().is_empty()
+
+    def test_summarize_missing_file(self):
+        with pytest.raises(RuntimeError):
+            fastgpx.summarize('gpx/not-a-real-path/fake.gpx')
@@ -0,0 +1,83 @@
+from concurrent.futures import ThreadPoolExecutor
+import sys
+import sysconfig
+import threading
+
+import pytest
+
+import fastgpx
+
+
+THREADS = 16
+ROUNDS = 50
+
+
+@pytest.fixture
+def gpx_path():
+    return "gpx/2024 TopCamp/Connected_20240518_094959_.gpx"
+
+
+def run_in_threads(func, threads: int = THREADS) -> list:
+    """Calls ``func`` from ``threads`` threads at once, returning their results."""
+    barrier = threading.Barrier(threads)
+
+    def worker(_):
+        barrier.wait()
+        return func()
+
+    with ThreadPoolExecutor(max_workers=threads) as executor:
+        return list(executor.map(worker, range(threads)))
+
+
+class TestThreading:
+
+    def test_gil_disabled_on_free_threaded_python(self):
+        # Importing fastgpx must not re-enable the GIL.
+        if not sysconfig.get_config_var('Py_GIL_DISABLED'):
+            pytest.skip('Not a free-threaded Python')
+        assert not sys._is_gil_enabled()
+
+    def test_shared_gpx_metrics(self, gpx_path: str):
+        expected = fastgpx.load(gpx_path)
+        expected_metrics = (expected.length_2d(), expected.length_3d(), expected.bounds(),
+                            expected.time_bounds())
+
+        for _ in range(ROUNDS):
+            # A fresh object per round, such that the threads race to fill the
+            # lazy caches.
+            gpx = fastgpx.load(gpx_path)
+
+            def measure():
+                return gpx.length_2d(), gpx.length_3d(), gpx.bounds(), gpx.time_bounds()
+
+            assert run_in_threads(measure) == [expected_metrics] * THREADS
+
+    def test_shared_segment_metrics(self, gpx_path: str):
+        segment = fastgpx.load(gpx_path).tracks[0].segments[0]
+        expected = (segment.length_2d(), segment.time_bounds())
+
+        for _ in range(ROUNDS):
+            segment = fastgpx.load(gpx_path).tracks[0].segments[0]
+            results = run_in_threads(lambda: (segment.length_2d(), segment.time_bounds()))
+            assert results == [expected] * THREADS
+
+    def test_load_and_parse_in_threads(self, gpx_path: str):
+        with open(gpx_path, 'rb') as gpx_file:
+            data = gpx_file.read()
+        expected = fastgpx.load(gpx_path).length_2d()
+
+        def load_and_parse():
+            return fastgpx.load(gpx_path).length_2d(), fastgpx.parse_buffer(data).length_2d()
+
+        assert run_in_threads(load_and_parse) == [(expected, expected)] * THREADS
+
+    def test_shared_point_iterator(self, gpx_path: str):
+        expected = list(fastgpx.iter_points(gpx_path))
+        iterator = fastgpx.iter_points(gpx_path)
+
+        def drain():
+            return list(iterator)
+
+        # Each point is yielded to exactly one of the threads.
+        counts = [len(points) for points in run_in_threads(drain)]
+        assert sum(counts) == len(expected)